@@ -0,0 +1,139 @@
+// Copyright 2015 VMR Games, Inc. All Rights Reserved.
+
+#include "BattleBots.h"
+#include "BBotsStats.h"
+
+
+DEFINE_STAT(STAT_BBots_AOETick);
+DEFINE_STAT(STAT_BBots_SpellOverlap);
+DEFINE_STAT(STAT_BBots_ProjectileTick);
+DEFINE_STAT(STAT_BBots_StatusEffectTick);
+DEFINE_STAT(STAT_BBots_SpatialGridTick);
+DEFINE_STAT(STAT_BBots_TakeDamage);
+DEFINE_STAT(STAT_BBots_CastFromSpellBar);
+DEFINE_STAT(STAT_BBots_MatchPhase);
+DEFINE_STAT(STAT_BBots_PlayerTick);
+DEFINE_STAT(STAT_BBots_LiveSpells);
+DEFINE_STAT(STAT_BBots_ActiveDots);
+DEFINE_STAT(STAT_BBots_DamageEvents);
+DEFINE_STAT(STAT_BBots_RPCs);
+DEFINE_STAT(STAT_BBots_PathQueries);
+
+// CSV header names, indexed by EBBotsStat
+static const TCHAR* const CsvStatNames[EBBotsStat::EMax] =
+{
+  TEXT("AOETickMs"),
+  TEXT("SpellOverlapMs"),
+  TEXT("ProjectileTickMs"),
+  TEXT("StatusEffectTickMs"),
+  TEXT("SpatialGridTickMs"),
+  TEXT("TakeDamageMs"),
+  TEXT("CastFromSpellBarMs"),
+  TEXT("MatchPhaseMs"),
+  TEXT("PlayerTickMs"),
+  TEXT("LiveSpells"),
+  TEXT("ActiveDots"),
+  TEXT("DamageEvents"),
+  TEXT("RPCs"),
+  TEXT("PathQueries"),
+};
+
+// Only the per frame counters start from 0 every frame
+static bool IsResetPerFrame(int32 stat)
+{
+  return stat < EBBotsStat::ENumCycleStats || stat == EBBotsStat::EDamageEvents || stat == EBBotsStat::ERPCs || stat == EBBotsStat::EPathQueries;
+}
+
+FBBotsCsvProfiler& FBBotsCsvProfiler::Get()
+{
+  static FBBotsCsvProfiler profiler;
+  return profiler;
+}
+
+FBBotsCsvProfiler::FBBotsCsvProfiler()
+  : bCapturing(false), captureFile(nullptr), frameNumber(0)
+{
+  FMemory::Memzero(frameValues, sizeof(frameValues));
+}
+
+void FBBotsCsvProfiler::BeginCapture(const FString& captureName)
+{
+  EndCapture();
+
+  const FString capturePath = FPaths::ProfilingDir() / TEXT("BBotsCsv") / FString::Printf(TEXT("%s-%s.csv"), *captureName, *FDateTime::Now().ToString());
+  captureFile = IFileManager::Get().CreateFileWriter(*capturePath);
+  if (!captureFile)
+  {
+    UE_LOG(LogBattleBots, Warning, TEXT("BBotsCsv: could not open %s"), *capturePath);
+    return;
+  }
+
+  FString header = TEXT("Frame,FrameMs");
+  for (int32 stat = 0; stat < EBBotsStat::EMax; stat++)
+  {
+    header += TEXT(",");
+    header += CsvStatNames[stat];
+  }
+  header += LINE_TERMINATOR;
+
+  const FTCHARToUTF8 headerUtf8(*header);
+  captureFile->Serialize((void*)headerUtf8.Get(), headerUtf8.Length());
+
+  FMemory::Memzero(frameValues, sizeof(frameValues));
+  frameNumber = 0;
+  bCapturing = true;
+  tickerHandle = FTicker::GetCoreTicker().AddTicker(FTickerDelegate::CreateRaw(this, &FBBotsCsvProfiler::EndFrame));
+
+  UE_LOG(LogBattleBots, Log, TEXT("BBotsCsv: capturing to %s"), *capturePath);
+}
+
+void FBBotsCsvProfiler::EndCapture()
+{
+  if (!bCapturing)
+  {
+    return;
+  }
+
+  bCapturing = false;
+  FTicker::GetCoreTicker().RemoveTicker(tickerHandle);
+
+  captureFile->Close();
+  delete captureFile;
+  captureFile = nullptr;
+
+  UE_LOG(LogBattleBots, Log, TEXT("BBotsCsv: capture ended after %llu frames"), frameNumber);
+}
+
+bool FBBotsCsvProfiler::EndFrame(float deltaSeconds)
+{
+  if (!bCapturing)
+  {
+    return false;
+  }
+
+  ANSICHAR row[512];
+  int32 rowLength = FCStringAnsi::Sprintf(row, "%llu,%.3f", frameNumber++, deltaSeconds * 1000.f);
+
+  for (int32 stat = 0; stat < EBBotsStat::EMax; stat++)
+  {
+    if (stat < EBBotsStat::ENumCycleStats)
+    {
+      rowLength += FCStringAnsi::Sprintf(row + rowLength, ",%.3f", FPlatformTime::ToMilliseconds((uint32)frameValues[stat]));
+    }
+    else
+    {
+      rowLength += FCStringAnsi::Sprintf(row + rowLength, ",%llu", frameValues[stat]);
+    }
+
+    if (IsResetPerFrame(stat))
+    {
+      frameValues[stat] = 0;
+    }
+  }
+  rowLength += FCStringAnsi::Sprintf(row + rowLength, "\n");
+
+  captureFile->Serialize(row, rowLength);
+
+  // Keep ticking
+  return true;
+}
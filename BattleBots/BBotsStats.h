@@ -0,0 +1,124 @@
+// Copyright 2015 VMR Games, Inc. All Rights Reserved.
+
+#pragma once
+
+/* Gameplay stats, shown with "stat BattleBots". Every stat also has a slot
+in the CSV profiler, so soak runs on dedicated servers (no stat viewer) can
+record them per frame. */
+
+DECLARE_STATS_GROUP(TEXT("BattleBots"), STATGROUP_BattleBots, STATCAT_Advanced);
+
+DECLARE_CYCLE_STAT_EXTERN(TEXT("AOE Tick"), STAT_BBots_AOETick, STATGROUP_BattleBots, );
+DECLARE_CYCLE_STAT_EXTERN(TEXT("Spell Overlap"), STAT_BBots_SpellOverlap, STATGROUP_BattleBots, );
+DECLARE_CYCLE_STAT_EXTERN(TEXT("Projectile Tick"), STAT_BBots_ProjectileTick, STATGROUP_BattleBots, );
+DECLARE_CYCLE_STAT_EXTERN(TEXT("Status Effect Tick"), STAT_BBots_StatusEffectTick, STATGROUP_BattleBots, );
+DECLARE_CYCLE_STAT_EXTERN(TEXT("Spatial Grid Tick"), STAT_BBots_SpatialGridTick, STATGROUP_BattleBots, );
+DECLARE_CYCLE_STAT_EXTERN(TEXT("Take Damage"), STAT_BBots_TakeDamage, STATGROUP_BattleBots, );
+DECLARE_CYCLE_STAT_EXTERN(TEXT("Cast From Spell Bar"), STAT_BBots_CastFromSpellBar, STATGROUP_BattleBots, );
+DECLARE_CYCLE_STAT_EXTERN(TEXT("Match Phase"), STAT_BBots_MatchPhase, STATGROUP_BattleBots, );
+DECLARE_CYCLE_STAT_EXTERN(TEXT("Player Tick"), STAT_BBots_PlayerTick, STATGROUP_BattleBots, );
+
+// Accumulators keep their value between frames
+DECLARE_DWORD_ACCUMULATOR_STAT_EXTERN(TEXT("Live Spells"), STAT_BBots_LiveSpells, STATGROUP_BattleBots, );
+DECLARE_DWORD_ACCUMULATOR_STAT_EXTERN(TEXT("Active DoTs"), STAT_BBots_ActiveDots, STATGROUP_BattleBots, );
+// Counters are reset every frame
+DECLARE_DWORD_COUNTER_STAT_EXTERN(TEXT("Damage Events"), STAT_BBots_DamageEvents, STATGROUP_BattleBots, );
+// Gameplay RPCs executed on this machine
+DECLARE_DWORD_COUNTER_STAT_EXTERN(TEXT("RPCs"), STAT_BBots_RPCs, STATGROUP_BattleBots, );
+// Navigation path queries made for click to move
+DECLARE_DWORD_COUNTER_STAT_EXTERN(TEXT("Path Queries"), STAT_BBots_PathQueries, STATGROUP_BattleBots, );
+
+// The CSV columns, one per stat above
+namespace EBBotsStat
+{
+  enum Type
+  {
+    EAOETick,
+    ESpellOverlap,
+    EProjectileTick,
+    EStatusEffectTick,
+    ESpatialGridTick,
+    ETakeDamage,
+    ECastFromSpellBar,
+    EMatchPhase,
+    EPlayerTick,
+    ENumCycleStats,
+    ELiveSpells = ENumCycleStats,
+    EActiveDots,
+    EDamageEvents,
+    ERPCs,
+    EPathQueries,
+    EMax,
+  };
+}
+
+/**
+ * FBBotsCsvProfiler writes one CSV row per engine frame while a capture is
+ * running: the frame time, the milliseconds spent in each gameplay cycle
+ * stat and the value of each counter. Captures are started with the
+ * BBotsCsvStart exec or the -BBotsCsv command line switch, and written to
+ * Saved/Profiling/BBotsCsv.
+ */
+class BATTLEBOTS_API FBBotsCsvProfiler
+{
+public:
+  static FBBotsCsvProfiler& Get();
+
+  // Starts a new capture file, ends the current capture first
+  void BeginCapture(const FString& captureName);
+
+  void EndCapture();
+
+  FORCEINLINE bool IsCapturing() const { return bCapturing; }
+
+  FORCEINLINE void AddCycles(EBBotsStat::Type stat, uint32 cycles) { frameValues[stat] += cycles; }
+  FORCEINLINE void AddToCounter(EBBotsStat::Type stat, uint32 amount) { frameValues[stat] += amount; }
+  FORCEINLINE void SetCounter(EBBotsStat::Type stat, uint32 value) { frameValues[stat] = value; }
+
+private:
+  FBBotsCsvProfiler();
+
+  bool bCapturing;
+  FArchive* captureFile;
+  FDelegateHandle tickerHandle;
+  uint64 frameNumber;
+  // Cycles for the cycle stats, values for the counters
+  uint64 frameValues[EBBotsStat::EMax];
+
+  // Writes the row of the frame that ended and resets the per frame values
+  bool EndFrame(float deltaSeconds);
+};
+
+// Times the enclosing scope into the CSV capture
+class FBBotsCsvScopeCycleCounter
+{
+public:
+  FORCEINLINE FBBotsCsvScopeCycleCounter(EBBotsStat::Type inStat)
+    : stat(inStat), startCycles(FBBotsCsvProfiler::Get().IsCapturing() ? FPlatformTime::Cycles() : 0)
+  {}
+
+  FORCEINLINE ~FBBotsCsvScopeCycleCounter()
+  {
+    if (startCycles != 0 && FBBotsCsvProfiler::Get().IsCapturing())
+    {
+      FBBotsCsvProfiler::Get().AddCycles(stat, FPlatformTime::Cycles() - startCycles);
+    }
+  }
+
+private:
+  EBBotsStat::Type stat;
+  uint32 startCycles;
+};
+
+// Stat is the suffix of both the STAT_BBots_ and EBBotsStat::E names, ex: BBOTS_SCOPE_CYCLE_COUNTER(TakeDamage)
+#define BBOTS_SCOPE_CYCLE_COUNTER(Stat) \
+  SCOPE_CYCLE_COUNTER(STAT_BBots_##Stat); \
+  FBBotsCsvScopeCycleCounter BBotsCsvScope_##Stat(EBBotsStat::E##Stat)
+
+#define BBOTS_INC_COUNTER(Stat, Amount) \
+  INC_DWORD_STAT_BY(STAT_BBots_##Stat, Amount); \
+  FBBotsCsvProfiler::Get().AddToCounter(EBBotsStat::E##Stat, Amount)
+
+#define BBOTS_SET_COUNTER(Stat, Value) \
+  SET_DWORD_STAT(STAT_BBots_##Stat, Value); \
+  FBBotsCsvProfiler::Get().SetCounter(EBBotsStat::E##Stat, Value)
@@ -12,5 +12,7 @@
 
 DECLARE_LOG_CATEGORY_EXTERN(LogBattleBots, Log, All);
 
+#include "BBotsStats.h"
+
 
 #endif
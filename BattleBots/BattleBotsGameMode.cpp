@@ -8,6 +8,15 @@
 #include "Online/BBotsSpectatorPawn.h"
 #include "BattleBotsPlayerController.h"
 #include "BattleBotsCharacter.h"
+#include "SpellSystem/SpellSystem.h"
+#include "SpellSystem/SpellPool.h"
+#include "SpellSystem/SpellAOEScheduler.h"
+#include "SpellSystem/StatusEffectManager.h"
+#include "World/BBotsSpatialGrid.h"
+#include "SpellSystem/SpellProjectileManager.h"
+#include "Combat/BBotsCombatLog.h"
+#include "World/BBotsResetRegistry.h"
+#include "World/BBotsSpawnTable.h"
 
 ABattleBotsGameMode::ABattleBotsGameMode(const FObjectInitializer& ObjectInitializer) : Super(ObjectInitializer)
 {
@@ -35,6 +44,8 @@ ABattleBotsGameMode::ABattleBotsGameMode(const FObjectInitializer& ObjectInitial
   maxNumOfRounds = 1;
   roundTime = 10;
   timeBetweenMatches = 1;
+  roundEndTime = 0.f;
+  roundKillLimit = 0;
   killScore = 0;
   deathScore = 0;
   bAllowFriendlyFireDamage = false;
@@ -44,60 +55,214 @@ void ABattleBotsGameMode::PreInitializeComponents()
 {
   Super::PreInitializeComponents();
 
-  /* Set timer to run every second */
-  GetWorldTimerManager().SetTimer(defaultTimerHandler, this, &ABattleBotsGameMode::DefaultTimer, GetWorldSettings()->GetEffectiveTimeDilation(), true);
+  FActorSpawnParameters spawnInfo;
+  spawnInfo.Instigator = Instigator;
+  spawnInfo.bNoCollisionFail = true;
+  // We never want the spell managers to be saved into a map
+  spawnInfo.ObjectFlags |= RF_Transient;
+
+  // Spawn the reset registry first, the managers below register with it on BeginPlay
+  resetRegistry = GetWorld()->SpawnActor<ABBotsResetRegistry>(ABBotsResetRegistry::StaticClass(), spawnInfo);
+
+  // Spawn the per world spell pool, the spell bars pre-warm it as spells are added
+  spellPool = GetWorld()->SpawnActor<ASpellPool>(ASpellPool::StaticClass(), spawnInfo);
+
+  // Spawn the per world AOE scheduler, AOE spells register their volumes on cast
+  aoeScheduler = GetWorld()->SpawnActor<ASpellAOEScheduler>(ASpellAOEScheduler::StaticClass(), spawnInfo);
+
+  // Spawn the per world status effect manager, spells hand it their ignites, poisons and slows
+  statusEffectManager = GetWorld()->SpawnActor<AStatusEffectManager>(AStatusEffectManager::StaticClass(), spawnInfo);
+
+  // Spawn the per world spatial grid, characters register themselves on spawn
+  spatialGrid = GetWorld()->SpawnActor<ABBotsSpatialGrid>(ABBotsSpatialGrid::StaticClass(), spawnInfo);
+
+  // Spawn the per world projectile manager, it replicates to the clients to simulate the projectile fx
+  projectileManager = GetWorld()->SpawnActor<ASpellProjectileManager>(ASpellProjectileManager::StaticClass(), spawnInfo);
+
+  // Spawn the per match combat log, the characters, spells and status effects append to it
+  combatLog = GetWorld()->SpawnActor<ABBotsCombatLog>(ABBotsCombatLog::StaticClass(), spawnInfo);
+
+  // Spawn the per map spawn table, it scores the team starts from the spatial grid and AOE volumes
+  spawnTable = GetWorld()->SpawnActor<ABBotsSpawnTable>(ABBotsSpawnTable::StaticClass(), spawnInfo);
+
+  // Soak runs on dedicated servers capture the whole match
+  if (FParse::Param(FCommandLine::Get(), TEXT("BBotsCsv")))
+  {
+    FBBotsCsvProfiler::Get().BeginCapture(GetWorld()->GetMapName());
+  }
+
+  // The game state was spawned by Super, hand it the manager so the clients can predict their projectiles
+  ABBotsGameState* const MyGameState = Cast<ABBotsGameState>(GameState);
+  if (MyGameState)
+  {
+    MyGameState->projectileManager = projectileManager;
+  }
 }
 
-void ABattleBotsGameMode::DefaultTimer()
+void ABattleBotsGameMode::EndPlay(const EEndPlayReason::Type EndPlayReason)
 {
-  // start match if necessary.
-//   if (GetMatchState() == MatchState::WaitingToStart)
-//   {
-//     StartMatch();
-//   }
-  // don't update timers for Play In Editor mode, it's not real match
-  if (bSkipMatchTimers && GetWorld()->IsPlayInEditor()){ return; }
+  FBBotsCsvProfiler::Get().EndCapture();
 
-  ABBotsGameState* const MyGameState = Cast<ABBotsGameState>(GameState);
-  GEngine->AddOnScreenDebugMessage(-1, 2.f, FColor::Yellow, TEXT("Time Remaining: ") + FString::FromInt(MyGameState->remainingTime));
+  Super::EndPlay(EndPlayReason);
+}
 
-  if (MyGameState
-    && MyGameState->GetRoundsThisMatch() <= maxNumOfRounds
-    && !MyGameState->bTimerPaused
-    && GetMatchState() == MatchState::InProgress)
+void ABattleBotsGameMode::DumpSpellPoolStats()
+{
+  if (spellPool)
   {
-    GEngine->AddOnScreenDebugMessage(-1, 2.f, FColor::Cyan, TEXT("ROUND: ") + FString::FromInt(MyGameState->GetRoundsThisMatch()));
+    spellPool->LogPoolStats();
+  }
+}
 
-    // Decrement the remaining time every second
-    MyGameState->remainingTime--;
+void ABattleBotsGameMode::DumpNetStats()
+{
+  for (FConstPlayerControllerIterator It = GetWorld()->GetPlayerControllerIterator(); It; ++It)
+  {
+    UNetConnection* connection = (*It)->GetNetConnection();
+    if (!connection || (*It)->IsLocalController())
+    {
+      continue;
+    }
 
-    if (MyGameState->remainingTime <= 0)
+    // Spell channels should follow what the player can see, not the total spell count
+    int32 numSpellChannels = 0;
+    for (auto ChannelIt = connection->ActorChannels.CreateConstIterator(); ChannelIt; ++ChannelIt)
     {
-      if (MyGameState->GetRoundsThisMatch() < maxNumOfRounds)
+      UActorChannel* channel = ChannelIt.Value();
+      if (channel && Cast<ASpellSystem>(channel->GetActor()))
       {
-        EndOfRoundReset();
-        MyGameState->remainingTime = roundTime;
-        MyGameState->IncRoundsThisMatch();
-      }
-      else{
-        GEngine->AddOnScreenDebugMessage(-1, 5.f, FColor::Magenta, TEXT("FINISHING UP MATCH"));
-        // The game is over Exit to PostGame Lobby / Update LeaderBoards
-        FinishMatch();
+        numSpellChannels++;
       }
     }
+
+    UE_LOG(LogBattleBots, Log, TEXT("NetStats %s: out %d B/s, in %d B/s, actor channels %d, spell channels %d, dormant actors %d"),
+      *GetNameSafe((*It)->PlayerState),
+      connection->OutBytesPerSecond,
+      connection->InBytesPerSecond,
+      connection->ActorChannels.Num(),
+      numSpellChannels,
+      connection->DormantActors.Num());
   }
 }
 
-void ABattleBotsGameMode::HandleMatchHasStarted()
+void ABattleBotsGameMode::BBotsCsvStart(const FString& captureName)
 {
-  Super::HandleMatchHasStarted();
+  FBBotsCsvProfiler::Get().BeginCapture(captureName.IsEmpty() ? GetWorld()->GetMapName() : captureName);
+}
 
+void ABattleBotsGameMode::BBotsCsvStop()
+{
+  FBBotsCsvProfiler::Get().EndCapture();
+}
+
+void ABattleBotsGameMode::SetMatchPhase(EMatchPhase::Type newPhase, float duration)
+{
   ABBotsGameState* const MyGameState = Cast<ABBotsGameState>(GameState);
-  if (MyGameState)
+  if (!MyGameState)
+  {
+    return;
+  }
+
+  GetWorldTimerManager().ClearTimer(phaseTimerHandle);
+
+  // don't run round timers for Play In Editor mode, it's not real match
+  const bool bRoundPhase = newPhase == EMatchPhase::EWarmup || newPhase == EMatchPhase::EInRound;
+  if (bRoundPhase && bSkipMatchTimers && GetWorld()->IsPlayInEditor())
+  {
+    MyGameState->SetMatchPhase(newPhase, 0.f);
+    return;
+  }
+
+  if (duration <= 0.f)
   {
-    MyGameState->remainingTime = warmupTime;
+    // Nothing to wait for, go straight to the next phase
+    MyGameState->SetMatchPhase(newPhase, 0.f);
+    OnPhaseTimeUp();
+    return;
   }
 
+  // Only the end time replicates, the clients count down on their own
+  MyGameState->SetMatchPhase(newPhase, GetWorld()->GetTimeSeconds() + duration);
+  GetWorldTimerManager().SetTimer(phaseTimerHandle, this, &ABattleBotsGameMode::OnPhaseTimeUp, duration, false);
+}
+
+void ABattleBotsGameMode::OnPhaseTimeUp()
+{
+  BBOTS_SCOPE_CYCLE_COUNTER(MatchPhase);
+
+  ABBotsGameState* const MyGameState = Cast<ABBotsGameState>(GameState);
+  if (!MyGameState)
+  {
+    return;
+  }
+
+  switch (MyGameState->GetMatchPhase())
+  {
+  case EMatchPhase::EWarmup:
+    WarmUpTimeEnd();
+    StartNextRound();
+    break;
+
+  case EMatchPhase::EInRound:
+    EndRound();
+    break;
+
+  case EMatchPhase::ERoundEnd:
+    EndOfRoundReset();
+    StartNextRound();
+    break;
+
+  case EMatchPhase::EMatchEnd:
+    MyGameState->SetMatchPhase(EMatchPhase::EPostGame, 0.f);
+    // Game is over, load post game lobby or a new map
+    LoadNextMap();
+    break;
+
+  default:
+    break;
+  }
+}
+
+void ABattleBotsGameMode::StartNextRound()
+{
+  ABBotsGameState* const MyGameState = Cast<ABBotsGameState>(GameState);
+  if (!MyGameState)
+  {
+    return;
+  }
+
+  MyGameState->IncRoundsThisMatch();
+  GEngine->AddOnScreenDebugMessage(-1, 2.f, FColor::Cyan, TEXT("ROUND: ") + FString::FromInt(MyGameState->GetRoundsThisMatch()));
+
+  SetMatchPhase(EMatchPhase::EInRound, roundTime);
+}
+
+void ABattleBotsGameMode::EndRound()
+{
+  ABBotsGameState* const MyGameState = Cast<ABBotsGameState>(GameState);
+  if (!MyGameState || MyGameState->GetMatchPhase() != EMatchPhase::EInRound)
+  {
+    return;
+  }
+
+  if (MyGameState->GetRoundsThisMatch() < maxNumOfRounds)
+  {
+    SetMatchPhase(EMatchPhase::ERoundEnd, roundEndTime);
+  }
+  else
+  {
+    GEngine->AddOnScreenDebugMessage(-1, 5.f, FColor::Magenta, TEXT("FINISHING UP MATCH"));
+    // The game is over Exit to PostGame Lobby / Update LeaderBoards
+    FinishMatch();
+  }
+}
+
+void ABattleBotsGameMode::HandleMatchHasStarted()
+{
+  Super::HandleMatchHasStarted();
+
+  SetMatchPhase(EMatchPhase::EWarmup, warmupTime);
+
   // Notify players that the game has started
   for (FConstControllerIterator It = GetWorld()->GetControllerIterator(); It; ++It)
   {
@@ -112,7 +277,6 @@ void ABattleBotsGameMode::HandleMatchHasStarted()
 
 void ABattleBotsGameMode::FinishMatch()
 {
-  ABBotsGameState* const MyGameState = Cast<ABBotsGameState>(GameState);
   if (IsMatchInProgress())
   {
     EndMatch();
@@ -136,14 +300,11 @@ void ABattleBotsGameMode::FinishMatch()
       (*It)->TurnOff();
     }
 
-    // set up to restart the match
-    MyGameState->remainingTime = timeBetweenMatches;
-
     // Set match is over
     bMatchOver = true;
-    
-    // Game is over, load post game lobby or a new map
-    LoadNextMap();
+
+    // The next map loads when the match end phase is up
+    SetMatchPhase(EMatchPhase::EMatchEnd, timeBetweenMatches);
   }
 }
 
@@ -178,6 +339,23 @@ void ABattleBotsGameMode::Killed(AController* killer, AController* killedPlayer,
     victimPlayerState->ScoreDeath(killerPlayerState, deathScore);
     GEngine->AddOnScreenDebugMessage(-1, 5.f, FColor::Cyan, TEXT("Character Died: ") + FString::FromInt(victimPlayerState->GetDeaths()));
   }
+
+  // Kills are cleared by the round reset, so they count for this round only
+  if (roundKillLimit > 0 && killerPlayerState && killerPlayerState != victimPlayerState && killerPlayerState->GetKills() >= roundKillLimit)
+  {
+    ABBotsGameState* const MyGameState = Cast<ABBotsGameState>(GameState);
+    if (MyGameState && MyGameState->GetMatchPhase() == EMatchPhase::EInRound)
+    {
+      // End the round on the next tick, the round reset destroys pawns and this pawn is still dying
+      GetWorldTimerManager().SetTimer(phaseTimerHandle, this, &ABattleBotsGameMode::OnPhaseTimeUp, SMALL_NUMBER, false);
+    }
+  }
+
+  // Steer the next respawns away from where players are dying
+  if (spawnTable && killedPawn)
+  {
+    spawnTable->RecordDeath(killedPawn->GetActorLocation());
+  }
 }
 
 bool ABattleBotsGameMode::CanDealDamage(AController* damageInstigator, AController* damagedPlayer) const
@@ -192,7 +370,16 @@ bool ABattleBotsGameMode::CanDealDamage(AController* damageInstigator, AControll
   {
     GEngine->AddOnScreenDebugMessage(-1, 5.f, FColor::Cyan, TEXT("We are the same team!!!: "));
   }
-  return killerPlayerState && victimPlayerState && (killerPlayerState->GetTeamNum() != victimPlayerState->GetTeamNum());
+  return killerPlayerState && victimPlayerState && CanTeamsDealDamage(killerPlayerState->GetTeamNum(), victimPlayerState->GetTeamNum());
+}
+
+bool ABattleBotsGameMode::CanTeamsDealDamage(uint8 instigatorTeam, uint8 damagedTeam) const
+{
+  // Same rules as CanDealDamage, friendly fire hits everyone, even players without a PlayerState
+  if (bAllowFriendlyFireDamage)
+    return true;
+
+  return instigatorTeam != 255 && damagedTeam != 255 && instigatorTeam != damagedTeam;
 }
 
 bool ABattleBotsGameMode::CanRespawnImmediately()
@@ -210,22 +397,26 @@ bool ABattleBotsGameMode::CanSpectate_Implementation(APlayerController* Viewer,
 
 void ABattleBotsGameMode::EndOfRoundReset()
 {
-  for (FActorIterator It(GetWorld()); It; ++It)
+  if (resetRegistry)
   {
-    if (It->GetClass()->ImplementsInterface(UBBotsResetInterface::StaticClass()))
-    {
-      IBBotsResetInterface::Execute_Reset(*It);
-    }
+    resetRegistry->ResetActors();
   }
 
   // Destroys all dead bodies; using RESET interface did not delete all of them in time
-  for (TObjectIterator<APawn> Itr; Itr; ++Itr)
+  TArray<APawn*, TInlineAllocator<16>> deadPawns;
+  for (FConstPawnIterator It = GetWorld()->GetPawnIterator(); It; ++It)
   {
-    if (!Itr->Controller)
+    if (*It && !(*It)->Controller)
     {
-      Itr->Destroy();
+      deadPawns.Add(*It);
     }
   }
+
+  // Destroy removes the pawn from the world's pawn list, so not while iterating it
+  for (APawn* deadPawn : deadPawns)
+  {
+    deadPawn->Destroy();
+  }
 }
 
 void ABattleBotsGameMode::WarmUpTimeEnd()
@@ -245,22 +436,24 @@ bool ABattleBotsGameMode::ReadyToEndMatch()
   return false;
 }
 
-AActor* ABattleBotsGameMode::ChoosePlayerStart_Implementation(AController* Player)
+AActor* ABattleBotsGameMode::ChooseTeamStart(AController* Player) const
 {
-  // Choose a player start
-  ABBotsPlayerStart* FoundPlayerStart = NULL;
-  ABBotsPlayerState* PState = Cast<ABBotsPlayerState>(Player->PlayerState);
-
-  for (TActorIterator<ABBotsPlayerStart> It(GetWorld()); It; ++It)
+  ABBotsPlayerState* PState = Player ? Cast<ABBotsPlayerState>(Player->PlayerState) : NULL;
+  if (!PState || !spawnTable)
   {
-    ABBotsPlayerStart* PlayerStart = *It;
+    return NULL;
+  }
 
-    if (PlayerStart->GetTeamNum() == PState->GetTeamNum())
-    {
-      // Only spawn at team spawn location
-      FoundPlayerStart = PlayerStart;
-      return FoundPlayerStart;
-    }
+  // Only spawn at team spawn location
+  return spawnTable->ChoosePlayerStart(PState->GetTeamNum());
+}
+
+AActor* ABattleBotsGameMode::ChoosePlayerStart_Implementation(AController* Player)
+{
+  AActor* FoundPlayerStart = ChooseTeamStart(Player);
+  if (FoundPlayerStart)
+  {
+    return FoundPlayerStart;
   }
 
   GEngine->AddOnScreenDebugMessage(-1, 2.f, FColor::Red, TEXT("PlayerStart Failed!"));
@@ -268,25 +461,14 @@ AActor* ABattleBotsGameMode::ChoosePlayerStart_Implementation(AController* Playe
   return Super::ChoosePlayerStart_Implementation(Player);
 }
 
-
-
 AActor* ABattleBotsGameMode::FindPlayerStart_Implementation(AController* Player, const FString& IncomingName)
 {
-  ABBotsPlayerState* PState = Cast<ABBotsPlayerState>(Player->PlayerState);
-  for (TActorIterator<ABBotsPlayerStart> It(GetWorld()); It; ++It)
+  AActor* FoundPlayerStart = ChooseTeamStart(Player);
+  if (FoundPlayerStart)
   {
-    ABBotsPlayerStart* PlayerStart = *It;
-
-    if (PlayerStart->GetTeamNum() == PState->GetTeamNum())
-    {
-      // Only spawn at team spawn location
-      return PlayerStart;
-    }
+    return FoundPlayerStart;
   }
+
   // Else return the original spawn spot
   return Super::FindPlayerStart_Implementation(Player, IncomingName);
 }
-
-
-
-
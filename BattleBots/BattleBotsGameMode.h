@@ -1,10 +1,20 @@
 // Copyright 2015 VMR Games, Inc. All Rights Reserved.
 #pragma once
 #include "Online/BBotsPlayerState.h"
+#include "Online/BBotsGameState.h"
 #include "Online/BBotsBaseGameMode.h"
 #include "GameFramework/GameMode.h"
 #include "BattleBotsGameMode.generated.h"
 
+class ASpellPool;
+class ASpellAOEScheduler;
+class AStatusEffectManager;
+class ABBotsSpatialGrid;
+class ASpellProjectileManager;
+class ABBotsCombatLog;
+class ABBotsResetRegistry;
+class ABBotsSpawnTable;
+
 // UCLASS(config=Game)
 
 UCLASS(minimalapi)
@@ -17,6 +27,9 @@ public:
   
   // Starts the default timer to manage when the game should start
   virtual void PreInitializeComponents() override;
+
+  // Ends the CSV capture of the match
+  virtual void EndPlay(const EEndPlayReason::Type EndPlayReason) override;
   
   /** always pick new random spawn */
   //virtual bool ShouldSpawnAtStartSpot(AController* Player) override;
@@ -27,6 +40,9 @@ public:
   /** can players damage each other? */
   virtual bool CanDealDamage(AController* damageInstigator, AController* damagedPlayer) const;
 
+  /** can players of these teams damage each other? 255 is a player without a PlayerState. CanDealDamage goes through it */
+  virtual bool CanTeamsDealDamage(uint8 instigatorTeam, uint8 damagedTeam) const;
+
   /** starts new match */
   virtual void HandleMatchHasStarted() override;
 
@@ -41,10 +57,59 @@ public:
   UFUNCTION(exec)
   void FinishMatch();
 
+  // Returns the pool used to recycle spell actors, only valid on the server
+  FORCEINLINE ASpellPool* GetSpellPool() const { return spellPool; }
+
+  // Returns the scheduler that deals damage for every live AOE volume, only valid on the server
+  FORCEINLINE ASpellAOEScheduler* GetAOEScheduler() const { return aoeScheduler; }
+
+  // Returns the manager that runs every ignite, poison and slow, only valid on the server
+  FORCEINLINE AStatusEffectManager* GetStatusEffectManager() const { return statusEffectManager; }
+
+  // Returns the spatial index of all living characters, only valid on the server
+  FORCEINLINE ABBotsSpatialGrid* GetSpatialGrid() const { return spatialGrid; }
+
+  // Returns the manager that simulates every non-piercing projectile, only valid on the server
+  FORCEINLINE ASpellProjectileManager* GetProjectileManager() const { return projectileManager; }
+
+  // Returns the binary combat event log of the match, only valid on the server
+  FORCEINLINE ABBotsCombatLog* GetCombatLog() const { return combatLog; }
+
+  // Returns the registry of the actors reset between rounds, only valid on the server
+  FORCEINLINE ABBotsResetRegistry* GetResetRegistry() const { return resetRegistry; }
+
+  // Returns the scored player starts of each team, only valid on the server
+  FORCEINLINE ABBotsSpawnTable* GetSpawnTable() const { return spawnTable; }
+
+  /** prints spell pool hit/miss stats to the log */
+  UFUNCTION(exec)
+  void DumpSpellPoolStats();
+
+  /** prints the bandwidth and open spell channels of every client connection to the log */
+  UFUNCTION(exec)
+  void DumpNetStats();
+
+  /** starts writing the BattleBots stats of every frame to Saved/Profiling/BBotsCsv */
+  UFUNCTION(exec)
+  void BBotsCsvStart(const FString& captureName);
+
+  /** ends the CSV capture */
+  UFUNCTION(exec)
+  void BBotsCsvStop();
+
 protected:
   
-  // Manages game timers for starting and ending the match.
-  virtual void DefaultTimer();
+  // Enters a match phase that ends after duration seconds, a phase without duration advances right away
+  void SetMatchPhase(EMatchPhase::Type newPhase, float duration);
+
+  // Advances the match when the current phase is up
+  virtual void OnPhaseTimeUp();
+
+  // Starts the next round of the match
+  virtual void StartNextRound();
+
+  // Ends the current round, or the match after the last round
+  virtual void EndRound();
 
   // Gets called when warm-up time is over and game is ready to start
   virtual void WarmUpTimeEnd();
@@ -69,8 +134,8 @@ protected:
   and not the original spawn spot at the beginning of the game. */
   virtual AActor* FindPlayerStart_Implementation(AController* Player, const FString& IncomingName) override;
 
-  // Handles the DefaultTimer timer - runs every second
-  FTimerHandle defaultTimerHandler;
+  // Fires when the current match phase is up
+  FTimerHandle phaseTimerHandle;
 
   // The maximum number of rounds before exiting
   UPROPERTY(EditDefaultsOnly, Category = "Rules")
@@ -87,6 +152,14 @@ protected:
   UPROPERTY(EditDefaultsOnly, Category = "Rules")
   int32 timeBetweenMatches;
 
+  /** time between the end of a round and the next one, 0 starts the next round right away */
+  UPROPERTY(EditDefaultsOnly, Category = "Rules")
+  float roundEndTime;
+
+  /** the round ends when a player reaches this many kills, 0 for no limit */
+  UPROPERTY(EditDefaultsOnly, Category = "Rules")
+  int32 roundKillLimit;
+
   /** score for kill */
   UPROPERTY(EditDefaultsOnly, Category = "Score Rules")
   int32 killScore;
@@ -133,6 +206,41 @@ protected:
 private:
   // The time when the game started
   float gameStartTime;
+
+  // Recycles spell actors instead of spawning/destroying them every cast
+  UPROPERTY(Transient)
+  ASpellPool* spellPool;
+
+  // Deals the damage of all AOE volumes in one pass
+  UPROPERTY(Transient)
+  ASpellAOEScheduler* aoeScheduler;
+
+  // Runs all status effects (Ignite, poison, slow) in one batched update
+  UPROPERTY(Transient)
+  AStatusEffectManager* statusEffectManager;
+
+  // Answers radius, nearest and cone queries over the living characters
+  UPROPERTY(Transient)
+  ABBotsSpatialGrid* spatialGrid;
+
+  // Moves and hit tests the non-piercing projectiles in one batched step
+  UPROPERTY(Transient)
+  ASpellProjectileManager* projectileManager;
+
+  // Writes the combat events of the match to disk off the game thread
+  UPROPERTY(Transient)
+  ABBotsCombatLog* combatLog;
+
+  // Every IBBotsResetInterface implementer of the world, by reset priority
+  UPROPERTY(Transient)
+  ABBotsResetRegistry* resetRegistry;
+
+  // Picks the safest start of a team, built once per map
+  UPROPERTY(Transient)
+  ABBotsSpawnTable* spawnTable;
+
+  // Returns the spawn table start for the team of Player, null if there is none
+  AActor* ChooseTeamStart(AController* Player) const;
 };
 
 
@@ -3,13 +3,28 @@
 #include "BattleBots.h"
 #include "UI/ChatBlockWidget.h"
 #include "Character/BBotCharacter.h"
+#include "Online/BBotsGameState.h"
+#include "SpellSystem/SpellProjectileManager.h"
 #include "BattleBotsPlayerController.h"
 #include "AI/Navigation/NavigationSystem.h"
+#include "AI/Navigation/NavigationPath.h"
 
 ABattleBotsPlayerController::ABattleBotsPlayerController(const FObjectInitializer& ObjectInitializer)
   : Super(ObjectInitializer)
 {
   bRotChanged = false;
+
+  moveGoalTolerance = 50.f;
+  pathReuseDistance = 300.f;
+  pathPointAcceptanceRadius = 50.f;
+  maxPathQueriesPerSecond = 4.f;
+  movePathIndex = 0;
+  lastQueriedGoal = FVector::ZeroVector;
+  bHasPendingMoveGoal = false;
+  nextPathQueryTime = 0.f;
+  numPathQueries = 0;
+  numMoveRequests = 0;
+
   bShowMouseCursor = true;
   DefaultMouseCursor = EMouseCursor::Crosshairs;
 
@@ -25,16 +40,35 @@ void ABattleBotsPlayerController::BeginPlay()
 {
   Super::BeginPlay();
 
+  RegisterForReset(this, EResetPriority::EControllers);
+
   // Init default values on the server
   InitPostRoundReset();
 }
 
+void ABattleBotsPlayerController::EndPlay(const EEndPlayReason::Type EndPlayReason)
+{
+  UnregisterForReset(this);
+
+  Super::EndPlay(EndPlayReason);
+}
+
 void ABattleBotsPlayerController::PlayerTick(float DeltaTime)
 {
+  BBOTS_SCOPE_CYCLE_COUNTER(PlayerTick);
   Super::PlayerTick(DeltaTime);
 
   // keep updating the destination every tick while desired
-  MoveToMouseCursor();
+  if (bMoveToMouseCursor)
+  {
+    MoveToMouseCursor();
+  }
+
+  // Touch goals are set once, the path is followed until the pawn reaches it
+  if (movePathIndex < movePath.Num() || bHasPendingMoveGoal)
+  {
+    FollowMovePath();
+  }
 
   if (playerCharacter && bRotChanged)
   {
@@ -72,11 +106,116 @@ void ABattleBotsPlayerController::MoveToMouseCursor()
   FHitResult Hit;
   GetHitResultUnderCursor(ECC_Visibility, false, Hit);
 
-  if (bMoveToMouseCursor && Hit.bBlockingHit)
+  if (Hit.bBlockingHit)
   {
     // We hit something, move there
-    SetNewMoveDestination(Hit.ImpactPoint);
+    RequestMoveTo(Hit.ImpactPoint);
+  }
+}
+
+void ABattleBotsPlayerController::RequestMoveTo(const FVector& goal)
+{
+  numMoveRequests++;
+
+  // The cursor rarely moves far between frames, most requests end here
+  if (movePath.Num() > 0 && FVector::DistSquared(goal, movePath.Last()) <= FMath::Square(moveGoalTolerance))
+  {
+    bHasPendingMoveGoal = false;
+    return;
+  }
+
+  /* A small shift keeps the path, only its end moves. The shift is measured from the
+  / goal of the last query, so a dragged cursor cannot walk the path away from the navmesh. */
+  if (movePath.Num() > 0 && FVector::DistSquared(goal, lastQueriedGoal) <= FMath::Square(pathReuseDistance))
+  {
+    movePath.Last() = goal;
+    movePathIndex = FMath::Min(movePathIndex, movePath.Num() - 1);
+    bHasPendingMoveGoal = false;
+    return;
+  }
+
+  if (GetWorld()->GetTimeSeconds() < nextPathQueryTime)
+  {
+    // Keep following the current path, the latest goal is queried when the next slot opens
+    pendingMoveGoal = goal;
+    bHasPendingMoveGoal = true;
+    return;
+  }
+
+  QueryMovePath(goal);
+}
+
+void ABattleBotsPlayerController::QueryMovePath(const FVector& goal)
+{
+  APawn* const Pawn = GetPawn();
+  bHasPendingMoveGoal = false;
+
+  if (!Pawn)
+  {
+    return;
+  }
+
+  movePath.Reset();
+  movePathIndex = 0;
+  lastQueriedGoal = goal;
+
+  /* Clients only have navigation data when client side navigation is enabled.
+  / Without it the goal is a straight line, which is neither counted nor throttled. */
+  UNavigationSystem* const NavSys = GetWorld()->GetNavigationSystem();
+  if (NavSys && NavSys->GetMainNavData(FNavigationSystem::DontCreate))
+  {
+    nextPathQueryTime = GetWorld()->GetTimeSeconds() + (maxPathQueriesPerSecond > 0.f ? 1.f / maxPathQueriesPerSecond : 0.f);
+    numPathQueries++;
+    BBOTS_INC_COUNTER(PathQueries, 1);
+
+    UNavigationPath* const NavPath = NavSys->FindPathToLocationSynchronously(this, Pawn->GetActorLocation(), goal, Pawn);
+    if (NavPath && NavPath->IsValid() && NavPath->PathPoints.Num() > 1)
+    {
+      // The first point is where the pawn stands
+      movePath.Append(NavPath->PathPoints.GetData() + 1, NavPath->PathPoints.Num() - 1);
+      movePath.Last() = goal;
+      return;
+    }
   }
+
+  movePath.Add(goal);
+}
+
+void ABattleBotsPlayerController::FollowMovePath()
+{
+  APawn* const Pawn = GetPawn();
+  if (!Pawn)
+  {
+    // The pawn died, the next one does not walk to the old goal
+    ClearMovePath();
+    return;
+  }
+
+  if (bHasPendingMoveGoal && GetWorld()->GetTimeSeconds() >= nextPathQueryTime)
+  {
+    QueryMovePath(pendingMoveGoal);
+  }
+
+  const FVector PawnLocation = Pawn->GetActorLocation();
+  const float AcceptanceRadiusSquared = FMath::Square(pathPointAcceptanceRadius);
+
+  // Drop the points the pawn already passed
+  while (movePathIndex < movePath.Num() && FVector::DistSquaredXY(PawnLocation, movePath[movePathIndex]) <= AcceptanceRadiusSquared)
+  {
+    movePathIndex++;
+  }
+
+  if (movePathIndex < movePath.Num())
+  {
+    SetNewMoveDestination(movePath[movePathIndex]);
+  }
+}
+
+void ABattleBotsPlayerController::ClearMovePath()
+{
+  movePath.Reset();
+  movePathIndex = 0;
+  bHasPendingMoveGoal = false;
 }
 
 void ABattleBotsPlayerController::MoveToTouchLocation(const ETouchIndex::Type FingerIndex, const FVector Location)
@@ -90,7 +229,7 @@ void ABattleBotsPlayerController::MoveToTouchLocation(const ETouchIndex::Type Fi
   if (HitResult.bBlockingHit)
   {
     // We hit something, move there
-    SetNewMoveDestination(HitResult.ImpactPoint);
+    RequestMoveTo(HitResult.ImpactPoint);
   }
 }
 
@@ -117,6 +256,7 @@ void ABattleBotsPlayerController::OnSetDestinationReleased()
 {
   // clear flag to indicate we should stop updating the destination
   bMoveToMouseCursor = false;
+  ClearMovePath();
 }
 
 ABBotCharacter* ABattleBotsPlayerController::ReferencePossessedPawn()
@@ -240,6 +380,7 @@ void ABattleBotsPlayerController::RotateToMouseCursor()
 
 void ABattleBotsPlayerController::ServerRotateToMouseCursor_Implementation(FRotator newRotation)
 {
+  BBOTS_INC_COUNTER(RPCs, 1);
   if (!playerCharacter)
     return;
 
@@ -331,10 +472,31 @@ void ABattleBotsPlayerController::ViewAPlayer(int32 dir)
 
 void ABattleBotsPlayerController::ClientSetSpectatorCamera_Implementation(FVector CameraLocation, FRotator CameraRotation)
 {
+  BBOTS_INC_COUNTER(RPCs, 1);
   SetInitialLocationAndRotation(CameraLocation, CameraRotation);
   SetViewTarget(this);
 }
 
+void ABattleBotsPlayerController::ClientLaunchProjectile_Implementation(int32 projectileId, FVector_NetQuantize origin, FVector velocity, float radius, float spawnTime, float lifeTime, TSubclassOf<ASpellSystem> spellClass, APawn* caster, int32 predictionKey)
+{
+  BBOTS_INC_COUNTER(RPCs, 1);
+  ABBotsGameState* const GS = Cast<ABBotsGameState>(GetWorld()->GameState);
+  if (GS && GS->projectileManager)
+  {
+    GS->projectileManager->ReceiveLaunch(projectileId, origin, velocity, radius, spawnTime, lifeTime, spellClass, caster, predictionKey);
+  }
+}
+
+void ABattleBotsPlayerController::ClientEndProjectile_Implementation(int32 projectileId, FVector_NetQuantize endLocation, bool bExploded)
+{
+  BBOTS_INC_COUNTER(RPCs, 1);
+  ABBotsGameState* const GS = Cast<ABBotsGameState>(GetWorld()->GameState);
+  if (GS && GS->projectileManager)
+  {
+    GS->projectileManager->ReceiveEnd(projectileId, endLocation, bExploded);
+  }
+}
+
 void ABattleBotsPlayerController::Reset()
 {
   if (HasAuthority())
@@ -391,6 +553,7 @@ void ABattleBotsPlayerController::OnRep_Pawn()
 
 void ABattleBotsPlayerController::ServerReferencePawn_Implementation()
 {
+  BBOTS_INC_COUNTER(RPCs, 1);
   playerCharacter = ReferencePossessedPawn();
 }
 
@@ -10,6 +10,7 @@
 
 
 class ABBotCharacter;
+class ASpellSystem;
 
 UCLASS()
 class ABattleBotsPlayerController : public ABBotsBasePC, public IBBotsResetInterface
@@ -29,6 +30,9 @@ protected:
   // Called when the game starts or when spawned
   virtual void BeginPlay() override;
 
+  // Unregisters from the round reset
+  virtual void EndPlay(const EEndPlayReason::Type EndPlayReason) override;
+
 	// Begin PlayerController interface
 	virtual void PlayerTick(float DeltaTime) override;
 	virtual void SetupInputComponent() override;
@@ -47,6 +51,17 @@ protected:
 	/** Navigate player to the given world location. */
 	void SetNewMoveDestination(const FVector DestLocation);
 
+  /* Sets the click to move goal. Goals within moveGoalTolerance of the current
+  / one are dropped, small shifts reuse the current path, and new paths are
+  / queried at most maxPathQueriesPerSecond. */
+  void RequestMoveTo(const FVector& goal);
+
+  // Steers the pawn along the current path, dropping the points it passed
+  void FollowMovePath();
+
+  // Stops click to move
+  void ClearMovePath();
+
 	/** Input handlers for SetDestination action. */
 	void OnSetDestinationPressed();
 	void OnSetDestinationReleased();
@@ -91,6 +106,44 @@ private:
   // Rotation is only updated if true
   bool bRotChanged;
 
+  // Goals closer than this to the current goal are dropped
+  UPROPERTY(EditDefaultsOnly, Category = "Movement")
+  float moveGoalTolerance;
+
+  // Goals closer than this to the last queried goal move the end of the current path instead of querying a new one
+  UPROPERTY(EditDefaultsOnly, Category = "Movement")
+  float pathReuseDistance;
+
+  // A path point is passed once the pawn is this close to it
+  UPROPERTY(EditDefaultsOnly, Category = "Movement")
+  float pathPointAcceptanceRadius;
+
+  // The most navigation path queries per second, the latest goal waits for the next slot
+  UPROPERTY(EditDefaultsOnly, Category = "Movement")
+  float maxPathQueriesPerSecond;
+
+  // The click to move path, the last point is the goal
+  TArray<FVector> movePath;
+
+  // The path point the pawn is heading to
+  int32 movePathIndex;
+
+  // The goal the current path was queried for, the path end may have moved since
+  FVector lastQueriedGoal;
+
+  // A goal that came in while the path queries were throttled
+  FVector pendingMoveGoal;
+  bool bHasPendingMoveGoal;
+
+  // World time of the next allowed path query
+  float nextPathQueryTime;
+
+  int32 numPathQueries;
+  int32 numMoveRequests;
+
+  // Replaces the path with a new one to goal, a straight line when there is no navigation on this machine
+  void QueryMovePath(const FVector& goal);
+
   // Helper function for casting spells on hotbar
   void CastFromSpellBarIndex(int32 index);
 
@@ -129,10 +182,26 @@ public:
   UFUNCTION(Reliable, Client)
   void ClientSetSpectatorCamera(FVector CameraLocation, FRotator CameraRotation);
 
+  // Shows a batched projectile the server found relevant to this player. Cosmetic, so it may be dropped.
+  UFUNCTION(Unreliable, Client)
+  void ClientLaunchProjectile(int32 projectileId, FVector_NetQuantize origin, FVector velocity, float radius, float spawnTime, float lifeTime, TSubclassOf<ASpellSystem> spellClass, APawn* caster, int32 predictionKey);
+
+  // Ends a projectile sent with ClientLaunchProjectile, exploding it if it hit something
+  UFUNCTION(Unreliable, Client)
+  void ClientEndProjectile(int32 projectileId, FVector_NetQuantize endLocation, bool bExploded);
+
   // Returns time till spawn
   UFUNCTION(BlueprintCallable, Category = "Respawn")
   float GetTimeTillSpawn();
 
+  // Returns the number of navigation path queries made for click to move
+  UFUNCTION(BlueprintCallable, Category = "Movement")
+  int32 GetNumPathQueries() const { return numPathQueries; }
+
+  // Returns the number of click to move goals requested, including the dropped ones
+  UFUNCTION(BlueprintCallable, Category = "Movement")
+  int32 GetNumMoveRequests() const { return numMoveRequests; }
+
 protected:
   // ReInitializes values post game reset
   void InitPostRoundReset();
@@ -0,0 +1,368 @@
+// Copyright 2015 VMR Games, Inc. All Rights Reserved.
+
+#include "BattleBots.h"
+#include "BBotAttributeStack.h"
+
+
+static_assert(EAttributeField::EMax <= 32, "Attribute dirty bits must fit in a uint32");
+static_assert(EDamageElement::EMax == BBotCombat::ElementCount, "The combat core element count is out of date");
+
+FCharacterAttributeStack::FCharacterAttributeStack()
+{
+  FMemory::Memzero(&baseAttributes, sizeof(FCharacterAttributes));
+  FMemory::Memzero(&finalAttributes, sizeof(FCharacterAttributes));
+  dirtyFields = 0;
+  bNeedsFlush = false;
+}
+
+void FCharacterAttributeStack::Init(const FCharacterAttributes& inBaseAttributes)
+{
+  baseAttributes = inBaseAttributes;
+  finalAttributes = inBaseAttributes;
+
+  for (int32 layer = 0; layer < EAttributeLayer::EMax; layer++)
+  {
+    layers[layer] = FAttributeLayer();
+  }
+
+  // Everything is folded once on the first read
+  dirtyFields = (1u << EAttributeField::EMax) - 1;
+  bNeedsFlush = true;
+}
+
+void FCharacterAttributeStack::SetMovSpeedMod(EAttributeLayer::Type layer, float newMod)
+{
+  if (layers[layer].movSpeedMod != newMod)
+  {
+    layers[layer].movSpeedMod = newMod;
+    MarkDirty(EAttributeField::EMovement);
+  }
+}
+
+void FCharacterAttributeStack::SetBlockRate(EAttributeLayer::Type layer, float newMod)
+{
+  if (layers[layer].blockRate != newMod)
+  {
+    layers[layer].blockRate = newMod;
+    MarkDirty(EAttributeField::EBlockRate);
+  }
+}
+
+void FCharacterAttributeStack::AddResist(EAttributeLayer::Type layer, EDamageElement::Type element, float resistMod)
+{
+  if (element < EDamageElement::EMax && resistMod != 0.f)
+  {
+    layers[layer].resists[element] += resistMod;
+    MarkDirty(EAttributeField::EResist + element);
+  }
+}
+
+void FCharacterAttributeStack::AddResistAll(EAttributeLayer::Type layer, float resistMod)
+{
+  for (int32 element = 0; element < EDamageElement::EMax; element++)
+  {
+    AddResist(layer, (EDamageElement::Type)element, resistMod);
+  }
+}
+
+void FCharacterAttributeStack::SetResistAll(EAttributeLayer::Type layer, float resistMod)
+{
+  for (int32 element = 0; element < EDamageElement::EMax; element++)
+  {
+    if (layers[layer].resists[element] != resistMod)
+    {
+      layers[layer].resists[element] = resistMod;
+      MarkDirty(EAttributeField::EResist + element);
+    }
+  }
+}
+
+void FCharacterAttributeStack::SetBonusDamage(EAttributeLayer::Type layer, EDamageElement::Type element, float newMod)
+{
+  if (element < EDamageElement::EMax && layers[layer].bonusDamage[element] != newMod)
+  {
+    layers[layer].bonusDamage[element] = newMod;
+    MarkDirty(EAttributeField::EBonusDamage + element);
+  }
+}
+
+void FCharacterAttributeStack::ClearLayer(EAttributeLayer::Type layer)
+{
+  layers[layer] = FAttributeLayer();
+
+  // Cheaper to re-fold everything than to diff the layer
+  dirtyFields = (1u << EAttributeField::EMax) - 1;
+  bNeedsFlush = true;
+}
+
+float FCharacterAttributeStack::GetMovementSpeed() const
+{
+  if (IsDirty(EAttributeField::EMovement))
+  {
+    FoldField(EAttributeField::EMovement);
+  }
+  return finalAttributes.movementSpeed;
+}
+
+float FCharacterAttributeStack::GetBlockRate() const
+{
+  if (IsDirty(EAttributeField::EBlockRate))
+  {
+    FoldField(EAttributeField::EBlockRate);
+  }
+  return finalAttributes.blockRate;
+}
+
+float FCharacterAttributeStack::GetGlobalCooldown() const
+{
+  if (IsDirty(EAttributeField::EGlobalCooldown))
+  {
+    FoldField(EAttributeField::EGlobalCooldown);
+  }
+  return finalAttributes.globalCooldown;
+}
+
+float FCharacterAttributeStack::GetResist(EDamageElement::Type element) const
+{
+  if (IsDirty(EAttributeField::EResist + element))
+  {
+    FoldField(EAttributeField::EResist + element);
+  }
+  return finalAttributes.resists[element];
+}
+
+float FCharacterAttributeStack::GetBonusDamage(EDamageElement::Type element) const
+{
+  if (IsDirty(EAttributeField::EBonusDamage + element))
+  {
+    FoldField(EAttributeField::EBonusDamage + element);
+  }
+  return finalAttributes.bonusDamage[element];
+}
+
+const FCharacterAttributes& FCharacterAttributeStack::GetFinalAttributes() const
+{
+  for (int32 field = 0; dirtyFields != 0 && field < EAttributeField::EMax; field++)
+  {
+    if (IsDirty(field))
+    {
+      FoldField(field);
+    }
+  }
+
+  return finalAttributes;
+}
+
+void FCharacterAttributeStack::FoldField(int32 field) const
+{
+  dirtyFields &= ~(1u << field);
+
+  if (field == EAttributeField::EMovement)
+  {
+    finalAttributes.movSpeedMod_stance = layers[EAttributeLayer::EStance].movSpeedMod;
+    finalAttributes.movSpeedMod_spells = layers[EAttributeLayer::ESpell].movSpeedMod;
+    finalAttributes.movementSpeed = BBotCombat::FoldMovementSpeed(baseAttributes.movementSpeed, layers, EAttributeLayer::EMax);
+  }
+  else if (field == EAttributeField::EBlockRate)
+  {
+    finalAttributes.blockRate = BBotCombat::FoldBlockRate(baseAttributes.blockRate, layers, EAttributeLayer::EMax);
+  }
+  else if (field == EAttributeField::EGlobalCooldown)
+  {
+    finalAttributes.globalCooldown = BBotCombat::FoldGlobalCooldown(baseAttributes.globalCooldown, layers, EAttributeLayer::EMax);
+  }
+  else if (field < EAttributeField::EBonusDamage)
+  {
+    const int32 element = field - EAttributeField::EResist;
+    finalAttributes.resists[element] = BBotCombat::FoldResist(baseAttributes.resists[element], layers, EAttributeLayer::EMax, element);
+  }
+  else
+  {
+    const int32 element = field - EAttributeField::EBonusDamage;
+    finalAttributes.bonusDamage[element] = BBotCombat::FoldBonusDamage(baseAttributes.bonusDamage[element], layers, EAttributeLayer::EMax, element);
+  }
+}
+
+bool FBBotFixedPoint::NetSerialize(FArchive& Ar, class UPackageMap* Map, bool& bOutSuccess)
+{
+  uint32 packedValue = (uint32)FMath::Max(rawValue, 0);
+  Ar.SerializeIntPacked(packedValue);
+
+  if (Ar.IsLoading())
+  {
+    rawValue = (int32)packedValue;
+  }
+
+  bOutSuccess = true;
+  return true;
+}
+
+// The attribute modifiers are clamped to [-1, 1] by the stack
+static FORCEINLINE int8 QuantizeModifier(float value)
+{
+  return (int8)FMath::RoundToInt(FMath::Clamp(value, -1.f, 1.f) * 127.f);
+}
+
+static FORCEINLINE float DequantizeModifier(int8 value)
+{
+  return value / 127.f;
+}
+
+FReplicatedAttributes::FReplicatedAttributes()
+{
+  FMemory::Memzero(this, sizeof(FReplicatedAttributes));
+}
+
+void FReplicatedAttributes::SetFromAttributes(const FCharacterAttributes& attributes)
+{
+  movementSpeed = (uint16)FMath::Clamp(FMath::RoundToInt(attributes.movementSpeed), 0, MAX_uint16);
+  movSpeedMod_spells = QuantizeModifier(attributes.movSpeedMod_spells);
+  movSpeedMod_stance = QuantizeModifier(attributes.movSpeedMod_stance);
+  blockRate = (uint8)FMath::RoundToInt(FMath::Clamp(attributes.blockRate, 0.f, 1.f) * 255.f);
+  globalCooldown = (uint16)FMath::Clamp(FMath::RoundToInt(attributes.globalCooldown * 1000.f), 0, MAX_uint16);
+
+  for (int32 element = 0; element < EDamageElement::EMax; element++)
+  {
+    resists[element] = QuantizeModifier(attributes.resists[element]);
+    bonusDamage[element] = QuantizeModifier(attributes.bonusDamage[element]);
+  }
+}
+
+void FReplicatedAttributes::ApplyTo(FCharacterAttributes& attributes) const
+{
+  attributes.movementSpeed = movementSpeed;
+  attributes.movSpeedMod_spells = DequantizeModifier(movSpeedMod_spells);
+  attributes.movSpeedMod_stance = DequantizeModifier(movSpeedMod_stance);
+  attributes.blockRate = blockRate / 255.f;
+  attributes.globalCooldown = globalCooldown / 1000.f;
+
+  for (int32 element = 0; element < EDamageElement::EMax; element++)
+  {
+    attributes.resists[element] = DequantizeModifier(resists[element]);
+    attributes.bonusDamage[element] = DequantizeModifier(bonusDamage[element]);
+  }
+}
+
+uint32 FReplicatedAttributes::GetChangedFields(const FReplicatedAttributes& other) const
+{
+  uint32 changedFields = 0;
+
+  if (movementSpeed != other.movementSpeed
+    || movSpeedMod_spells != other.movSpeedMod_spells
+    || movSpeedMod_stance != other.movSpeedMod_stance)
+  {
+    changedFields |= (1u << EAttributeField::EMovement);
+  }
+  if (blockRate != other.blockRate)
+  {
+    changedFields |= (1u << EAttributeField::EBlockRate);
+  }
+  if (globalCooldown != other.globalCooldown)
+  {
+    changedFields |= (1u << EAttributeField::EGlobalCooldown);
+  }
+
+  for (int32 element = 0; element < EDamageElement::EMax; element++)
+  {
+    if (resists[element] != other.resists[element])
+    {
+      changedFields |= (1u << (EAttributeField::EResist + element));
+    }
+    if (bonusDamage[element] != other.bonusDamage[element])
+    {
+      changedFields |= (1u << (EAttributeField::EBonusDamage + element));
+    }
+  }
+
+  return changedFields;
+}
+
+void FReplicatedAttributes::SerializeField(FArchive& Ar, int32 field)
+{
+  if (field == EAttributeField::EMovement)
+  {
+    Ar << movementSpeed;
+    Ar << movSpeedMod_spells;
+    Ar << movSpeedMod_stance;
+  }
+  else if (field == EAttributeField::EBlockRate)
+  {
+    Ar << blockRate;
+  }
+  else if (field == EAttributeField::EGlobalCooldown)
+  {
+    Ar << globalCooldown;
+  }
+  else if (field < EAttributeField::EBonusDamage)
+  {
+    Ar << resists[field - EAttributeField::EResist];
+  }
+  else
+  {
+    Ar << bonusDamage[field - EAttributeField::EBonusDamage];
+  }
+}
+
+// The last attributes sent to a connection, the next update is diffed against it
+class FReplicatedAttributesDeltaState : public INetDeltaBaseState
+{
+public:
+  FReplicatedAttributesDeltaState(const FReplicatedAttributes& inAttributes) : attributes(inAttributes) {}
+
+  virtual bool IsStateEqual(INetDeltaBaseState* otherState) override
+  {
+    return attributes == static_cast<FReplicatedAttributesDeltaState*>(otherState)->attributes;
+  }
+
+  FReplicatedAttributes attributes;
+};
+
+bool FReplicatedAttributes::NetDeltaSerialize(FNetDeltaSerializeInfo& deltaParms)
+{
+  if (deltaParms.Writer)
+  {
+    FReplicatedAttributesDeltaState* oldState = static_cast<FReplicatedAttributesDeltaState*>(deltaParms.OldState);
+
+    // New connections get every field
+    uint32 changedFields = oldState ? GetChangedFields(oldState->attributes) : (1u << EAttributeField::EMax) - 1;
+    if (changedFields == 0)
+    {
+      // Nothing to send, the connection keeps its current state
+      return false;
+    }
+
+    FBitWriter& Ar = *deltaParms.Writer;
+    Ar.SerializeBits(&changedFields, EAttributeField::EMax);
+
+    for (int32 field = 0; field < EAttributeField::EMax; field++)
+    {
+      if (changedFields & (1u << field))
+      {
+        SerializeField(Ar, field);
+      }
+    }
+
+    *deltaParms.NewState = MakeShareable(new FReplicatedAttributesDeltaState(*this));
+    return true;
+  }
+
+  if (deltaParms.Reader)
+  {
+    FBitReader& Ar = *deltaParms.Reader;
+
+    uint32 changedFields = 0;
+    Ar.SerializeBits(&changedFields, EAttributeField::EMax);
+
+    for (int32 field = 0; field < EAttributeField::EMax; field++)
+    {
+      if (changedFields & (1u << field))
+      {
+        SerializeField(Ar, field);
+      }
+    }
+
+    return !Ar.IsError();
+  }
+
+  return true;
+}
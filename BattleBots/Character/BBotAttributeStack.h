@@ -0,0 +1,223 @@
+// Copyright 2015 VMR Games, Inc. All Rights Reserved.
+
+#pragma once
+
+#include "SpellSystem/DamageTypes/BBotDmgType.h"
+#include "Combat/BBotCombatMath.h"
+#include "BBotAttributeStack.generated.h"
+
+USTRUCT()
+struct FCharacterAttributes{
+	GENERATED_USTRUCT_BODY()
+
+	UPROPERTY(EditDefaultsOnly, Category = "Movement")
+	float movementSpeed;
+  UPROPERTY(EditDefaultsOnly, Category = "Movement")
+  float movSpeedMod_spells;
+  UPROPERTY(EditDefaultsOnly, Category = "Movement")
+  float movSpeedMod_stance;
+  UPROPERTY(EditDefaultsOnly, Category = "Defenses")
+	float blockRate;
+  // Resist per damage element, indexed by EDamageElement
+  UPROPERTY(EditDefaultsOnly, Category = "Defenses", meta = (ArraySizeEnum = "EDamageElement"))
+  float resists[EDamageElement::EMax];
+  // Bonus damage per damage element, indexed by EDamageElement
+  UPROPERTY(EditDefaultsOnly, Category = "BonusDamage", meta = (ArraySizeEnum = "EDamageElement"))
+  float bonusDamage[EDamageElement::EMax];
+  UPROPERTY(EditDefaultsOnly, Category = "SpellCasting")
+  float globalCooldown;
+};
+
+// The sources of attribute modifiers, folded on top of the class default values
+namespace EAttributeLayer
+{
+  enum Type
+  {
+    EStance,
+    ESpell,
+    // Equipped items
+    EItem,
+    EMax,
+  };
+}
+
+// The cached attribute fields, each field has its own dirty bit
+namespace EAttributeField
+{
+  enum Type
+  {
+    EMovement,
+    EBlockRate,
+    EGlobalCooldown,
+    EResist,
+    EBonusDamage = EResist + EDamageElement::EMax,
+    EMax = EBonusDamage + EDamageElement::EMax,
+  };
+}
+
+// The additive modifiers of a single attribute source, folded by the combat core
+typedef BBotCombat::FAttributeLayer FAttributeLayer;
+
+// A non negative value replicated as fixed point with 1/100 precision. Used for health and oil.
+USTRUCT()
+struct FBBotFixedPoint{
+  GENERATED_USTRUCT_BODY()
+
+  // The number of fixed point steps per unit
+  static const int32 Scale = 100;
+
+  FBBotFixedPoint() : rawValue(0) {}
+
+  FORCEINLINE void Set(float newValue) { rawValue = FMath::RoundToInt(FMath::Max(newValue, 0.f) * Scale); }
+  FORCEINLINE float Get() const { return rawValue / (float)Scale; }
+
+  FORCEINLINE bool operator==(const FBBotFixedPoint& other) const { return rawValue == other.rawValue; }
+
+  // Sends the raw value packed, most health and oil values fit in 2-3 bytes
+  bool NetSerialize(FArchive& Ar, class UPackageMap* Map, bool& bOutSuccess);
+
+private:
+  UPROPERTY()
+  int32 rawValue;
+};
+
+template<>
+struct TStructOpsTypeTraits<FBBotFixedPoint> : public TStructOpsTypeTraitsBase
+{
+  enum
+  {
+    WithNetSerializer = true,
+    WithIdenticalViaEquality = true,
+  };
+};
+
+/**
+ * FReplicatedAttributes is the quantized copy of the final attributes that
+ * replicates to the owner. Modifiers are 8 bit, speed and cooldown 16 bit.
+ * Every connection keeps the last state it was sent, and only the fields
+ * that differ from it go out, behind a bitmask of EAttributeField.
+ */
+USTRUCT()
+struct FReplicatedAttributes{
+  GENERATED_USTRUCT_BODY()
+
+  FReplicatedAttributes();
+
+  // Quantizes the final attributes, server only
+  void SetFromAttributes(const FCharacterAttributes& attributes);
+
+  // Writes the dequantized values into attributes
+  void ApplyTo(FCharacterAttributes& attributes) const;
+
+  // Returns one bit per EAttributeField that differs from other
+  uint32 GetChangedFields(const FReplicatedAttributes& other) const;
+
+  FORCEINLINE bool operator==(const FReplicatedAttributes& other) const { return GetChangedFields(other) == 0; }
+
+  // Sends the changed field mask and the changed fields since the last state sent to the connection
+  bool NetDeltaSerialize(FNetDeltaSerializeInfo& deltaParms);
+
+private:
+  // Centimeters per second
+  uint16 movementSpeed;
+  // Modifiers in [-1, 1] steps of 1/127
+  int8 movSpeedMod_spells;
+  int8 movSpeedMod_stance;
+  // Block rate in [0, 1] steps of 1/255
+  uint8 blockRate;
+  // Milliseconds
+  uint16 globalCooldown;
+  int8 resists[EDamageElement::EMax];
+  int8 bonusDamage[EDamageElement::EMax];
+
+  // Reads or writes a single field
+  void SerializeField(FArchive& Ar, int32 field);
+};
+
+template<>
+struct TStructOpsTypeTraits<FReplicatedAttributes> : public TStructOpsTypeTraitsBase
+{
+  enum
+  {
+    WithNetDeltaSerializer = true,
+  };
+};
+
+/**
+ * FCharacterAttributeStack folds the stance, spell and item modifier layers
+ * on top of the class default attributes. Changing a layer only marks the
+ * affected fields dirty, the final value of a field is recomputed the next
+ * time it is read, so a stance swap or a burst of debuffs costs one fold.
+ */
+class FCharacterAttributeStack
+{
+public:
+  FCharacterAttributeStack();
+
+  // Sets the class default values the layers are folded on top of
+  void Init(const FCharacterAttributes& baseAttributes);
+
+  // Sets the movement speed mod of a layer, ex: -0.3 for a 30% slow
+  void SetMovSpeedMod(EAttributeLayer::Type layer, float newMod);
+
+  // Sets the block rate mod of a layer
+  void SetBlockRate(EAttributeLayer::Type layer, float newMod);
+
+  // Adds resistMod to the resist of a single element
+  void AddResist(EAttributeLayer::Type layer, EDamageElement::Type element, float resistMod);
+
+  // Adds resistMod to the resist of every element
+  void AddResistAll(EAttributeLayer::Type layer, float resistMod);
+
+  // Sets the resist of every element, used by stances that replace the previous stance
+  void SetResistAll(EAttributeLayer::Type layer, float resistMod);
+
+  // Sets the bonus damage of a single element
+  void SetBonusDamage(EAttributeLayer::Type layer, EDamageElement::Type element, float newMod);
+
+  // Removes every modifier of a layer
+  void ClearLayer(EAttributeLayer::Type layer);
+
+  // Returns the final movement speed, pre min/max clamp
+  float GetMovementSpeed() const;
+
+  // Returns the final block rate
+  float GetBlockRate() const;
+
+  // Returns the final global cooldown
+  float GetGlobalCooldown() const;
+
+  // Returns the final resist of an element
+  float GetResist(EDamageElement::Type element) const;
+
+  // Returns the final bonus damage of an element
+  float GetBonusDamage(EDamageElement::Type element) const;
+
+  // Folds every dirty field and returns the final attributes
+  const FCharacterAttributes& GetFinalAttributes() const;
+
+  // True if a layer changed since the final attributes were last flushed to replication
+  FORCEINLINE bool NeedsFlush() const { return bNeedsFlush; }
+  FORCEINLINE void MarkFlushed() { bNeedsFlush = false; }
+
+private:
+  // The class default values
+  FCharacterAttributes baseAttributes;
+
+  // The modifier layers, indexed by EAttributeLayer
+  FAttributeLayer layers[EAttributeLayer::EMax];
+
+  // The folded values, only valid for fields without a dirty bit
+  mutable FCharacterAttributes finalAttributes;
+
+  // One bit per EAttributeField
+  mutable uint32 dirtyFields;
+
+  bool bNeedsFlush;
+
+  FORCEINLINE void MarkDirty(int32 field) { dirtyFields |= (1u << field); bNeedsFlush = true; }
+  FORCEINLINE bool IsDirty(int32 field) const { return (dirtyFields & (1u << field)) != 0; }
+
+  // Recomputes a single field from the base and every layer, and clears its dirty bit
+  void FoldField(int32 field) const;
+};
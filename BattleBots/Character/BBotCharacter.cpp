@@ -5,12 +5,12 @@
 #include "Online/BBotsPlayerState.h"
 #include "BattleBotsGameMode.h"
 #include "SpellSystem/SpellSystem.h"
-#include "SpellSystem/DamageTypes/BBotDmgType_Holy.h"
-#include "SpellSystem/DamageTypes/BBotDmgType_Fire.h"
-#include "SpellSystem/DamageTypes/BBotDmgType_Ice.h"
-#include "SpellSystem/DamageTypes/BBotDmgType_Lightning.h"
-#include "SpellSystem/DamageTypes/BBotDmgType_Poison.h"
-#include "SpellSystem/DamageTypes/BBotDmgType_Physical.h"
+#include "SpellSystem/SpellPool.h"
+#include "SpellSystem/SpellProjectileManager.h"
+#include "SpellSystem/StatusEffectManager.h"
+#include "Online/BBotsGameState.h"
+#include "World/BBotsSpatialGrid.h"
+#include "Combat/BBotsCombatLog.h"
 
 
 #define SPELL_BAR_SIZE 6
@@ -40,6 +40,9 @@ ABBotCharacter::ABBotCharacter(const FObjectInitializer& ObjectInitializer)
 
   // The combat stance index
   stanceIndex = 0;
+
+  lastPredictionKey = 0;
+  localCastPredictionKey = INDEX_NONE;
 }
 
 // Called after all components have been initialized with default values
@@ -47,6 +50,9 @@ void ABBotCharacter::PostInitializeComponents()
 {
   Super::PostInitializeComponents();
 
+  // The instance starts with the class default attributes, all modifiers are folded on top of them
+  attributeStack.Init(characterConfig);
+
   if (HasAuthority())
   {
     // Sets max health/oil to the default values on the server
@@ -72,6 +78,33 @@ void ABBotCharacter::BeginPlay()
 
   // Is called to ensure that the default stance is triggered on spawn
   OnRep_StanceChanged();
+
+  if (HasAuthority() && GetSpatialGrid())
+  {
+    GetSpatialGrid()->RegisterCharacter(this);
+  }
+}
+
+void ABBotCharacter::EndPlay(const EEndPlayReason::Type EndPlayReason)
+{
+  if (HasAuthority() && GetSpatialGrid())
+  {
+    GetSpatialGrid()->UnregisterCharacter(this);
+  }
+
+  Super::EndPlay(EndPlayReason);
+}
+
+ABBotsSpatialGrid* ABBotCharacter::GetSpatialGrid() const
+{
+  ABattleBotsGameMode* GM = GetWorld() ? GetWorld()->GetAuthGameMode<ABattleBotsGameMode>() : nullptr;
+  return GM ? GM->GetSpatialGrid() : nullptr;
+}
+
+ABBotsCombatLog* ABBotCharacter::GetCombatLog() const
+{
+  ABattleBotsGameMode* GM = GetWorld() ? GetWorld()->GetAuthGameMode<ABattleBotsGameMode>() : nullptr;
+  return GM ? GM->GetCombatLog() : nullptr;
 }
 
 // Called every frame
@@ -136,6 +169,12 @@ bool ABBotCharacter::IsAlive() const
   return health > 0.f;
 }
 
+uint8 ABBotCharacter::GetTeamNum() const
+{
+  const ABBotsPlayerState* playerState = Cast<ABBotsPlayerState>(PlayerState);
+  return playerState ? playerState->GetTeamNum() : 255;
+}
+
 
 bool ABBotCharacter::CanRecieveDamage(AController* damageInstigator, const TSubclassOf<UDamageType> DamageType) const
 {
@@ -158,6 +197,9 @@ bool ABBotCharacter::ShouldTakeDamage(float Damage, FDamageEvent const& DamageEv
 // Take damage and handle death
 float ABBotCharacter::TakeDamage(float Damage, struct FDamageEvent const& DamageEvent, AController* EventInstigator, AActor* DamageCauser)
 {
+  BBOTS_SCOPE_CYCLE_COUNTER(TakeDamage);
+  BBOTS_INC_COUNTER(DamageEvents, 1);
+
   if (health <= 0.f) {
     return 0.f;
   }
@@ -169,6 +211,13 @@ float ABBotCharacter::TakeDamage(float Damage, struct FDamageEvent const& Damage
   if (DamageToApply > 0.f) {
     health -= DamageToApply;
 
+    if (GetCombatLog())
+    {
+      const EDamageElement::Type element = UBBotDmgType::GetDamageElement(DamageEvent.DamageTypeClass);
+      const float resist = element < EDamageElement::EMax ? attributeStack.GetResist(element) : 0.f;
+      GetCombatLog()->LogDamage(EventInstigator, this, element, DamageToApply, resist);
+    }
+
     GEngine->AddOnScreenDebugMessage(-1, 5.f, FColor::Green, TEXT("I took damage") + FString::FromInt(DamageToApply) + TEXT(" MY HEALTH: ") + FString::FromInt(GetCurrentHealth()));
 
     if (health <= 0) {
@@ -184,35 +233,21 @@ float ABBotCharacter::TakeDamage(float Damage, struct FDamageEvent const& Damage
 
 float ABBotCharacter::ProcessDamageTypes(float Damage, struct FDamageEvent const& DamageEvent)
 {
-  if (DamageEvent.DamageTypeClass == UBBotDmgType_Physical::StaticClass()) {
-    return ProcessFinalDmgPostResist(Damage, characterConfig.physicalResist);
-  }
-  else if (DamageEvent.DamageTypeClass == UBBotDmgType_Ice::StaticClass()) {
-    return ProcessFinalDmgPostResist(Damage, characterConfig.iceResist);
-  }
-  else if (DamageEvent.DamageTypeClass == UBBotDmgType_Lightning::StaticClass()) {
-    return ProcessFinalDmgPostResist(Damage, characterConfig.lightningResist);
-  }
-  else if (DamageEvent.DamageTypeClass == UBBotDmgType_Holy::StaticClass()) {
-    return ProcessFinalDmgPostResist(Damage, characterConfig.holyResist);
-  }
-  else if (DamageEvent.DamageTypeClass == UBBotDmgType_Poison::StaticClass()) {
-    return ProcessFinalDmgPostResist(Damage, characterConfig.poisonResist);
-  }
-  else if (DamageEvent.DamageTypeClass == UBBotDmgType_Fire::StaticClass()) {
-    return ProcessFinalDmgPostResist(Damage, characterConfig.fireResist);
-  }
-  else {
+  const EDamageElement::Type element = UBBotDmgType::GetDamageElement(DamageEvent.DamageTypeClass);
+
+  // Damage types without an element ignore resists
+  if (element == EDamageElement::EMax) {
     return Damage;
   }
+
+  return ProcessFinalDmgPostResist(Damage, attributeStack.GetResist(element));
 }
 
 
 float ABBotCharacter::ProcessFinalDmgPostResist(float initialDmg, float currentResist)
 {
   // If the resist is negative, then apply additional damage
-  float resistModifier = 1 - FMath::Clamp(currentResist, -1.f, 1.f);
-  return FMath::Abs(initialDmg * resistModifier);
+  return BBotCombat::ResolveResist(initialDmg, currentResist);
 }
 
 // Set the spell damage by x%
@@ -225,50 +260,28 @@ void ABBotCharacter::UpdateMovementSpeed()
 {
   if (HasAuthority())
   {
-    float speedMod = (1 + FMath::Clamp(GetMoveSpeedMod(), -1.f, 1.f));
-    float newSpeed = GetDefaultCharConfigValues().movementSpeed * speedMod;
-    characterConfig.movementSpeed = newSpeed;
-    GetCharacterMovement()->MaxWalkSpeed = FMath::Clamp(characterConfig.movementSpeed, minMovementSpeed, maxMovementSpeed);
+    // The movement component reads MaxWalkSpeed directly, so the movement field is folded right away
+    GetCharacterMovement()->MaxWalkSpeed = FMath::Clamp(attributeStack.GetMovementSpeed(), minMovementSpeed, maxMovementSpeed);
     GEngine->AddOnScreenDebugMessage(-1, 5.f, FColor::Green, TEXT("Max Walk speed is: ") + FString::FromInt(GetCharacterMovement()->MaxWalkSpeed));
   }
 }
 
-//@todo: might be better to move the slow timers to character instead of trying to manage multiple timers
-void ABBotCharacter::SlowPlayer(float slowMod, ASpellSystem* slowedBy)
+/* Stacking (only the strongest slow is active) and the slow duration are
+handled by the status effect manager */
+void ABBotCharacter::SlowPlayer(float slowMod)
 {
   if (HasAuthority())
   {
-	  // Only update if the new slow percentage is greater than the 1 in effect
-	  if (slowMod <= characterConfig.movSpeedMod_spells)
-	  {
-	    /* Update the current slowed by spell, since we just got hit by a more 
-	    powerful slow effect and must clear the timers of the previous spell.*/
-	    if (currentSlowSpell)
-	    {
-	      currentSlowSpell->ClearUniqueTimers();	      
-	    }
-	    
-	    currentSlowSpell = slowedBy;
-	
-	    // Only 1 spell slow is active at a time.
-		  characterConfig.movSpeedMod_spells = slowMod;
-	    UpdateMovementSpeed();
-	  }
-    else
-    {
-      /* There is already a more powerful spell in place. This prevents the 
-      weaker spell from clearing the slow effect of the stronger spell.*/
-      slowedBy->ClearUniqueTimers();
-    }
+    attributeStack.SetMovSpeedMod(EAttributeLayer::ESpell, slowMod);
+    UpdateMovementSpeed();
   }
 }
 
-
 void ABBotCharacter::ClearSlow()
 {
   if (HasAuthority())
   {
-    characterConfig.movSpeedMod_spells = 0;
+    attributeStack.SetMovSpeedMod(EAttributeLayer::ESpell, 0.f);
     UpdateMovementSpeed();
   }
 }
@@ -279,7 +292,7 @@ void ABBotCharacter::SetMobilityModifier_All(float newSpeedMod)
 {
   if (HasAuthority())
   {
-    characterConfig.movSpeedMod_stance = newSpeedMod;
+    attributeStack.SetMovSpeedMod(EAttributeLayer::EStance, newSpeedMod);
     UpdateMovementSpeed();
   }
 }
@@ -288,56 +301,32 @@ void ABBotCharacter::SetDefenseModifier_All(float newDefenseMod)
 {
   if (HasAuthority())
   {
-	  stanceResistMod = newDefenseMod;
-	  UpdatePlayerResist();
+	  // The new stance replaces the resists of the previous stance
+	  attributeStack.SetResistAll(EAttributeLayer::EStance, newDefenseMod);
 	  //Must be overriden with Super for classes with block rating
   }
 }
 
+void ABBotCharacter::ApplyStanceModifiers(const BBotCombat::FStanceModifiers& stanceModifiers)
+{
+  SetMobilityModifier_All(stanceModifiers.mobility);
+  SetDefenseModifier_All(stanceModifiers.defense);
+  SetDamageModifier_All(stanceModifiers.damage);
+}
+
 void ABBotCharacter::ReducePlayerResist(float reduceBy, const TSubclassOf<UDamageType> DamageType, bool bReduceAllResist /*= false*/)
 {
   if (HasAuthority())
   {
     if (bReduceAllResist)
+    {
       SetResistAll(reduceBy);
-
-    if (!bReduceAllResist)
+    }
+    else
     {
-	    if (DamageType == UBBotDmgType_Physical::StaticClass()) {
-	      spellBuffDebuffConfig.physicalResist += reduceBy;
-	    }
-	    else if (DamageType == UBBotDmgType_Ice::StaticClass()) {
-	      spellBuffDebuffConfig.iceResist += reduceBy;
-	    }
-	    else if (DamageType == UBBotDmgType_Lightning::StaticClass()) {
-	      spellBuffDebuffConfig.lightningResist += reduceBy;
-	    }
-	    else if (DamageType == UBBotDmgType_Holy::StaticClass()) {
-	      spellBuffDebuffConfig.holyResist += reduceBy;
-	    }
-	    else if (DamageType == UBBotDmgType_Poison::StaticClass()) {
-	      spellBuffDebuffConfig.poisonResist += reduceBy;
-	    }
-	    else if (DamageType == UBBotDmgType_Fire::StaticClass()) {
-	      spellBuffDebuffConfig.fireResist += reduceBy;
-	    }
+      const EDamageElement::Type element = UBBotDmgType::GetDamageElement(DamageType);
+      attributeStack.AddResist(EAttributeLayer::ESpell, element, reduceBy);
     }
-
-    // Update Character Resist
-    UpdatePlayerResist();
-  }
-}
-
-void ABBotCharacter::UpdatePlayerResist()
-{
-  if (HasAuthority())
-  {
-    characterConfig.fireResist = FMath::Clamp(GetDefaultCharConfigValues().fireResist + stanceResistMod + spellBuffDebuffConfig.fireResist, -1.f, 1.f);
-    characterConfig.iceResist = FMath::Clamp(GetDefaultCharConfigValues().iceResist + stanceResistMod + spellBuffDebuffConfig.iceResist, -1.f, 1.f);
-    characterConfig.lightningResist = FMath::Clamp(GetDefaultCharConfigValues().lightningResist + stanceResistMod + spellBuffDebuffConfig.lightningResist, -1.f, 1.f);
-    characterConfig.poisonResist = FMath::Clamp(GetDefaultCharConfigValues().poisonResist + stanceResistMod + spellBuffDebuffConfig.poisonResist, -1.f, 1.f);
-    characterConfig.physicalResist = FMath::Clamp(GetDefaultCharConfigValues().physicalResist + stanceResistMod + spellBuffDebuffConfig.physicalResist, -1.f, 1.f);
-    characterConfig.holyResist = FMath::Clamp(GetDefaultCharConfigValues().holyResist + stanceResistMod + spellBuffDebuffConfig.holyResist, -1.f, 1.f);
   }
 }
 
@@ -345,13 +334,7 @@ void ABBotCharacter::SetResistAll(float newResistanceMod)
 {
   if (HasAuthority())
   {
-    //@TODO: A bit repetitive, maybe create a stance struct
-    spellBuffDebuffConfig.fireResist += FMath::Clamp(newResistanceMod, -1.f, 1.f);
-    spellBuffDebuffConfig.iceResist += FMath::Clamp(newResistanceMod, -1.f, 1.f);
-    spellBuffDebuffConfig.lightningResist += FMath::Clamp(newResistanceMod, -1.f, 1.f);
-    spellBuffDebuffConfig.poisonResist += FMath::Clamp(newResistanceMod, -1.f, 1.f);
-    spellBuffDebuffConfig.physicalResist += FMath::Clamp(newResistanceMod, -1.f, 1.f);
-    spellBuffDebuffConfig.holyResist += FMath::Clamp(newResistanceMod, -1.f, 1.f);
+    attributeStack.AddResistAll(EAttributeLayer::ESpell, FMath::Clamp(newResistanceMod, -1.f, 1.f));
   }
 }
 
@@ -379,6 +362,24 @@ bool ABBotCharacter::Die(float killingDamage, FDamageEvent const& DamageEvent, A
   AController* const KilledPlayer = (Controller != NULL) ? Controller : Cast<AController>(GetOwner());
   GetWorld()->GetAuthGameMode<ABattleBotsGameMode>()->Killed(killer, KilledPlayer, this, DamageEvent.DamageTypeClass);
 
+  if (GetCombatLog())
+  {
+    GetCombatLog()->LogDeath(killer, this, killingDamage);
+  }
+
+  // Dead bodies are no longer spell targets
+  if (GetSpatialGrid())
+  {
+    GetSpatialGrid()->UnregisterCharacter(this);
+  }
+
+  // DoTs and slows end with their target
+  AStatusEffectManager* statusEffects = GetWorld()->GetAuthGameMode<ABattleBotsGameMode>()->GetStatusEffectManager();
+  if (statusEffects)
+  {
+    statusEffects->ClearEffects(this);
+  }
+
   OnDeath(killingDamage, DamageEvent, killer ? killer->GetPawn() : NULL, damageCauser);
 
   return true;
@@ -505,53 +506,211 @@ bool ABBotCharacter::CanCast(int32 spellIndex)
 // Casts the spell at index
 void ABBotCharacter::CastFromSpellBar(int32 index, const FVector& HitLocation)
 {
+  BBOTS_SCOPE_CYCLE_COUNTER(CastFromSpellBar);
+
   if (Role < ROLE_Authority) {
-    // We short-circuit if we can cast to prevent unnecessary calls
-    ServerCastFromSpellBar(index, HitLocation);
+    // Start the cast locally, we short-circuit if we can't cast to prevent unnecessary calls
+    const int32 predictionKey = PredictCast(index);
+    if (predictionKey != INDEX_NONE)
+    {
+      ServerCastFromSpellBar(index, HitLocation, predictionKey);
+    }
   }
   else {
-    if (!IsGlobalCDActive()) {
+    StartCast(index, HitLocation, INDEX_NONE);
+  }
+}
 
-      if (CanCast(index)) {
+bool ABBotCharacter::StartCast(int32 index, const FVector& HitLocation, int32 predictionKey)
+{
+  if (!IsGlobalCDActive() && CanCast(index)) {
 
-        // If the cast time is 0, change it to 0.01f to prevent an infinite wait with the timer
-        float castTime = spellBar[index]->GetCastTime() == 0.f ? 0.01f : spellBar[index]->GetCastTime();
+    // If the cast time is 0, change it to 0.01f to prevent an infinite wait with the timer
+    float castTime = spellBar[index]->GetCastTime() == 0.f ? 0.01f : spellBar[index]->GetCastTime();
 
-        bCanCastWhileMoving = spellBar[index]->CastableWhileMoving();
+    bCanCastWhileMoving = spellBar[index]->CastableWhileMoving();
 
-        // Set the spellSpawnLocation to prevent re-binding our FTimerDelegate
-        spellBar[index]->SetSpellSpawnLocation(HitLocation);
+    // Set the spellSpawnLocation to prevent re-binding our FTimerDelegate
+    spellBar[index]->SetSpellSpawnLocation(HitLocation);
 
-        // Attach a spellBar index payLoad to the delegate
-        castingSpellDelegate.BindUObject(this, &ABBotCharacter::CastFromSpellBar_Internal, (int32)index);
+    // Attach a spellBar index and prediction key payLoad to the delegate
+    castingSpellDelegate.BindUObject(this, &ABBotCharacter::CastFromSpellBar_Internal, (int32)index, predictionKey);
 
-        // Cast the spell after cast time in seconds
-        GetWorldTimerManager().SetTimer(castingSpellHandler, castingSpellDelegate, castTime, false);
+    // Cast the spell after cast time in seconds
+    GetWorldTimerManager().SetTimer(castingSpellHandler, castingSpellDelegate, castTime, false);
 
-        SetCurrentOil(-spellCost);
-        GCDHelper = GetWorld()->GetTimeSeconds() + characterConfig.globalCooldown;
-      }
+    SetCurrentOil(-spellCost);
+    GCDHelper = GetServerTime() + attributeStack.GetGlobalCooldown();
+
+    if (GetCombatLog())
+    {
+      GetCombatLog()->LogCastStart(this, spellBar[index]->GetClass(), index);
     }
+    return true;
   }
+
+  return false;
 }
 
-void ABBotCharacter::ServerCastFromSpellBar_Implementation(int32 index, const FVector& HitLocation)
+void ABBotCharacter::ServerCastFromSpellBar_Implementation(int32 index, const FVector& HitLocation, int32 predictionKey)
 {
-  CastFromSpellBar(index, HitLocation);
+  BBOTS_INC_COUNTER(RPCs, 1);
+  // The client already started the cast, tell it if it stands
+  if (StartCast(index, HitLocation, predictionKey))
+  {
+    ClientConfirmCast(predictionKey, GetCurrentOil());
+  }
+  else
+  {
+    ClientRejectCast(predictionKey, GetCurrentOil());
+  }
 }
 
-bool ABBotCharacter::ServerCastFromSpellBar_Validate(int32 index, const FVector& HitLocation)
+bool ABBotCharacter::ServerCastFromSpellBar_Validate(int32 index, const FVector& HitLocation, int32 predictionKey)
 {
   return true;
 }
 
-
-void ABBotCharacter::CastFromSpellBar_Internal(int32 index)
+void ABBotCharacter::CastFromSpellBar_Internal(int32 index, int32 predictionKey)
 {
   if (HasAuthority())
   {
-    spellBar[index]->SpawnSpell(spellBar_Internal[index]);
+    // The projectile carries the key, so the caster swaps its predicted projectile for it
+    spellBar[index]->SetCastPredictionKey(predictionKey);
+    // Only log casts that went out, the spell can still be on cool down
+    if (spellBar[index]->SpawnSpell(spellBar_Internal[index]) && GetCombatLog())
+    {
+      GetCombatLog()->LogCastFinish(this, spellBar[index]->GetClass(), index);
+    }
+  }
+}
+
+int32 ABBotCharacter::PredictCast(int32 index)
+{
+  if (IsGlobalCDActive() || !CanCast(index))
+  {
+    return INDEX_NONE;
   }
+
+  ASpellSystem* spell = spellBar[index];
+
+  // Keys only need to be unique among the casts in flight
+  lastPredictionKey = lastPredictionKey < MAX_int32 ? lastPredictionKey + 1 : 1;
+
+  FPredictedCast cast;
+  cast.predictionKey = lastPredictionKey;
+  cast.spellIndex = index;
+  cast.oilCost = spellCost;
+  // In server time, the client's own world clock started at a different time
+  cast.predictedGCD = BBotCombat::PredictCooldown(GCDHelper, GetServerTime(), characterConfig.globalCooldown);
+  // The replicated cool down corrects the prediction once the server casts the spell
+  cast.predictedSpellCD = spell->PredictCooldown();
+  pendingCasts.Add(cast);
+
+  // Same cast bar as the server, the cosmetic projectile is shown when it ends
+  float castTime = spell->GetCastTime() == 0.f ? 0.01f : spell->GetCastTime();
+  bCanCastWhileMoving = spell->CastableWhileMoving();
+  localCastPredictionKey = cast.predictionKey;
+
+  castingSpellDelegate.BindUObject(this, &ABBotCharacter::CastFromSpellBar_Predicted, (int32)index, cast.predictionKey);
+  GetWorldTimerManager().SetTimer(castingSpellHandler, castingSpellDelegate, castTime, false);
+
+  // The attribute layers only live on the server, the owner reads the replicated final attributes
+  oil = FMath::Max(oil - spellCost, 0.f);
+
+  return cast.predictionKey;
+}
+
+void ABBotCharacter::CastFromSpellBar_Predicted(int32 index, int32 predictionKey)
+{
+  localCastPredictionKey = INDEX_NONE;
+
+  ASpellSystem* spell = spellBar.IsValidIndex(index) ? spellBar[index] : nullptr;
+  ASpellProjectileManager* projectileManager = GetProjectileManager();
+
+  // Only batched projectiles have a cosmetic copy, other spells show up when the server spawns them
+  if (spell && projectileManager && spell->IsBatchedProjectile())
+  {
+    projectileManager->LaunchPredictedProjectile(spell, spell->GetSpellSpawnLocation(), GetActorRotation(), predictionKey);
+  }
+}
+
+void ABBotCharacter::ClientConfirmCast_Implementation(int32 predictionKey, float serverOil)
+{
+  BBOTS_INC_COUNTER(RPCs, 1);
+  FPredictedCast cast;
+  if (RemovePendingCast(predictionKey, cast))
+  {
+    // The server oil already includes this cast, keep the casts it has not answered yet
+    oil = FMath::Max(serverOil - GetPendingOilCost(), 0.f);
+  }
+}
+
+void ABBotCharacter::ClientRejectCast_Implementation(int32 predictionKey, float serverOil)
+{
+  BBOTS_INC_COUNTER(RPCs, 1);
+  FPredictedCast cast;
+  if (!RemovePendingCast(predictionKey, cast))
+  {
+    return;
+  }
+
+  oil = FMath::Max(serverOil - GetPendingOilCost(), 0.f);
+  BBotCombat::RollbackCooldown(GCDHelper, cast.predictedGCD);
+
+  if (spellBar.IsValidIndex(cast.spellIndex) && spellBar[cast.spellIndex])
+  {
+    spellBar[cast.spellIndex]->RollbackCooldown(cast.predictedSpellCD);
+  }
+
+  if (localCastPredictionKey == predictionKey)
+  {
+    // Still casting, stop the cast bar before it shows the projectile
+    GetWorldTimerManager().ClearTimer(castingSpellHandler);
+    localCastPredictionKey = INDEX_NONE;
+  }
+
+  ASpellProjectileManager* projectileManager = GetProjectileManager();
+  if (projectileManager)
+  {
+    projectileManager->CancelPredictedProjectile(predictionKey);
+  }
+}
+
+bool ABBotCharacter::RemovePendingCast(int32 predictionKey, FPredictedCast& outCast)
+{
+  for (int32 i = 0; i < pendingCasts.Num(); i++)
+  {
+    if (pendingCasts[i].predictionKey == predictionKey)
+    {
+      outCast = pendingCasts[i];
+      pendingCasts.RemoveAt(i);
+      return true;
+    }
+  }
+  return false;
+}
+
+float ABBotCharacter::GetPendingOilCost() const
+{
+  float pendingOil = 0.f;
+  for (const FPredictedCast& cast : pendingCasts)
+  {
+    pendingOil += cast.oilCost;
+  }
+  return pendingOil;
+}
+
+float ABBotCharacter::GetServerTime() const
+{
+  AGameState* const GS = GetWorld()->GameState;
+  return GS ? GS->GetServerWorldTimeSeconds() : GetWorld()->GetTimeSeconds();
+}
+
+ASpellProjectileManager* ABBotCharacter::GetProjectileManager() const
+{
+  ABBotsGameState* const MyGameState = GetWorld() ? Cast<ABBotsGameState>(GetWorld()->GameState) : nullptr;
+  return MyGameState ? MyGameState->projectileManager : nullptr;
 }
 
 
@@ -578,20 +737,27 @@ void ABBotCharacter::AddSpellToBar(TSubclassOf<ASpellSystem> newSpell)
 
       if (spellManager)
       {
-        /* Set the spellManagers' collision and hidden in game to true.
-        * Prevents them from getting GC'd */
-        spellManager->SetActorEnableCollision(false);
-        spellManager->SetActorHiddenInGame(true);
+        /* Hides the spellManager and disables its collision, prevents it from getting GC'd.
+        * The manager only replicates to us, and stays dormant between casts. */
+        spellManager->InitSpellBarManager();
         // Add the spellManager to the spellBar
         spellBar.Add(spellManager);
         GEngine->AddOnScreenDebugMessage(-1, 2.f, FColor::Red, TEXT("Adding spell"));
       }
+
+      // Spawn the spells ahead of time to avoid spawn hitches mid match
+      ABattleBotsGameMode* GM = GetWorld()->GetAuthGameMode<ABattleBotsGameMode>();
+      if (GM && GM->GetSpellPool())
+      {
+        GM->GetSpellPool()->PrewarmSpell(newSpell);
+      }
     }
   }
 }
 
 void ABBotCharacter::ServerAddSpellToBar_Implementation(TSubclassOf<ASpellSystem> newSpell)
 {
+  BBOTS_INC_COUNTER(RPCs, 1);
   AddSpellToBar(newSpell);
 }
 
@@ -638,6 +804,7 @@ void ABBotCharacter::ChangeFacingRotation(FRotator newRotation)
 
 void ABBotCharacter::ServerChangeFacingRotation_Implementation(FRotator newRotation)
 {
+  BBOTS_INC_COUNTER(RPCs, 1);
   ChangeFacingRotation(newRotation);
 }
 
@@ -691,6 +858,7 @@ void ABBotCharacter::OnRep_StanceChanged()
 
 void ABBotCharacter::ServerOnRep_StanceChanged_Implementation()
 {
+  BBOTS_INC_COUNTER(RPCs, 1);
   OnRep_StanceChanged();
 }
 
@@ -751,18 +919,19 @@ void ABBotCharacter::SwitchCombatStanceHelper(bool bScrolled)
   {
     float currentTime = GetWorld()->GetTimeSeconds();
     // If the switchStance cd is up, call SwitchCombatStance
-    if (switchStanceCDHelper < currentTime) {
+    if (BBotCombat::IsCooldownReady(switchStanceCDHelper, currentTime)) {
       // Setting this to true increments the stance index
       bScrolledUp = bScrolled;
       SwitchCombatStance();
       // Reapply cooldown after switching stance
-      switchStanceCDHelper = currentTime + switchStanceCoolDown;
+      BBotCombat::TriggerCooldown(switchStanceCDHelper, currentTime, switchStanceCoolDown);
     }
   }
 }
 
 void ABBotCharacter::ServerSwitchCombatStanceHelper_Implementation(bool bScrolled)
 {
+  BBOTS_INC_COUNTER(RPCs, 1);
   SwitchCombatStanceHelper(bScrolled);
 }
 
@@ -781,6 +950,11 @@ void ABBotCharacter::SwitchCombatStance()
     if (combatStances.IsValidIndex(roundRobinIndex)) {
       //currentStance = combatStances[roundRobinIndex];
       SetCurrentStance(combatStances[roundRobinIndex]);
+
+      if (GetCombatLog())
+      {
+        GetCombatLog()->LogStanceSwitch(this, (uint8)currentStance);
+      }
     }
     printCurrentStance();
   }
@@ -835,6 +1009,7 @@ void ABBotCharacter::EnableSpellCasting(bool bCanCast)
 
 void ABBotCharacter::ServerEnableSpellCasting_Implementation(bool bCanCast)
 {
+  BBOTS_INC_COUNTER(RPCs, 1);
   this->bCastingEnabled = bCanCast;
 }
 
@@ -845,6 +1020,7 @@ bool ABBotCharacter::ServerEnableSpellCasting_Validate(bool bCanCast)
 
 void ABBotCharacter::ServerSetIsDying_Implementation(bool bDying)
 {
+  BBOTS_INC_COUNTER(RPCs, 1);
   bIsDying = bDying;
 }
 
@@ -853,6 +1029,39 @@ bool ABBotCharacter::ServerSetIsDying_Validate(bool bDying)
   return true;
 }
 
+void ABBotCharacter::PreReplication(IRepChangedPropertyTracker& ChangedPropertyTracker)
+{
+  Super::PreReplication(ChangedPropertyTracker);
+
+  // Only copy the final attributes when a layer changed since the last net update
+  if (attributeStack.NeedsFlush())
+  {
+    characterConfig = attributeStack.GetFinalAttributes();
+    replicatedAttributes.SetFromAttributes(characterConfig);
+    attributeStack.MarkFlushed();
+  }
+
+  // Changes below the fixed point precision do not mark the properties dirty
+  replicatedHealth.Set(health);
+  replicatedOil.Set(oil);
+}
+
+void ABBotCharacter::OnRep_ReplicatedAttributes()
+{
+  replicatedAttributes.ApplyTo(characterConfig);
+}
+
+void ABBotCharacter::OnRep_Health()
+{
+  health = replicatedHealth.Get();
+}
+
+void ABBotCharacter::OnRep_Oil()
+{
+  // Keep the oil of the predicted casts the server has not answered yet
+  oil = FMath::Max(replicatedOil.Get() - GetPendingOilCost(), 0.f);
+}
+
 void ABBotCharacter::GetLifetimeReplicatedProps(TArray<FLifetimeProperty>& OutLifetimeProps) const
 {
   Super::GetLifetimeReplicatedProps(OutLifetimeProps);
@@ -869,11 +1078,11 @@ void ABBotCharacter::GetLifetimeReplicatedProps(TArray<FLifetimeProperty>& OutLi
   DOREPLIFETIME_CONDITION(ABBotCharacter, spellBar_Internal, COND_OwnerOnly);
   DOREPLIFETIME_CONDITION(ABBotCharacter, spellCost, COND_OwnerOnly);
   DOREPLIFETIME_CONDITION(ABBotCharacter, bCastingEnabled, COND_OwnerOnly);
-  DOREPLIFETIME_CONDITION(ABBotCharacter, characterConfig, COND_OwnerOnly);
+  DOREPLIFETIME_CONDITION(ABBotCharacter, replicatedAttributes, COND_OwnerOnly);
 
   // Replicate to every client, no special condition required
-  DOREPLIFETIME(ABBotCharacter, health);
-  DOREPLIFETIME(ABBotCharacter, oil);
+  DOREPLIFETIME(ABBotCharacter, replicatedHealth);
+  DOREPLIFETIME(ABBotCharacter, replicatedOil);
   DOREPLIFETIME(ABBotCharacter, bIsStunned);
   DOREPLIFETIME(ABBotCharacter, currentStance);
   DOREPLIFETIME(ABBotCharacter, combatStances);
@@ -4,9 +4,11 @@
 
 #include "BattleBotsCharacter.h"
 #include "BattleBotsPlayerController.h"
+#include "Character/BBotAttributeStack.h"
 #include "BBotCharacter.generated.h"
 
 class ASpellSystem;
+class ASpellProjectileManager;
 
 //DECLARE_DELEGATE(FTimerDelegate)
 
@@ -17,46 +19,6 @@ enum class EStanceType :uint8{
   ELightning    UMETA(DisplayName = "Lightning"),
 };
 
-USTRUCT()
-struct FCharacterAttributes{
-	GENERATED_USTRUCT_BODY()
-
-	UPROPERTY(EditDefaultsOnly, Category = "Movement")
-	float movementSpeed;
-  UPROPERTY(EditDefaultsOnly, Category = "Movement")
-  float movSpeedMod_spells;
-  UPROPERTY(EditDefaultsOnly, Category = "Movement")
-  float movSpeedMod_stance;
-  UPROPERTY(EditDefaultsOnly, Category = "Defenses")
-	float blockRate;
-  UPROPERTY(EditDefaultsOnly, Category = "Defenses")
-	float fireResist;
-  UPROPERTY(EditDefaultsOnly, Category = "Defenses")
-	float iceResist;
-  UPROPERTY(EditDefaultsOnly, Category = "Defenses")
-	float lightningResist;
-  UPROPERTY(EditDefaultsOnly, Category = "Defenses")
-  float holyResist;
-  UPROPERTY(EditDefaultsOnly, Category = "Defenses")
-	float poisonResist;
-	UPROPERTY(EditDefaultsOnly, Category = "Defenses")
-	float physicalResist;
-  UPROPERTY(EditDefaultsOnly, Category = "BonusDamage")
-  float bonusFireDmg;
-  UPROPERTY(EditDefaultsOnly, Category = "BonusDamage")
-  float bonusIceDmg;
-  UPROPERTY(EditDefaultsOnly, Category = "BonusDamage")
-  float bonusLightningDmg;
-  UPROPERTY(EditDefaultsOnly, Category = "BonusDamage")
-  float bonusHolyDmg;
-  UPROPERTY(EditDefaultsOnly, Category = "BonusDamage")
-  float bonusPoisonDmg;
-  UPROPERTY(EditDefaultsOnly, Category = "BonusDamage")
-  float bonusPhysicalDmg;
-  UPROPERTY(EditDefaultsOnly, Category = "SpellCasting")
-  float globalCooldown;
-};
-
 UCLASS(Blueprintable)
 class BATTLEBOTS_API ABBotCharacter : public ABattleBotsCharacter
 {
@@ -72,6 +34,9 @@ public:
 	// Called when the game starts or when spawned
 	virtual void BeginPlay() override;
 
+  // Called when the character is destroyed or the level is unloaded
+  virtual void EndPlay(const EEndPlayReason::Type EndPlayReason) override;
+
 	// Called every frame
 	virtual void Tick(float DeltaSeconds) override;
 
@@ -95,6 +60,12 @@ private:
   // A reference to the player controller
   ABattleBotsPlayerController* playerController;
 
+  // Returns the world spatial grid, only valid on the server
+  class ABBotsSpatialGrid* GetSpatialGrid() const;
+
+  // Returns the match combat log, only valid on the server
+  class ABBotsCombatLog* GetCombatLog() const;
+
   // Called to bind functionality to input
   virtual void SetupPlayerInputComponent(class UInputComponent* InputComponent) override;
 
@@ -157,17 +128,17 @@ public:
   UFUNCTION(BlueprintCallable, Category = "PlayerCondition")
   bool IsAlive() const;
 
+  // Returns the team of the player state, 255 if the character has none
+  uint8 GetTeamNum() const;
+
   // Slow or speed up the player by x%
-  void SlowPlayer(float slowMod, ASpellSystem* slowedBy);
+  void SlowPlayer(float slowMod);
   // Clears the current slow effect
   void ClearSlow();
 
   // Reduce player resistance. Used for spells/items buff/debuffs.
   void ReducePlayerResist(float reduceBy, const TSubclassOf<UDamageType> DamageType, bool bReduceAllResist = false);
 
-  // Updates the total player resist based on default values, spell, and item buff/debuffs.
-  void UpdatePlayerResist();
-
   // Updates movement speed based on movSpeedMod_spells/stance
   void UpdateMovementSpeed();
 
@@ -180,39 +151,54 @@ public:
   // Sets the appropriate modifiers for block rate and resistances
   virtual void SetDefenseModifier_All(float newDefenseMod);
 
+  // Replaces the stance layer with a row of the combat core stance table
+  void ApplyStanceModifiers(const BBotCombat::FStanceModifiers& stanceModifiers);
+
   // Sets the resist all by x%
   void SetResistAll(float newResistanceMod);
 
-  // Returns the total movement speed modifiers
-  FORCEINLINE float GetMoveSpeedMod() const { return characterConfig.movSpeedMod_spells + characterConfig.movSpeedMod_stance; }
-  // Returns the default class values
-  FORCEINLINE FCharacterAttributes GetDefaultCharConfigValues() const { return GetClass()->GetDefaultObject<ABBotCharacter>()->characterConfig; }
-
-  // Returns the bonus fire damage from items/buffs
-  FORCEINLINE float GetDamageModifier_Fire() const { return FMath::Clamp(characterConfig.bonusFireDmg, -1.f, 1.f); }
-  // Returns the bonus lightning damage from items/buffs
-  FORCEINLINE float GetDamageModifier_Lightning() const { return FMath::Clamp(characterConfig.bonusLightningDmg, -1.f, 1.f); }
-  // Returns the bonus ice damage from items/buffs
-  FORCEINLINE float GetDamageModifier_Ice() const { return FMath::Clamp(characterConfig.bonusIceDmg, -1.f, 1.f); }
-  // Returns the bonus holy damage from items/buffs
-  FORCEINLINE float GetDamageModifier_Holy() const { return FMath::Clamp(characterConfig.bonusHolyDmg, -1.f, 1.f); }
-  // Returns the bonus poison damage from items/buffs
-  FORCEINLINE float GetDamageModifier_Poison() const { return FMath::Clamp(characterConfig.bonusPoisonDmg, -1.f, 1.f); }
-  // Returns the bonus Physical damage from items/buffs
-  FORCEINLINE float GetDamageModifier_Physical() const { return FMath::Clamp(characterConfig.bonusPhysicalDmg, -1.f, 1.f); }
+  // Returns the bonus damage of the element from items/buffs
+  FORCEINLINE float GetDamageModifier(EDamageElement::Type element) const { return element < EDamageElement::EMax ? attributeStack.GetBonusDamage(element) : 0.f; }
+
+  // Flushes the folded attributes, health and oil into their quantized replicated copies
+  virtual void PreReplication(IRepChangedPropertyTracker& ChangedPropertyTracker) override;
 
 protected:
-  // An object that holds the character configurations - Default Values + Stance Changes
-  UPROPERTY(Replicated, EditDefaultsOnly, Category = "Config")
+  /* The character configurations. Holds the default values on the class defaults,
+  and the final values (Default Values + Stance/Spell/Item Changes) on the instance.
+  The owner receives them through replicatedAttributes. */
+  UPROPERTY(EditDefaultsOnly, Category = "Config")
   FCharacterAttributes characterConfig;
 
-  // The character's health, variables within UStructs cannot be replicated
-  UPROPERTY(EditDefaultsOnly, Transient, Category = "Health", Replicated)
+  // Folds the stance, spell and item modifiers on top of the default values
+  FCharacterAttributeStack attributeStack;
+
+  // The quantized final attributes, only the fields that changed are sent to the owner
+  UPROPERTY(Transient, ReplicatedUsing = OnRep_ReplicatedAttributes)
+  FReplicatedAttributes replicatedAttributes;
+
+  // Copies the received attributes into characterConfig
+  UFUNCTION()
+  void OnRep_ReplicatedAttributes();
+
+  // The character's health
+  UPROPERTY(EditDefaultsOnly, Transient, Category = "Health")
   float health;
   // The character's main resource, used to cast spells
-  UPROPERTY(EditDefaultsOnly, Transient, Category = "Attributes", Replicated)
+  UPROPERTY(EditDefaultsOnly, Transient, Category = "Attributes")
   float oil;
 
+  // Health and oil replicate to everyone as fixed point
+  UPROPERTY(Transient, ReplicatedUsing = OnRep_Health)
+  FBBotFixedPoint replicatedHealth;
+  UPROPERTY(Transient, ReplicatedUsing = OnRep_Oil)
+  FBBotFixedPoint replicatedOil;
+
+  UFUNCTION()
+  void OnRep_Health();
+  UFUNCTION()
+  void OnRep_Oil();
+
   // The maximum value for health
   UPROPERTY(Replicated)
   float maxHealth;
@@ -228,17 +214,6 @@ protected:
   // The maximum movement speed from spells/stance switches
   UPROPERTY(EditDefaultsOnly, Transient, Category = "Attributes")
   float maxMovementSpeed;
-private:
-  // The all resist mod from switch stance, 60% to all, -20% etc.
-  float stanceResistMod;
-
-  // Handles spell buffs and debuffs. Used for stance switches preventing certain edge cases.
-  UPROPERTY()
-  FCharacterAttributes spellBuffDebuffConfig;
-
-  // The last actor to slow me, used to clear current slow timers.
-  UPROPERTY()
-  ASpellSystem* currentSlowSpell;
 
   /************************************************************************/
   /* Damage and Death                                                     */
@@ -300,14 +275,24 @@ public:
   UPROPERTY(Replicated, VisibleAnywhere, BlueprintReadWrite, Category = "SpellBar")
   TArray<ASpellSystem*> spellBar;
 
-  // Casts the spell at index
+  // Casts the spell at index. Owning clients predict the cast, the server confirms or rolls it back.
   UFUNCTION(BlueprintCallable, Category = "SpellBar")
   void CastFromSpellBar(int32 index, const FVector& HitLocation);
 
   UFUNCTION(Reliable, Server, WithValidation)
-  void ServerCastFromSpellBar(int32 index, const FVector& HitLocation);
-  virtual void ServerCastFromSpellBar_Implementation(int32 index, const FVector& HitLocation);
-  virtual bool ServerCastFromSpellBar_Validate(int32 index, const FVector& HitLocation);
+  void ServerCastFromSpellBar(int32 index, const FVector& HitLocation, int32 predictionKey);
+  virtual void ServerCastFromSpellBar_Implementation(int32 index, const FVector& HitLocation, int32 predictionKey);
+  virtual bool ServerCastFromSpellBar_Validate(int32 index, const FVector& HitLocation, int32 predictionKey);
+
+  // The server started the predicted cast, serverOil is the oil after the spell cost
+  UFUNCTION(Reliable, Client)
+  void ClientConfirmCast(int32 predictionKey, float serverOil);
+  virtual void ClientConfirmCast_Implementation(int32 predictionKey, float serverOil);
+
+  // The server could not start the predicted cast, rolls back the oil, cool downs, cast bar and projectile
+  UFUNCTION(Reliable, Client)
+  void ClientRejectCast(int32 predictionKey, float serverOil);
+  virtual void ClientRejectCast_Implementation(int32 predictionKey, float serverOil);
 
   // Adds a spell to our Spell Bar
   UFUNCTION(BlueprintCallable, Category = "SpellBar")
@@ -326,7 +311,10 @@ public:
   void EnableSpellCasting(bool bCanCast);
 
   FORCEINLINE bool IsSpellCastingEnabled() const { return bCastingEnabled; }
-  FORCEINLINE bool IsGlobalCDActive() const { return GCDHelper > GetWorld()->GetTimeSeconds(); }
+  FORCEINLINE bool IsGlobalCDActive() const { return GCDHelper > GetServerTime(); }
+
+  // Returns the server world time, the clock the replicated cool downs are set in, on the server and the clients
+  float GetServerTime() const;
 protected:
   // Array of spell classes in Spell-Bar, Required by GetClass()
   UPROPERTY(Replicated)
@@ -360,7 +348,45 @@ private:
   UPROPERTY(Replicated)
   float GCDHelper;
   
-  void CastFromSpellBar_Internal(int32 index);
+  // Starts the cast on the server, returns false if the spell cannot be cast
+  bool StartCast(int32 index, const FVector& HitLocation, int32 predictionKey);
+
+  void CastFromSpellBar_Internal(int32 index, int32 predictionKey);
+
+  // A cast the owning client started ahead of the server
+  struct FPredictedCast
+  {
+    int32 predictionKey;
+    int32 spellIndex;
+    float oilCost;
+    // Rolled back if the server rejects the cast
+    BBotCombat::FPredictedCooldown predictedGCD;
+    BBotCombat::FPredictedCooldown predictedSpellCD;
+  };
+
+  // Predicted casts waiting for the server result
+  TArray<FPredictedCast> pendingCasts;
+
+  // The last prediction key handed out by this client
+  int32 lastPredictionKey;
+
+  // The prediction key of the cast bar in progress on the owning client
+  int32 localCastPredictionKey;
+
+  // Starts the cast bar, oil cost and cool downs locally. Returns the prediction key, INDEX_NONE if the spell cannot be cast.
+  int32 PredictCast(int32 index);
+
+  // Called when the predicted cast time is over, shows the cosmetic projectile
+  void CastFromSpellBar_Predicted(int32 index, int32 predictionKey);
+
+  // Removes the pending cast with predictionKey, returns false if the cast is not pending
+  bool RemovePendingCast(int32 predictionKey, FPredictedCast& outCast);
+
+  // Returns the oil deducted by the predicted casts the server has not answered yet
+  float GetPendingOilCost() const;
+
+  // Returns the projectile manager, through the game state so it works on clients
+  ASpellProjectileManager* GetProjectileManager() const;
   /************************************************************************/
   /* Character State                                                      */
   /************************************************************************/
@@ -43,7 +43,6 @@ void ABBotSorcerer::OnRep_StanceChanged()
   }
   else
   {
-    // @todo:Implement stance table
     EStanceType myStance = GetCurrentStance();
 
     switch (myStance) {
@@ -67,14 +66,9 @@ void ABBotSorcerer::SetToMobilityStance()
 {
   if (Role == ROLE_Authority)
   {
-    // Increase Speed by 60%
-    SetMobilityModifier_All(0.6f);
-    // Reduce Resists and Block by 20%
-    SetDefenseModifier_All(-0.2f);
-    // Reduce Damage by 20%
-    SetDamageModifier_All(-0.2f);
-
-    GEngine->AddOnScreenDebugMessage(-1, 4.f, FColor::Green, TEXT("LIGHTNING!! - Mobility Stance- ") + FString::FromInt(100 * characterConfig.bonusFireDmg));
+    ApplyStanceModifiers(BBotCombat::GetStanceModifiers(BBotCombat::EStanceRole::EMobility));
+
+    GEngine->AddOnScreenDebugMessage(-1, 4.f, FColor::Green, TEXT("LIGHTNING!! - Mobility Stance- ") + FString::FromInt(100 * GetDamageModifier(EDamageElement::EFire)));
   }
 }
 
@@ -82,14 +76,9 @@ void ABBotSorcerer::SetToDamageStance()
 {
   if (Role == ROLE_Authority)
   {
-    // Reduce Speed by 20%
-    SetMobilityModifier_All(-0.2f);
-    // Reduce Resists and Block by 20%
-    SetDefenseModifier_All(-0.2f);
-    // Increase Damage by 60%
-    SetDamageModifier_All(0.6f);
-
-    GEngine->AddOnScreenDebugMessage(-1, 4.f, FColor::Green, TEXT("FIRE!!!!!! - Damage Stance- ") + FString::FromInt(100 * characterConfig.bonusFireDmg));
+    ApplyStanceModifiers(BBotCombat::GetStanceModifiers(BBotCombat::EStanceRole::EDamage));
+
+    GEngine->AddOnScreenDebugMessage(-1, 4.f, FColor::Green, TEXT("FIRE!!!!!! - Damage Stance- ") + FString::FromInt(100 * GetDamageModifier(EDamageElement::EFire)));
   }
 }
 
@@ -97,24 +86,22 @@ void ABBotSorcerer::SetToDefenseStance()
 {
   if (Role == ROLE_Authority)
   {
-    // Reduce Speed by 20%
-    SetMobilityModifier_All(-0.2f);
-    // Increase Resists and Block by 60%
-    SetDefenseModifier_All(0.6f);
-    // Reduce Damage by 20%
-    SetDamageModifier_All(-0.2f);
-
-    GEngine->AddOnScreenDebugMessage(-1, 4.f, FColor::Green, TEXT("FROST!! - Ice Stance- ") + FString::FromInt(100 * characterConfig.bonusFireDmg));
+    ApplyStanceModifiers(BBotCombat::GetStanceModifiers(BBotCombat::EStanceRole::EDefense));
+
+    GEngine->AddOnScreenDebugMessage(-1, 4.f, FColor::Green, TEXT("FROST!! - Ice Stance- ") + FString::FromInt(100 * GetDamageModifier(EDamageElement::EFire)));
   }
 }
 
-// NOT CHANGING VALUE AFTER INITIAL CALL
 void ABBotSorcerer::SetDamageModifier_All(float newDmgMod)
 {
   if (HasAuthority()) {
-    // Resets current mod, need an item config struct
-    characterConfig.bonusFireDmg = FMath::Clamp(GetDefaultCharConfigValues().fireResist + newDmgMod, -1.f, 1.f);
-    characterConfig.bonusLightningDmg = FMath::Clamp(GetDefaultCharConfigValues().bonusLightningDmg + newDmgMod, -1.f, 1.f);
-    characterConfig.bonusIceDmg = FMath::Clamp(GetDefaultCharConfigValues().bonusIceDmg + newDmgMod, -1.f, 1.f);
+    // The sorcerer stances only modify the elements it can cast
+    static const EDamageElement::Type sorcererElements[] = { EDamageElement::EFire, EDamageElement::ELightning, EDamageElement::EIce };
+
+    // The new stance replaces the damage mod of the previous stance
+    for (EDamageElement::Type element : sorcererElements)
+    {
+      attributeStack.SetBonusDamage(EAttributeLayer::EStance, element, newDmgMod);
+    }
   }
 }
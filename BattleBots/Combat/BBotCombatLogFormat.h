@@ -0,0 +1,77 @@
+// Copyright 2015 VMR Games, Inc. All Rights Reserved.
+
+#pragma once
+
+#include <cstdint>
+
+/**
+ * The on disk format of the server combat log, shared by the writer
+ * (ABBotsCombatLog) and Tools/CombatLogReader. A file is one
+ * FCombatLogFileHeader followed by fixed size FCombatLogEvent records in
+ * little endian, so a reader can map the file and index it directly.
+ * Plain C++ only, like BBotCombatMath.h.
+ */
+namespace BBotCombatLog
+{
+  // "BBCL"
+  static const uint32_t FileMagic = 0x4C434242;
+  static const uint32_t FileVersion = 2;
+
+  // Actor id of events without a source or target
+  static const uint32_t NoActor = 0;
+  /* Set on the ids of actors without a player, which are object ids.
+  / Player ids and object ids come from different counters and would collide otherwise. */
+  static const uint32_t ObjectIdFlag = 0x80000000u;
+  // Element of events without an element, same as EDamageElement::EMax
+  static const uint8_t NoElement = 6;
+
+  enum class EEventType : uint8_t
+  {
+    // spellId, extra = spell bar index
+    ECastStart,
+    // spellId, extra = spell bar index
+    ECastFinish,
+    // spellId, extra = projectile id
+    EProjectileSpawn,
+    // spellId, target hit by the spell
+    EHit,
+    // element, value = damage applied, resist = resist of the target
+    EDamage,
+    // element, value = damage per tick before resists, extra = status effect type
+    EDotTick,
+    // source = killer, value = killing damage
+    EDeath,
+    // extra = new stance
+    EStanceSwitch,
+    EMax,
+  };
+
+  struct FCombatLogFileHeader
+  {
+    uint32_t magic;
+    uint32_t version;
+    uint32_t eventSize;
+    uint32_t reserved;
+    // Unix time the match log was opened at
+    int64_t startTime;
+  };
+
+  // 32 bytes, ids are player ids or flagged object ids and spell ids are the CRC32 of the spell class name
+  struct FCombatLogEvent
+  {
+    // Milliseconds of world time
+    uint32_t timeMs;
+    EEventType type;
+    uint8_t element;
+    uint16_t flags;
+    uint32_t sourceId;
+    uint32_t targetId;
+    uint32_t spellId;
+    float value;
+    float resist;
+    uint32_t extra;
+  };
+
+  static_assert(sizeof(FCombatLogFileHeader) == 24, "The combat log header layout is part of the file format");
+  static_assert(sizeof(FCombatLogEvent) == 32, "The combat log event layout is part of the file format");
+}
@@ -0,0 +1,251 @@
+// Copyright 2015 VMR Games, Inc. All Rights Reserved.
+
+#pragma once
+
+#include <cmath>
+#include <cstdint>
+#include <cstring>
+
+/**
+ * BBotCombat holds the combat rules shared by the characters, the spells and
+ * the status effect manager: resist and damage modifier resolution, attribute
+ * layer folds, the stance modifier table, DoT math and cooldown bookkeeping.
+ * It is plain C++ on purpose, nothing in here may include engine headers, so
+ * the rules can be built and measured outside of a UWorld (see Tools/CombatBench).
+ */
+namespace BBotCombat
+{
+  // Must match EDamageElement::EMax, checked by a static_assert in BBotAttributeStack.cpp
+  static const int32_t ElementCount = 6;
+
+  inline float Clamp(float value, float minValue, float maxValue)
+  {
+    return value < minValue ? minValue : (value > maxValue ? maxValue : value);
+  }
+
+  inline float Max(float a, float b)
+  {
+    return a > b ? a : b;
+  }
+
+  /* Damage resolution */
+
+  // Resists are clamped to [-1, 1], a negative resist deals additional damage
+  inline float ResolveResist(float damage, float resist)
+  {
+    return std::fabs(damage * (1.f - Clamp(resist, -1.f, 1.f)));
+  }
+
+  // Bonus damage of the attacker, already clamped by the attribute fold
+  inline float ApplyDamageModifier(float damage, float bonusDamage)
+  {
+    return std::fabs(damage * (1.f + bonusDamage));
+  }
+
+  // Full hit: attacker bonus first, then the defender resist
+  inline float ResolveDamage(float baseDamage, float bonusDamage, float resist)
+  {
+    return ResolveResist(ApplyDamageModifier(baseDamage, bonusDamage), resist);
+  }
+
+  /* Attribute folds */
+
+  // The additive modifiers of a single attribute source
+  struct FAttributeLayer
+  {
+    float movSpeedMod;
+    float blockRate;
+    float globalCooldown;
+    float resists[ElementCount];
+    float bonusDamage[ElementCount];
+
+    FAttributeLayer() { std::memset(this, 0, sizeof(FAttributeLayer)); }
+  };
+
+  // Movement mods of all layers are summed and clamped to [-1, 1] before scaling the base speed
+  inline float FoldMovementSpeed(float baseSpeed, const FAttributeLayer* layers, int32_t layerCount)
+  {
+    float totalMod = 0.f;
+    for (int32_t layer = 0; layer < layerCount; layer++)
+    {
+      totalMod += layers[layer].movSpeedMod;
+    }
+    return baseSpeed * (1.f + Clamp(totalMod, -1.f, 1.f));
+  }
+
+  inline float FoldBlockRate(float baseBlockRate, const FAttributeLayer* layers, int32_t layerCount)
+  {
+    float blockRate = baseBlockRate;
+    for (int32_t layer = 0; layer < layerCount; layer++)
+    {
+      blockRate += layers[layer].blockRate;
+    }
+    return Clamp(blockRate, 0.f, 1.f);
+  }
+
+  inline float FoldGlobalCooldown(float baseCooldown, const FAttributeLayer* layers, int32_t layerCount)
+  {
+    float globalCooldown = baseCooldown;
+    for (int32_t layer = 0; layer < layerCount; layer++)
+    {
+      globalCooldown += layers[layer].globalCooldown;
+    }
+    return Max(globalCooldown, 0.f);
+  }
+
+  inline float FoldResist(float baseResist, const FAttributeLayer* layers, int32_t layerCount, int32_t element)
+  {
+    float resist = baseResist;
+    for (int32_t layer = 0; layer < layerCount; layer++)
+    {
+      resist += layers[layer].resists[element];
+    }
+    return Clamp(resist, -1.f, 1.f);
+  }
+
+  inline float FoldBonusDamage(float baseBonusDamage, const FAttributeLayer* layers, int32_t layerCount, int32_t element)
+  {
+    float bonusDamage = baseBonusDamage;
+    for (int32_t layer = 0; layer < layerCount; layer++)
+    {
+      bonusDamage += layers[layer].bonusDamage[element];
+    }
+    return Clamp(bonusDamage, -1.f, 1.f);
+  }
+
+  /* Stances */
+
+  // What a stance is built for, each role has one row in the stance table
+  enum class EStanceRole : uint8_t
+  {
+    EDamage,
+    EDefense,
+    EMobility,
+    EMax,
+  };
+
+  // The stance layer modifiers, they replace the ones of the previous stance
+  struct FStanceModifiers
+  {
+    float mobility;
+    // Applied to all resists and the block rate
+    float defense;
+    float damage;
+  };
+
+  inline const FStanceModifiers& GetStanceModifiers(EStanceRole role)
+  {
+    // +60% to the main attribute of the stance, -20% to the two others
+    static const FStanceModifiers stanceTable[(int32_t)EStanceRole::EMax] =
+    {
+      { -0.2f, -0.2f, 0.6f },   // EDamage
+      { -0.2f, 0.6f, -0.2f },   // EDefense
+      { 0.6f, -0.2f, -0.2f },   // EMobility
+    };
+    return stanceTable[(int32_t)role];
+  }
+
+  /* Damage over time */
+
+  // Scales the modified damage of a DoT tick, the scale is a 0-1 fraction
+  inline float ScaleDotDamage(float modifiedDamage, float damageScale)
+  {
+    return Clamp(damageScale, 0.f, 1.f) * modifiedDamage;
+  }
+
+  // The raw spell damage is spread over the duration, modified like a direct hit, then scaled
+  inline float GetDotDamagePerTick(float spellDamage, float duration, float damageScale, float bonusDamage)
+  {
+    if (duration <= 0.f)
+    {
+      return 0.f;
+    }
+    return ScaleDotDamage(ApplyDamageModifier(spellDamage / duration, bonusDamage), damageScale);
+  }
+
+  // Half a tick offset prevents edge cases with odd tick durations
+  inline float GetDotFirstTickDelay(float tickInterval)
+  {
+    return tickInterval / 2;
+  }
+
+  // The timing of a single DoT, advanced by the status effect manager
+  struct FDotTimer
+  {
+    float tickInterval;
+    float nextTickTime;
+    float endTime;
+
+    FDotTimer() : tickInterval(0.f), nextTickTime(0.f), endTime(0.f) {}
+
+    void Start(float currentTime, float inTickInterval, float firstTickDelay, float duration)
+    {
+      tickInterval = inTickInterval;
+      nextTickTime = currentTime + firstTickDelay;
+      endTime = currentTime + duration;
+    }
+
+    // Re-applying keeps the current tick phase
+    void Refresh(float currentTime, float inTickInterval, float duration)
+    {
+      tickInterval = inTickInterval;
+      endTime = currentTime + duration;
+    }
+
+    bool IsExpired(float currentTime) const { return endTime <= currentTime; }
+
+    // Returns true if a tick is due, at most one tick per update
+    bool ConsumeTick(float currentTime)
+    {
+      if (nextTickTime > currentTime)
+      {
+        return false;
+      }
+      nextTickTime += tickInterval;
+      return true;
+    }
+  };
+
+  /* Cooldowns, stored as the time the cooldown ends so they replicate as a single float */
+
+  inline bool IsCooldownReady(float readyTime, float currentTime)
+  {
+    return readyTime < currentTime;
+  }
+
+  // Starts the cooldown and returns the previous ready time
+  inline float TriggerCooldown(float& readyTime, float currentTime, float duration)
+  {
+    const float previousReadyTime = readyTime;
+    readyTime = currentTime + duration;
+    return previousReadyTime;
+  }
+
+  // A cooldown the owning client started ahead of the server
+  struct FPredictedCooldown
+  {
+    float previousReadyTime;
+    float predictedReadyTime;
+  };
+
+  // Starts the cooldown at the owner's estimate of the server time, keeps what a rollback needs
+  inline FPredictedCooldown PredictCooldown(float& readyTime, float serverTime, float duration)
+  {
+    FPredictedCooldown prediction;
+    prediction.previousReadyTime = TriggerCooldown(readyTime, serverTime, duration);
+    prediction.predictedReadyTime = readyTime;
+    return prediction;
+  }
+
+  /* Restores the cooldown of a prediction the server rejected. Returns false if the server
+  / replicated a cooldown since the prediction, that value is newer than both and is kept. */
+  inline bool RollbackCooldown(float& readyTime, const FPredictedCooldown& prediction)
+  {
+    if (readyTime != prediction.predictedReadyTime)
+    {
+      return false;
+    }
+    readyTime = prediction.previousReadyTime;
+    return true;
+  }
+}
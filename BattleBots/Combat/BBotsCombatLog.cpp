@@ -0,0 +1,236 @@
+// Copyright 2015 VMR Games, Inc. All Rights Reserved.
+
+#include "BattleBots.h"
+#include "Containers/CircularQueue.h"
+#include "BBotsCombatLog.h"
+
+
+// Events buffered between two writer passes, 2MB
+static const uint32 CombatLogQueueSize = 1 << 16;
+// How often the writer thread drains the queue
+static const uint32 CombatLogFlushIntervalMs = 50;
+
+/* Drains the event queue to the log file. The game thread is the only
+producer and this thread the only consumer, which is what TCircularQueue
+is lock-free for. */
+class FBBotsCombatLogWriter : public FRunnable
+{
+public:
+  FBBotsCombatLogWriter(IFileHandle* inFile)
+    : eventQueue(CombatLogQueueSize), file(inFile), wakeEvent(FPlatformProcess::CreateSynchEvent())
+  {}
+
+  virtual ~FBBotsCombatLogWriter()
+  {
+    delete wakeEvent;
+    delete file;
+  }
+
+  // Game thread only
+  FORCEINLINE void Enqueue(const BBotCombatLog::FCombatLogEvent& event)
+  {
+    if (!eventQueue.Enqueue(event))
+    {
+      droppedEvents.Increment();
+    }
+  }
+
+  virtual uint32 Run() override
+  {
+    while (!bStopping)
+    {
+      Drain();
+      wakeEvent->Wait(CombatLogFlushIntervalMs);
+    }
+
+    // Events logged before Stop
+    Drain();
+    return 0;
+  }
+
+  virtual void Stop() override
+  {
+    bStopping = true;
+    wakeEvent->Trigger();
+  }
+
+  FORCEINLINE int32 GetNumDroppedEvents() const { return droppedEvents.GetValue(); }
+
+private:
+  TCircularQueue<BBotCombatLog::FCombatLogEvent> eventQueue;
+  // Reused between passes so the file gets one write per pass
+  TArray<BBotCombatLog::FCombatLogEvent> writeBuffer;
+  IFileHandle* file;
+  FEvent* wakeEvent;
+  FThreadSafeBool bStopping;
+  FThreadSafeCounter droppedEvents;
+
+  void Drain()
+  {
+    BBotCombatLog::FCombatLogEvent event;
+    while (eventQueue.Dequeue(event))
+    {
+      writeBuffer.Add(event);
+    }
+
+    if (writeBuffer.Num() > 0)
+    {
+      file->Write((const uint8*)writeBuffer.GetData(), writeBuffer.Num() * sizeof(BBotCombatLog::FCombatLogEvent));
+      writeBuffer.Reset();
+    }
+  }
+};
+
+ABBotsCombatLog::ABBotsCombatLog()
+{
+  PrimaryActorTick.bCanEverTick = false;
+
+  // The log lives on the server only
+  bReplicates = false;
+
+  writer = nullptr;
+  writerThread = nullptr;
+}
+
+void ABBotsCombatLog::BeginPlay()
+{
+  Super::BeginPlay();
+
+  if (!HasAuthority())
+  {
+    return;
+  }
+
+  const FString logDir = FPaths::GameSavedDir() / TEXT("CombatLogs");
+  const FString logPath = logDir / FString::Printf(TEXT("CombatLog-%s.bbcl"), *FDateTime::Now().ToString());
+
+  IPlatformFile& platformFile = FPlatformFileManager::Get().GetPlatformFile();
+  platformFile.CreateDirectoryTree(*logDir);
+
+  IFileHandle* file = platformFile.OpenWrite(*logPath);
+  if (!file)
+  {
+    UE_LOG(LogBattleBots, Warning, TEXT("Combat log: could not open %s"), *logPath);
+    return;
+  }
+
+  BBotCombatLog::FCombatLogFileHeader header;
+  header.magic = BBotCombatLog::FileMagic;
+  header.version = BBotCombatLog::FileVersion;
+  header.eventSize = sizeof(BBotCombatLog::FCombatLogEvent);
+  header.reserved = 0;
+  header.startTime = FDateTime::UtcNow().ToUnixTimestamp();
+  file->Write((const uint8*)&header, sizeof(header));
+
+  writer = new FBBotsCombatLogWriter(file);
+  writerThread = FRunnableThread::Create(writer, TEXT("BBotsCombatLogWriter"), 0, TPri_BelowNormal);
+}
+
+void ABBotsCombatLog::EndPlay(const EEndPlayReason::Type EndPlayReason)
+{
+  if (writerThread)
+  {
+    // Kill waits for the final drain
+    writerThread->Kill(true);
+    delete writerThread;
+    writerThread = nullptr;
+  }
+
+  if (writer)
+  {
+    if (writer->GetNumDroppedEvents() > 0)
+    {
+      UE_LOG(LogBattleBots, Warning, TEXT("Combat log: dropped %d events"), writer->GetNumDroppedEvents());
+    }
+    delete writer;
+    writer = nullptr;
+  }
+
+  Super::EndPlay(EndPlayReason);
+}
+
+void ABBotsCombatLog::LogCastStart(const AActor* caster, const UClass* spellClass, int32 spellIndex)
+{
+  AppendEvent(BBotCombatLog::EEventType::ECastStart, caster, nullptr, GetSpellId(spellClass), BBotCombatLog::NoElement, 0.f, 0.f, spellIndex);
+}
+
+void ABBotsCombatLog::LogCastFinish(const AActor* caster, const UClass* spellClass, int32 spellIndex)
+{
+  AppendEvent(BBotCombatLog::EEventType::ECastFinish, caster, nullptr, GetSpellId(spellClass), BBotCombatLog::NoElement, 0.f, 0.f, spellIndex);
+}
+
+void ABBotsCombatLog::LogProjectileSpawn(const AActor* caster, const UClass* spellClass, int32 projectileId)
+{
+  AppendEvent(BBotCombatLog::EEventType::EProjectileSpawn, caster, nullptr, GetSpellId(spellClass), BBotCombatLog::NoElement, 0.f, 0.f, projectileId);
+}
+
+void ABBotsCombatLog::LogHit(const AActor* caster, const AActor* target, const UClass* spellClass)
+{
+  AppendEvent(BBotCombatLog::EEventType::EHit, caster, target, GetSpellId(spellClass), BBotCombatLog::NoElement, 0.f, 0.f, 0);
+}
+
+void ABBotsCombatLog::LogDamage(const AActor* instigator, const AActor* target, uint8 element, float damage, float resist)
+{
+  AppendEvent(BBotCombatLog::EEventType::EDamage, instigator, target, 0, element, damage, resist, 0);
+}
+
+void ABBotsCombatLog::LogDotTick(const AActor* instigator, const AActor* target, uint8 element, float damagePerTick, uint8 effectType)
+{
+  AppendEvent(BBotCombatLog::EEventType::EDotTick, instigator, target, 0, element, damagePerTick, 0.f, effectType);
+}
+
+void ABBotsCombatLog::LogDeath(const AActor* killer, const AActor* victim, float killingDamage)
+{
+  AppendEvent(BBotCombatLog::EEventType::EDeath, killer, victim, 0, BBotCombatLog::NoElement, killingDamage, 0.f, 0);
+}
+
+void ABBotsCombatLog::LogStanceSwitch(const AActor* character, uint8 newStance)
+{
+  AppendEvent(BBotCombatLog::EEventType::EStanceSwitch, character, nullptr, 0, BBotCombatLog::NoElement, 0.f, 0.f, newStance);
+}
+
+uint32 ABBotsCombatLog::GetActorId(const AActor* actor)
+{
+  if (!actor)
+  {
+    return BBotCombatLog::NoActor;
+  }
+
+  const APawn* pawn = Cast<APawn>(actor);
+  const AController* controller = Cast<AController>(actor);
+  const APlayerState* playerState = pawn ? pawn->PlayerState : (controller ? controller->PlayerState : nullptr);
+
+  return playerState ? (uint32)playerState->PlayerId : (actor->GetUniqueID() | BBotCombatLog::ObjectIdFlag);
+}
+
+uint32 ABBotsCombatLog::GetSpellId(const UClass* spellClass)
+{
+  return spellClass ? FCrc::StrCrc32(*spellClass->GetName()) : 0;
+}
+
+int32 ABBotsCombatLog::GetNumDroppedEvents() const
+{
+  return writer ? writer->GetNumDroppedEvents() : 0;
+}
+
+void ABBotsCombatLog::AppendEvent(BBotCombatLog::EEventType type, const AActor* source, const AActor* target, uint32 spellId, uint8 element, float value, float resist, uint32 extra)
+{
+  if (!writer)
+  {
+    return;
+  }
+
+  BBotCombatLog::FCombatLogEvent event;
+  event.timeMs = (uint32)FMath::RoundToInt(GetWorld()->GetTimeSeconds() * 1000.f);
+  event.type = type;
+  event.element = element;
+  event.flags = 0;
+  event.sourceId = GetActorId(source);
+  event.targetId = GetActorId(target);
+  event.spellId = spellId;
+  event.value = value;
+  event.resist = resist;
+  event.extra = extra;
+
+  writer->Enqueue(event);
+}
@@ -0,0 +1,60 @@
+// Copyright 2015 VMR Games, Inc. All Rights Reserved.
+
+#pragma once
+
+#include "GameFramework/Info.h"
+#include "Combat/BBotCombatLogFormat.h"
+#include "BBotsCombatLog.generated.h"
+
+class FBBotsCombatLogWriter;
+class FRunnableThread;
+
+/**
+ * ABBotsCombatLog appends every cast, projectile, hit, damage, DoT tick,
+ * death and stance switch of the match to Saved/CombatLogs as fixed size
+ * binary records (see BBotCombatLogFormat.h). The game thread only pushes
+ * events into a lock-free single producer queue, a writer thread drains it
+ * to disk. If the writer falls behind, events are dropped and counted
+ * instead of stalling the game thread.
+ * The log is owned by the game mode and only exists on the server.
+ */
+UCLASS()
+class BATTLEBOTS_API ABBotsCombatLog : public AInfo
+{
+  GENERATED_BODY()
+
+public:
+  ABBotsCombatLog();
+
+  // Opens the log file and starts the writer thread
+  virtual void BeginPlay() override;
+
+  // Drains the remaining events and closes the log file
+  virtual void EndPlay(const EEndPlayReason::Type EndPlayReason) override;
+
+  void LogCastStart(const AActor* caster, const UClass* spellClass, int32 spellIndex);
+  void LogCastFinish(const AActor* caster, const UClass* spellClass, int32 spellIndex);
+  void LogProjectileSpawn(const AActor* caster, const UClass* spellClass, int32 projectileId);
+  void LogHit(const AActor* caster, const AActor* target, const UClass* spellClass);
+
+  // damage is the damage applied after resist
+  void LogDamage(const AActor* instigator, const AActor* target, uint8 element, float damage, float resist);
+  void LogDotTick(const AActor* instigator, const AActor* target, uint8 element, float damagePerTick, uint8 effectType);
+  void LogDeath(const AActor* killer, const AActor* victim, float killingDamage);
+  void LogStanceSwitch(const AActor* character, uint8 newStance);
+
+  // The player id of a pawn or controller, the object id with ObjectIdFlag for other actors, 0 for none
+  static uint32 GetActorId(const AActor* actor);
+
+  // CRC32 of the spell class name, stable between builds and runs
+  static uint32 GetSpellId(const UClass* spellClass);
+
+  // Returns the number of events dropped because the writer fell behind
+  int32 GetNumDroppedEvents() const;
+
+private:
+  FBBotsCombatLogWriter* writer;
+  FRunnableThread* writerThread;
+
+  void AppendEvent(BBotCombatLog::EEventType type, const AActor* source, const AActor* target, uint32 spellId, uint8 element, float value, float resist, uint32 extra);
+};
@@ -1,8 +1,79 @@
 // Copyright 2015 VMR Games, Inc. All Rights Reserved.
 
 #include "BattleBots.h"
+#include "Online/BBotsBaseGameMode.h"
+#include "Online/BBotsChatRouter.h"
+#include "Online/BBotsPlayerState.h"
 #include "BBotsBasePC.h"
 
 
+void ABBotsBasePC::SendChatMessage(const FChatMessageStruct& Message)
+{
+  ServerSendChatMessage(Message.MessageType, Message.Reciever.ToString(), Message.Message.ToString());
+}
 
+void ABBotsBasePC::ServerSendChatMessage_Implementation(EMessageType MessageType, const FString& Reciever, const FString& Message)
+{
+  BBOTS_INC_COUNTER(RPCs, 1);
+  ABBotsBaseGameMode* const GM = GetWorld()->GetAuthGameMode<ABBotsBaseGameMode>();
+  if (GM && GM->GetChatRouter())
+  {
+    GM->GetChatRouter()->RouteMessage(Cast<ABBotsPlayerState>(PlayerState), MessageType, Reciever, Message);
+  }
+}
 
+bool ABBotsBasePC::ServerSendChatMessage_Validate(EMessageType MessageType, const FString& Reciever, const FString& Message)
+{
+  // Longer messages are treated as a misbehaving client
+  return Message.Len() <= MaxChatMessageLength && Reciever.Len() <= MaxChatMessageLength;
+}
+
+void ABBotsBasePC::ClientReceiveChatBatch_Implementation(const TArray<FChatWireMessage>& Batch)
+{
+  BBOTS_INC_COUNTER(RPCs, 1);
+  const FDateTime Now = FBBotsChatFormatter::GetFrameTime();
+
+  for (const FChatWireMessage& WireMessage : Batch)
+  {
+    FChatMessageStruct Message;
+    Message.MessageType = WireMessage.MessageType;
+    Message.Message = FText::FromString(WireMessage.Message);
+    Message.SentTime = Now;
+
+    const APlayerState* Sender = FindPlayerState(WireMessage.SenderId);
+    if (Sender)
+    {
+      Message.Sender = FText::FromString(Sender->PlayerName);
+      const ABBotsPlayerState* BBotsSender = Cast<ABBotsPlayerState>(Sender);
+      Message.TeamNumber = BBotsSender ? BBotsSender->GetTeamNum() : 0;
+    }
+
+    if (WireMessage.MessageType == EMessageType::EWhisper)
+    {
+      const APlayerState* Reciever = FindPlayerState(WireMessage.RecieverId);
+      if (Reciever)
+      {
+        Message.Reciever = FText::FromString(Reciever->PlayerName);
+      }
+    }
+
+    // The color, timestamp and display text are set by the chat widget
+    OnChatMessageReceived(Message);
+  }
+}
+
+APlayerState* ABBotsBasePC::FindPlayerState(int32 PlayerId) const
+{
+  AGameState* const GS = GetWorld()->GameState;
+  if (GS && PlayerId != INDEX_NONE)
+  {
+    for (APlayerState* PS : GS->PlayerArray)
+    {
+      if (PS && PS->PlayerId == PlayerId)
+      {
+        return PS;
+      }
+    }
+  }
+  return nullptr;
+}
@@ -3,6 +3,7 @@
 #pragma once
 
 #include "GameFramework/PlayerController.h"
+#include "UI/ChatSystemLibrary/ChatSystemBlueprintLibrary.h"
 #include "BBotsBasePC.generated.h"
 
 /**
@@ -13,7 +14,28 @@ class BATTLEBOTS_API ABBotsBasePC : public APlayerController
 {
 	GENERATED_BODY()
 	
-	
-	
-	
+public:
+  // Sends a parsed chat message to the server, which routes it to its recipients
+  UFUNCTION(BlueprintCallable, Category = "Chat")
+  void SendChatMessage(const FChatMessageStruct& Message);
+
+  // Called by the chat router with every message of a net tick meant for this player
+  UFUNCTION(Reliable, Client)
+  void ClientReceiveChatBatch(const TArray<FChatWireMessage>& Batch);
+  void ClientReceiveChatBatch_Implementation(const TArray<FChatWireMessage>& Batch);
+
+protected:
+  // Hands a received message to the chat widget
+  UFUNCTION(BlueprintImplementableEvent, Category = "Chat")
+  void OnChatMessageReceived(const FChatMessageStruct& Message);
+
+private:
+  // Only the fields the server cannot fill in itself are sent
+  UFUNCTION(Reliable, Server, WithValidation)
+  void ServerSendChatMessage(EMessageType MessageType, const FString& Reciever, const FString& Message);
+  void ServerSendChatMessage_Implementation(EMessageType MessageType, const FString& Reciever, const FString& Message);
+  bool ServerSendChatMessage_Validate(EMessageType MessageType, const FString& Reciever, const FString& Message);
+
+  // Returns the player state of PlayerId, null when the player left
+  APlayerState* FindPlayerState(int32 PlayerId) const;
 };
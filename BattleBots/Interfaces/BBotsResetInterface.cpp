@@ -1,6 +1,8 @@
 // Copyright 2015 VMR Games, Inc. All Rights Reserved.
 
 #include "BattleBots.h"
+#include "BattleBotsGameMode.h"
+#include "World/BBotsResetRegistry.h"
 #include "BBotsResetInterface.h"
 
 
@@ -10,4 +12,27 @@ UBBotsResetInterface::UBBotsResetInterface(const FObjectInitializer& ObjectIniti
 {
 
 
-}
\ No newline at end of file
+}
+
+static ABBotsResetRegistry* GetResetRegistry(AActor* actor)
+{
+  UWorld* world = actor ? actor->GetWorld() : nullptr;
+  ABattleBotsGameMode* GM = world ? world->GetAuthGameMode<ABattleBotsGameMode>() : nullptr;
+  return GM ? GM->GetResetRegistry() : nullptr;
+}
+
+void IBBotsResetInterface::RegisterForReset(AActor* actor, EResetPriority::Type priority)
+{
+  if (ABBotsResetRegistry* registry = GetResetRegistry(actor))
+  {
+    registry->RegisterActor(actor, priority);
+  }
+}
+
+void IBBotsResetInterface::UnregisterForReset(AActor* actor)
+{
+  if (ABBotsResetRegistry* registry = GetResetRegistry(actor))
+  {
+    registry->UnregisterActor(actor);
+  }
+}
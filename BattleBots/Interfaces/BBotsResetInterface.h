@@ -4,6 +4,23 @@
 
 #include "BBotsResetInterface.generated.h"
 
+// The order in which the round reset visits the implementers
+namespace EResetPriority
+{
+  enum Type
+  {
+    // Spell and status effect managers, so no spell or effect outlives the round
+    EManagers,
+    // Spells and other world actors
+    EWorld,
+    // Scores
+    EPlayerStates,
+    // Respawns, after everything they could collide with is reset
+    EControllers,
+    EMax,
+  };
+}
+
 // Implement this interface for Actors that should handle game mode resets (halftime, warm-up rounds, role swaps, etc)
 UINTERFACE(MinimalAPI)
 class UBBotsResetInterface : public UInterface
@@ -19,5 +36,10 @@ class BATTLEBOTS_API IBBotsResetInterface
   UFUNCTION(BlueprintCallable, BlueprintNativeEvent, Category = "Game")
   void Reset();
 
+  /* Adds the actor to the reset registry of its world, implementers call it from BeginPlay.
+  / Does nothing on clients and in worlds without a match game mode. */
+  static void RegisterForReset(AActor* actor, EResetPriority::Type priority);
 
+  // Removes the actor from the reset registry, implementers call it from EndPlay
+  static void UnregisterForReset(AActor* actor);
 };
@@ -1,11 +1,67 @@
 // Copyright 2015 VMR Games, Inc. All Rights Reserved.
 
 #include "BattleBots.h"
+#include "Online/BBotsChatRouter.h"
+#include "Online/BBotsPlayerState.h"
 #include "BBotsBaseGameMode.h"
 
 
+ABBotsBaseGameMode::ABBotsBaseGameMode(const FObjectInitializer& ObjectInitializer)
+  : Super(ObjectInitializer)
+{
+  chatRouter = nullptr;
+}
+
+void ABBotsBaseGameMode::PreInitializeComponents()
+{
+  Super::PreInitializeComponents();
+
+  FActorSpawnParameters spawnInfo;
+  spawnInfo.Instigator = Instigator;
+  spawnInfo.bNoCollisionFail = true;
+  spawnInfo.ObjectFlags |= RF_Transient;
+
+  // Spawn the per world chat router, players are registered as they join
+  chatRouter = GetWorld()->SpawnActor<ABBotsChatRouter>(ABBotsChatRouter::StaticClass(), spawnInfo);
+}
+
+void ABBotsBaseGameMode::GenericPlayerInitialization(AController* C)
+{
+  Super::GenericPlayerInitialization(C);
+
+  if (chatRouter)
+  {
+    chatRouter->RegisterPlayer(Cast<ABBotsPlayerState>(C->PlayerState));
+  }
+}
+
+void ABBotsBaseGameMode::Logout(AController* Exiting)
+{
+  if (chatRouter)
+  {
+    chatRouter->UnregisterPlayer(Cast<ABBotsPlayerState>(Exiting->PlayerState));
+  }
 
+  Super::Logout(Exiting);
+}
+
+
+void ABBotsBaseGameMode::BBotsChatStats(bool bEnable)
+{
+  if (!chatRouter)
+  {
+    return;
+  }
 
+  if (bEnable)
+  {
+    chatRouter->BeginWireStats();
+  }
+  else
+  {
+    chatRouter->EndWireStats();
+  }
+}
 
 FString ABBotsBaseGameMode::GetNextMap()
 {
@@ -5,6 +5,8 @@
 #include "GameFramework/GameMode.h"
 #include "BBotsBaseGameMode.generated.h"
 
+class ABBotsChatRouter;
+
 /**
  * 
  */
@@ -14,6 +16,23 @@ class BATTLEBOTS_API ABBotsBaseGameMode : public AGameMode
 	GENERATED_BODY()
 	
 public:
+  ABBotsBaseGameMode(const FObjectInitializer& ObjectInitializer);
+
+  // Spawns the chat router
+  virtual void PreInitializeComponents() override;
+
+  // Registers joining and travelling players with the chat router
+  virtual void GenericPlayerInitialization(AController* C) override;
+
+  virtual void Logout(AController* Exiting) override;
+
+  // Returns the router that delivers chat messages, only valid on the server
+  FORCEINLINE ABBotsChatRouter* GetChatRouter() const { return chatRouter; }
+
+  /** starts (1) or ends (0) measuring the chat bytes per message, the result is printed to the log */
+  UFUNCTION(exec)
+  void BBotsChatStats(bool bEnable);
+
   UFUNCTION(BlueprintCallable, Category = "Game Map")
   FString GetNextMap();
   UFUNCTION(BlueprintCallable, Category = "Game Map")
@@ -30,4 +49,9 @@ protected:
   // The post game map name that is loaded after the match has ended.
   UPROPERTY(EditDefaultsOnly, Category = "Lobby")
   FString postGameMapName;
+
+private:
+  // Sends chat messages to their recipients only
+  UPROPERTY(Transient)
+  ABBotsChatRouter* chatRouter;
 };
@@ -0,0 +1,285 @@
+// Copyright 2015 VMR Games, Inc. All Rights Reserved.
+
+#include "BattleBots.h"
+#include "Controllers/BBotsBasePC.h"
+#include "Online/BBotsPlayerState.h"
+#include "BBotsChatRouter.h"
+
+
+#define LOCTEXT_NAMESPACE "ChatRouter"
+
+ABBotsChatRouter::ABBotsChatRouter()
+{
+  // Only ticks on frames that queued a message
+  PrimaryActorTick.bCanEverTick = true;
+  PrimaryActorTick.bStartWithTickEnabled = false;
+  // Flush after gameplay so the batches go out with this frame's net update
+  PrimaryActorTick.TickGroup = TG_PostUpdateWork;
+
+  // The router lives on the server only
+  bReplicates = false;
+
+  bMeasureWireStats = false;
+  numMessagesSent = 0;
+  numBatchesSent = 0;
+  numBatchBits = 0;
+  numLegacyBits = 0;
+}
+
+void ABBotsChatRouter::Tick(float DeltaSeconds)
+{
+  Super::Tick(DeltaSeconds);
+
+  for (ABBotsPlayerState* player : pendingPlayers)
+  {
+    FChatPlayer* entry = players.Find(player);
+    if (!entry)
+    {
+      continue;
+    }
+
+    ABBotsBasePC* const PC = Cast<ABBotsBasePC>(player->GetOwner());
+    if (PC)
+    {
+      if (bMeasureWireStats)
+      {
+        MeasureBatch(entry->pendingMessages);
+      }
+
+      PC->ClientReceiveChatBatch(entry->pendingMessages);
+    }
+    entry->pendingMessages.Reset();
+  }
+
+  pendingPlayers.Reset();
+  SetActorTickEnabled(false);
+}
+
+void ABBotsChatRouter::RegisterPlayer(ABBotsPlayerState* player)
+{
+  if (!player || players.Contains(player))
+  {
+    return;
+  }
+
+  FChatPlayer entry;
+  entry.name = FName(*player->PlayerName);
+  entry.teamNum = player->GetTeamNum();
+
+  AddToIndices(player, players.Add(player, entry));
+}
+
+void ABBotsChatRouter::UnregisterPlayer(ABBotsPlayerState* player)
+{
+  FChatPlayer entry;
+  if (players.RemoveAndCopyValue(player, entry))
+  {
+    RemoveFromIndices(player, entry);
+    pendingPlayers.RemoveSwap(player);
+  }
+}
+
+void ABBotsChatRouter::UpdatePlayer(ABBotsPlayerState* player)
+{
+  FChatPlayer* entry = players.Find(player);
+  if (!entry)
+  {
+    return;
+  }
+
+  const FName newName(*player->PlayerName);
+  const uint8 newTeamNum = player->GetTeamNum();
+  if (entry->name == newName && entry->teamNum == newTeamNum)
+  {
+    return;
+  }
+
+  RemoveFromIndices(player, *entry);
+  entry->name = newName;
+  entry->teamNum = newTeamNum;
+  AddToIndices(player, *entry);
+}
+
+void ABBotsChatRouter::RouteMessage(ABBotsPlayerState* sender, EMessageType messageType, const FString& recieverName, const FString& message)
+{
+  const FChatPlayer* senderEntry = players.Find(sender);
+  if (!senderEntry)
+  {
+    return;
+  }
+
+  // The sender comes from the server, never from the client
+  FChatWireMessage wireMessage;
+  wireMessage.MessageType = messageType;
+  wireMessage.SenderId = sender->PlayerId;
+  wireMessage.Message = message;
+
+  int32 numRecipients = 0;
+
+  switch (messageType)
+  {
+  case EMessageType::EAll:
+    for (auto It = players.CreateConstIterator(); It; ++It)
+    {
+      Enqueue(It.Key(), wireMessage);
+    }
+    numRecipients = players.Num();
+    break;
+
+  case EMessageType::ETeam:
+    if (const TArray<ABBotsPlayerState*>* members = teamMembers.Find(senderEntry->teamNum))
+    {
+      for (ABBotsPlayerState* member : *members)
+      {
+        Enqueue(member, wireMessage);
+      }
+      numRecipients = members->Num();
+    }
+    break;
+
+  case EMessageType::EWhisper:
+  {
+    // FNAME_Find so typos do not grow the name table
+    const FName name(*recieverName, FNAME_Find);
+    ABBotsPlayerState* const* reciever = name.IsNone() ? nullptr : playersByName.Find(name);
+
+    // A whisper that goes nowhere is answered with a notice, so the sender knows it was not delivered
+    if (!reciever)
+    {
+      SendSystemMessage(sender, FText::Format(LOCTEXT("PlayerNotFound", "{0} is not online"), FText::FromString(recieverName)));
+    }
+    else if (*reciever == sender)
+    {
+      SendSystemMessage(sender, LOCTEXT("WhisperToSelf", "You can not whisper to yourself"));
+    }
+    else
+    {
+      wireMessage.RecieverId = (*reciever)->PlayerId;
+      Enqueue(*reciever, wireMessage);
+      // The sender sees its own whisper
+      Enqueue(sender, wireMessage);
+      numRecipients = 2;
+    }
+    break;
+  }
+
+  default:
+    break;
+  }
+
+  if (bMeasureWireStats && numRecipients > 0)
+  {
+    MeasureLegacyMessage(sender, messageType, recieverName, wireMessage.Message, numRecipients);
+  }
+}
+
+void ABBotsChatRouter::BeginWireStats()
+{
+  bMeasureWireStats = true;
+  numMessagesSent = 0;
+  numBatchesSent = 0;
+  numBatchBits = 0;
+  numLegacyBits = 0;
+}
+
+void ABBotsChatRouter::EndWireStats()
+{
+  bMeasureWireStats = false;
+
+  if (numMessagesSent == 0)
+  {
+    UE_LOG(LogBattleBots, Log, TEXT("Chat wire stats: no messages sent"));
+    return;
+  }
+
+  UE_LOG(LogBattleBots, Log, TEXT("Chat wire stats: %d messages in %d batches, %.1f bytes/msg batched, %.1f bytes/msg as one FChatMessageStruct RPC each"),
+    numMessagesSent, numBatchesSent, numBatchBits / 8.0 / numMessagesSent, numLegacyBits / 8.0 / numMessagesSent);
+}
+
+void ABBotsChatRouter::AddToIndices(ABBotsPlayerState* player, const FChatPlayer& entry)
+{
+  if (!entry.name.IsNone())
+  {
+    playersByName.Add(entry.name, player);
+  }
+  teamMembers.FindOrAdd(entry.teamNum).Add(player);
+}
+
+void ABBotsChatRouter::RemoveFromIndices(ABBotsPlayerState* player, const FChatPlayer& entry)
+{
+  // Another player may have taken the name since
+  ABBotsPlayerState** namedPlayer = playersByName.Find(entry.name);
+  if (namedPlayer && *namedPlayer == player)
+  {
+    playersByName.Remove(entry.name);
+  }
+
+  if (TArray<ABBotsPlayerState*>* members = teamMembers.Find(entry.teamNum))
+  {
+    members->RemoveSwap(player);
+  }
+}
+
+void ABBotsChatRouter::Enqueue(ABBotsPlayerState* player, const FChatWireMessage& message)
+{
+  FChatPlayer* entry = players.Find(player);
+  if (!entry)
+  {
+    return;
+  }
+
+  if (entry->pendingMessages.Num() == 0)
+  {
+    pendingPlayers.Add(player);
+    SetActorTickEnabled(true);
+  }
+  entry->pendingMessages.Add(message);
+}
+
+void ABBotsChatRouter::SendSystemMessage(ABBotsPlayerState* player, const FText& message)
+{
+  FChatWireMessage wireMessage;
+  wireMessage.MessageType = EMessageType::ESystem;
+  wireMessage.SenderId = INDEX_NONE;
+  wireMessage.Message = message.ToString();
+  Enqueue(player, wireMessage);
+}
+
+void ABBotsChatRouter::MeasureBatch(TArray<FChatWireMessage>& batch)
+{
+  // Same layout as the TArray RPC parameter: the packed count, then each message
+  FNetBitWriter writer(nullptr, 1024);
+  uint32 numMessages = batch.Num();
+  writer.SerializeIntPacked(numMessages);
+
+  bool bSuccess = true;
+  for (FChatWireMessage& message : batch)
+  {
+    message.NetSerialize(writer, nullptr, bSuccess);
+  }
+
+  numBatchBits += writer.GetNumBits();
+  numMessagesSent += batch.Num();
+  numBatchesSent++;
+}
+
+void ABBotsChatRouter::MeasureLegacyMessage(ABBotsPlayerState* sender, EMessageType messageType, const FString& recieverName, const FString& message, int32 numRecipients)
+{
+  FChatMessageStruct legacyMessage;
+  legacyMessage.Sender = FText::FromString(sender->PlayerName);
+  legacyMessage.Reciever = FText::FromString(recieverName);
+  legacyMessage.Message = FText::FromString(message);
+  legacyMessage.TeamNumber = sender->GetTeamNum();
+  legacyMessage.MessageType = messageType;
+
+  // Every property of the struct went out as an RPC parameter
+  FNetBitWriter writer(nullptr, 1024);
+  for (TFieldIterator<UProperty> It(FChatMessageStruct::StaticStruct()); It; ++It)
+  {
+    It->NetSerializeItem(writer, nullptr, It->ContainerPtrToValuePtr<void>(&legacyMessage));
+  }
+
+  numLegacyBits += writer.GetNumBits() * numRecipients;
+}
+
+#undef LOCTEXT_NAMESPACE
@@ -0,0 +1,96 @@
+// Copyright 2015 VMR Games, Inc. All Rights Reserved.
+
+#pragma once
+
+#include "GameFramework/Info.h"
+#include "UI/ChatSystemLibrary/ChatSystemBlueprintLibrary.h"
+#include "BBotsChatRouter.generated.h"
+
+class ABBotsPlayerState;
+
+/**
+ * ABBotsChatRouter decides on the server who receives a chat message and
+ * sends it to those connections only: all chat to every player, team chat
+ * to the sender's team, whispers to the target and the sender. Recipients
+ * are resolved through per team member lists and a player name index, so
+ * team and whisper messages never reach (or leak to) other clients.
+ * Messages are queued per recipient and sent once per frame, in a single
+ * batch of compact FChatWireMessages per connection.
+ * The router is owned by the game mode and only exists on the server.
+ */
+UCLASS()
+class BATTLEBOTS_API ABBotsChatRouter : public AInfo
+{
+  GENERATED_BODY()
+
+public:
+  ABBotsChatRouter();
+
+  // Sends the queued batches, runs only on frames that routed a message
+  virtual void Tick(float DeltaSeconds) override;
+
+  // Indexes the player, called when the player joins or travels into the map
+  void RegisterPlayer(ABBotsPlayerState* player);
+
+  // Removes the player from every index, called on logout
+  void UnregisterPlayer(ABBotsPlayerState* player);
+
+  // Re-indexes the player after a team or name change
+  void UpdatePlayer(ABBotsPlayerState* player);
+
+  // Queues the message of sender for its recipients
+  void RouteMessage(ABBotsPlayerState* sender, EMessageType messageType, const FString& recieverName, const FString& message);
+
+  // Returns the number of registered players
+  FORCEINLINE int32 GetNumPlayers() const { return players.Num(); }
+
+  // Starts measuring the wire size of the sent batches
+  void BeginWireStats();
+
+  // Logs the measured bytes per message, next to the one RPC per message struct format it replaced
+  void EndWireStats();
+
+private:
+  struct FChatPlayer
+  {
+    FName name;
+    uint8 teamNum;
+    // Messages sent at the end of the frame
+    TArray<FChatWireMessage> pendingMessages;
+  };
+
+  // Indexed name and team of every registered player
+  TMap<ABBotsPlayerState*, FChatPlayer> players;
+
+  // FName compares case insensitive, like the old client side whisper check
+  TMap<FName, ABBotsPlayerState*> playersByName;
+
+  // The players of each team, removed with RemoveSwap
+  TMap<uint8, TArray<ABBotsPlayerState*>> teamMembers;
+
+  // Players with queued messages
+  TArray<ABBotsPlayerState*> pendingPlayers;
+
+  // Wire stats, only gathered between BeginWireStats and EndWireStats
+  bool bMeasureWireStats;
+  int32 numMessagesSent;
+  int32 numBatchesSent;
+  int64 numBatchBits;
+  int64 numLegacyBits;
+
+  void AddToIndices(ABBotsPlayerState* player, const FChatPlayer& entry);
+
+  void RemoveFromIndices(ABBotsPlayerState* player, const FChatPlayer& entry);
+
+  // Queues the message for player
+  void Enqueue(ABBotsPlayerState* player, const FChatWireMessage& message);
+
+  // Queues a server notice for a single player, shown without a sender
+  void SendSystemMessage(ABBotsPlayerState* player, const FText& message);
+
+  // Adds the size of a batch as it goes out
+  void MeasureBatch(TArray<FChatWireMessage>& batch);
+
+  // Adds the size of message in the struct format used before batching, sent once per recipient
+  void MeasureLegacyMessage(ABBotsPlayerState* sender, EMessageType messageType, const FString& recieverName, const FString& message, int32 numRecipients);
+};
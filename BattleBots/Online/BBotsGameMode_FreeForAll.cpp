@@ -14,10 +14,16 @@ void ABBotsGameMode_FreeForAll::DetermineMatchWinner()
 
   if (MyGameState)
   {
-    winningPlayer = Cast<ABBotsPlayerState>(FMath::Max<APlayerState*>(MyGameState->PlayerArray));
+    // The ranking is kept sorted as scores change
+    winningPlayer = MyGameState->GetLeadingPlayer();
   }
 }
 
+bool ABBotsGameMode_FreeForAll::IsWinner(ABBotsPlayerState* PlayerState) const
+{
+  return PlayerState && PlayerState == winningPlayer;
+}
+
 // FFA matches, players can spectate anyone.
 bool ABBotsGameMode_FreeForAll::CanSpectate_Implementation(APlayerController* Viewer, APlayerState* ViewTarget)
 {
@@ -13,12 +13,6 @@ class BATTLEBOTS_API ABBotsGameMode_FreeForAll : public ABattleBotsGameMode
 {
 	GENERATED_BODY()
 	
-public:
-
-  friend FORCEINLINE bool operator<(const APlayerState &PlayerOne, const APlayerState &PlayerTwo){
-    return PlayerOne.Score < PlayerTwo.Score;
-  }
-
 protected:
   // The player with the highest score
   ABBotsPlayerState* winningPlayer;
@@ -26,6 +20,9 @@ protected:
   // Sets the winning player
   virtual void DetermineMatchWinner() override;
 
+  // Only the winning player wins an FFA match
+  virtual bool IsWinner(ABBotsPlayerState* PlayerState) const override;
+
   virtual bool CanSpectate_Implementation(APlayerController* Viewer, APlayerState* ViewTarget) override;
 	
 };
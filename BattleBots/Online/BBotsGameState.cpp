@@ -1,6 +1,7 @@
 // Copyright 2015 VMR Games, Inc. All Rights Reserved.
 
 #include "BattleBots.h"
+#include "SpellSystem/SpellProjectileManager.h"
 #include "BBotsGameState.h"
 
 
@@ -10,8 +11,9 @@
 ABBotsGameState::ABBotsGameState(const FObjectInitializer& ObjectInitializer) : Super(ObjectInitializer)
 {
   numTeams = 0;
-  remainingTime = 0;
-  bTimerPaused = false;
+  matchPhase = EMatchPhase::EWaitingToStart;
+  phaseEndTime = 0.f;
+  projectileManager = nullptr;
 }
 
 void ABBotsGameState::GetLifetimeReplicatedProps(TArray< FLifetimeProperty > & OutLifetimeProps) const
@@ -19,8 +21,164 @@ void ABBotsGameState::GetLifetimeReplicatedProps(TArray< FLifetimeProperty > & O
   Super::GetLifetimeReplicatedProps(OutLifetimeProps);
 
   DOREPLIFETIME(ABBotsGameState, numTeams);
-  DOREPLIFETIME(ABBotsGameState, remainingTime);
-  DOREPLIFETIME(ABBotsGameState, bTimerPaused);
+  DOREPLIFETIME(ABBotsGameState, matchPhase);
+  DOREPLIFETIME(ABBotsGameState, phaseEndTime);
   DOREPLIFETIME(ABBotsGameState, teamScores);
+  DOREPLIFETIME(ABBotsGameState, rankedPlayers);
+  DOREPLIFETIME(ABBotsGameState, projectileManager);
 }
 
+void ABBotsGameState::SetMatchPhase(EMatchPhase::Type newPhase, float newPhaseEndTime)
+{
+  matchPhase = newPhase;
+  phaseEndTime = newPhaseEndTime;
+
+  // Rep notifies only run on the clients
+  OnMatchPhaseChanged(matchPhase);
+}
+
+void ABBotsGameState::OnRep_MatchPhase()
+{
+  OnMatchPhaseChanged(matchPhase);
+}
+
+float ABBotsGameState::GetPhaseTimeRemaining() const
+{
+  if (phaseEndTime <= 0.f)
+  {
+    return 0.f;
+  }
+  return FMath::Max(phaseEndTime - GetServerWorldTimeSeconds(), 0.f);
+}
+
+void ABBotsGameState::AddPlayerState(APlayerState* PlayerState)
+{
+  Super::AddPlayerState(PlayerState);
+
+  // Clients get the ranking through replication
+  ABBotsPlayerState* const player = Cast<ABBotsPlayerState>(PlayerState);
+  if (Role < ROLE_Authority || !player || rankIndices.Contains(player))
+  {
+    return;
+  }
+
+  rankIndices.Add(player, rankedPlayers.Add(player));
+  if (!UpdatePlayerRank(player))
+  {
+    OnRankingsChanged();
+  }
+}
+
+void ABBotsGameState::RemovePlayerState(APlayerState* PlayerState)
+{
+  int32 index;
+  if (Role == ROLE_Authority && rankIndices.RemoveAndCopyValue(Cast<ABBotsPlayerState>(PlayerState), index))
+  {
+    // Every player below moves up one rank
+    rankedPlayers.RemoveAt(index);
+    ReindexRanks(index, rankedPlayers.Num() - 1);
+    OnRankingsChanged();
+  }
+
+  Super::RemovePlayerState(PlayerState);
+}
+
+bool ABBotsGameState::UpdatePlayerRank(ABBotsPlayerState* player)
+{
+  const int32* foundIndex = rankIndices.Find(player);
+  if (!foundIndex)
+  {
+    return false;
+  }
+
+  /* Shift the player past the ones it overtook (or fell behind), the rest
+  / of the ranking keeps its order. Only the shifted slots change, so the cost
+  / and the replicated slots are the number of players whose rank changed. */
+  const int32 oldIndex = *foundIndex;
+  int32 index = oldIndex;
+
+  while (index > 0 && RanksAbove(player, rankedPlayers[index - 1]))
+  {
+    rankedPlayers[index] = rankedPlayers[index - 1];
+    index--;
+  }
+  if (index == oldIndex)
+  {
+    while (index + 1 < rankedPlayers.Num() && RanksAbove(rankedPlayers[index + 1], player))
+    {
+      rankedPlayers[index] = rankedPlayers[index + 1];
+      index++;
+    }
+  }
+
+  if (index == oldIndex)
+  {
+    return false;
+  }
+
+  rankedPlayers[index] = player;
+  ReindexRanks(FMath::Min(index, oldIndex), FMath::Max(index, oldIndex));
+  OnRankingsChanged();
+  return true;
+}
+
+int32 ABBotsGameState::GetPlayerRank(ABBotsPlayerState* player) const
+{
+  const int32* index = rankIndices.Find(player);
+  return index ? *index + 1 : 0;
+}
+
+void ABBotsGameState::GetTopPlayers(int32 count, TArray<ABBotsPlayerState*>& outPlayers) const
+{
+  outPlayers.Reset();
+
+  const int32 numPlayers = FMath::Min(count, rankedPlayers.Num());
+  for (int32 i = 0; i < numPlayers; i++)
+  {
+    // Clients can receive a slot before the player state it points to
+    if (rankedPlayers[i])
+    {
+      outPlayers.Add(rankedPlayers[i]);
+    }
+  }
+}
+
+ABBotsPlayerState* ABBotsGameState::GetLeadingPlayer() const
+{
+  return rankedPlayers.Num() > 0 ? rankedPlayers[0] : nullptr;
+}
+
+void ABBotsGameState::OnRep_RankedPlayers()
+{
+  rankIndices.Reset();
+  ReindexRanks(0, rankedPlayers.Num() - 1);
+  OnRankingsChanged();
+}
+
+bool ABBotsGameState::RanksAbove(const ABBotsPlayerState* a, const ABBotsPlayerState* b)
+{
+  if (a->Score != b->Score)
+  {
+    return a->Score > b->Score;
+  }
+  if (a->GetKills() != b->GetKills())
+  {
+    return a->GetKills() > b->GetKills();
+  }
+  if (a->GetDeaths() != b->GetDeaths())
+  {
+    return a->GetDeaths() < b->GetDeaths();
+  }
+  return a->PlayerId < b->PlayerId;
+}
+
+void ABBotsGameState::ReindexRanks(int32 first, int32 last)
+{
+  for (int32 i = first; i <= last; i++)
+  {
+    if (rankedPlayers[i])
+    {
+      rankIndices.Add(rankedPlayers[i], i);
+    }
+  }
+}
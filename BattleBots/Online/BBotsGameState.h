@@ -6,8 +6,23 @@
 #include "GameFramework/GameState.h"
 #include "BBotsGameState.generated.h"
 
-/** ranked PlayerState map, created from the GameState */
-typedef TMap<int32, TWeakObjectPtr<ABBotsPlayerState> > RankedPlayerMap;
+class ASpellProjectileManager;
+
+// The phases of a match, driven by the game mode
+UENUM(BlueprintType)
+namespace EMatchPhase
+{
+  enum Type
+  {
+    EWaitingToStart   UMETA(DisplayName = "Waiting To Start"),
+    EWarmup           UMETA(DisplayName = "Warmup"),
+    EInRound          UMETA(DisplayName = "In Round"),
+    ERoundEnd         UMETA(DisplayName = "Round End"),
+    EMatchEnd         UMETA(DisplayName = "Match End"),
+    // The next map is loading
+    EPostGame         UMETA(DisplayName = "Post Game"),
+  };
+}
 
 /**
  * 
@@ -27,6 +42,51 @@ public:
 
   FORCEINLINE bool IsWarmUpRound() { return totalNumRounds == 0; }
 
+  // Sets the phase and the server time it ends at, 0 for phases without an end. Server only
+  void SetMatchPhase(EMatchPhase::Type newPhase, float newPhaseEndTime);
+
+  UFUNCTION(BlueprintCallable, Category = "Match State")
+  TEnumAsByte<EMatchPhase::Type> GetMatchPhase() const { return matchPhase; }
+
+  // Returns the seconds left in the current phase, computed locally from the replicated end time and the engine's server clock
+  UFUNCTION(BlueprintCallable, Category = "Match State")
+  float GetPhaseTimeRemaining() const;
+
+  // Notifies the HUD, called on the server and the clients
+  UFUNCTION(BlueprintImplementableEvent, Category = "Match State")
+  void OnMatchPhaseChanged(TEnumAsByte<EMatchPhase::Type> newPhase);
+
+  UFUNCTION()
+  void OnRep_MatchPhase();
+
+  // Adds the player to the ranking on the server
+  virtual void AddPlayerState(APlayerState* PlayerState) override;
+
+  // Removes the player from the ranking on the server
+  virtual void RemovePlayerState(APlayerState* PlayerState) override;
+
+  // Moves the player to its new rank after a score change, returns true if any rank changed. Server only
+  bool UpdatePlayerRank(ABBotsPlayerState* player);
+
+  // Returns the 1 based rank of the player, 0 if it is not ranked
+  UFUNCTION(BlueprintCallable, Category = "Leaderboard")
+  int32 GetPlayerRank(ABBotsPlayerState* player) const;
+
+  // Fills outPlayers with up to count players, best ranked first
+  UFUNCTION(BlueprintCallable, Category = "Leaderboard")
+  void GetTopPlayers(int32 count, TArray<ABBotsPlayerState*>& outPlayers) const;
+
+  // Returns the best ranked player, null if there is none
+  UFUNCTION(BlueprintCallable, Category = "Leaderboard")
+  ABBotsPlayerState* GetLeadingPlayer() const;
+
+  // Notifies the scoreboard, called on the server and the clients when any rank changed
+  UFUNCTION(BlueprintImplementableEvent, Category = "Leaderboard")
+  void OnRankingsChanged();
+
+  UFUNCTION()
+  void OnRep_RankedPlayers();
+
   /** number of teams in current game (doesn't deprecate when no players are left in a team) */
   UPROPERTY(Transient, Replicated)
   int32 numTeams;
@@ -38,11 +98,29 @@ public:
   // The total number of rounds
   int32 totalNumRounds;
 
-  /** time left for warmup / match */
+  /** the current phase of the match */
+  UPROPERTY(Transient, ReplicatedUsing = OnRep_MatchPhase)
+  TEnumAsByte<EMatchPhase::Type> matchPhase;
+
+  /** server world time the current phase ends at, only replicated on phase changes */
   UPROPERTY(Transient, Replicated)
-  float remainingTime;
+  float phaseEndTime;
+
+  /** players sorted by score, best first. Only the slots of players that changed rank are replicated */
+  UPROPERTY(Transient, ReplicatedUsing = OnRep_RankedPlayers)
+  TArray<ABBotsPlayerState*> rankedPlayers;
 
-  /** is timer paused? */
+  /** the projectile manager spawned by the game mode, clients use it to predict their own projectiles */
   UPROPERTY(Transient, Replicated)
-  bool bTimerPaused;
+  ASpellProjectileManager* projectileManager;
+
+private:
+  // Maps a player to its index in rankedPlayers
+  TMap<const ABBotsPlayerState*, int32> rankIndices;
+
+  // Returns true if a ranks above b: score, then kills, then fewer deaths, then join order
+  static bool RanksAbove(const ABBotsPlayerState* a, const ABBotsPlayerState* b);
+
+  // Sets the rank index of the players in rankedPlayers from index first to last
+  void ReindexRanks(int32 first, int32 last);
 };
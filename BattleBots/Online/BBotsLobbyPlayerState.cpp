@@ -25,6 +25,7 @@ void ABBotsLobbyPlayerState::SetPlayerIsReady()
 
 void ABBotsLobbyPlayerState::ServerPlayerIsReady_Implementation()
 {
+  BBOTS_INC_COUNTER(RPCs, 1);
   ABBotsLobbyGameState* const MyGameState = Cast<ABBotsLobbyGameState>(GetWorld()->GetGameState());
 
   if (MyGameState)
@@ -45,6 +46,7 @@ void ABBotsLobbyPlayerState::SetPlayerNotReady()
 
 void ABBotsLobbyPlayerState::ServerPlayerNotReady_Implementation()
 {
+  BBOTS_INC_COUNTER(RPCs, 1);
   ABBotsLobbyGameState* const MyGameState = Cast<ABBotsLobbyGameState>(GetWorld()->GetGameState());
 
   if (MyGameState)
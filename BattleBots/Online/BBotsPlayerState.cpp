@@ -3,6 +3,8 @@
 #include "BattleBots.h"
 #include "BBotsPlayerState.h"
 #include "BBotsGameState.h"
+#include "BBotsBaseGameMode.h"
+#include "BBotsChatRouter.h"
 
 
 ABBotsPlayerState::ABBotsPlayerState(const FObjectInitializer& ObjectInitializer) : Super(ObjectInitializer)
@@ -12,6 +14,20 @@ ABBotsPlayerState::ABBotsPlayerState(const FObjectInitializer& ObjectInitializer
   numDeaths = 0;
 }
 
+void ABBotsPlayerState::BeginPlay()
+{
+  Super::BeginPlay();
+
+  RegisterForReset(this, EResetPriority::EPlayerStates);
+}
+
+void ABBotsPlayerState::EndPlay(const EEndPlayReason::Type EndPlayReason)
+{
+  UnregisterForReset(this);
+
+  Super::EndPlay(EndPlayReason);
+}
+
 void ABBotsPlayerState::Reset()
 {
   Super::Reset();
@@ -20,6 +36,12 @@ void ABBotsPlayerState::Reset()
   //SetTeamNum(0);
   numKills = 0;
   numDeaths = 0;
+
+  ABBotsGameState* const MyGameState = GetWorld() ? Cast<ABBotsGameState>(GetWorld()->GameState) : nullptr;
+  if (MyGameState && HasAuthority())
+  {
+    MyGameState->UpdatePlayerRank(this);
+  }
 }
 
 
@@ -49,6 +71,24 @@ void ABBotsPlayerState::SetTeamNum(int32 NewTeamNumber)
   teamNumber = NewTeamNumber;
 
   UpdateTeamColors();
+  UpdateChatRouter();
+}
+
+void ABBotsPlayerState::SetPlayerName(const FString& S)
+{
+  Super::SetPlayerName(S);
+
+  UpdateChatRouter();
+}
+
+void ABBotsPlayerState::UpdateChatRouter()
+{
+  // Only the server has a game mode
+  ABBotsBaseGameMode* const GM = GetWorld() ? GetWorld()->GetAuthGameMode<ABBotsBaseGameMode>() : nullptr;
+  if (GM && GM->GetChatRouter())
+  {
+    GM->GetChatRouter()->UpdatePlayer(this);
+  }
 }
 
 void ABBotsPlayerState::OnRep_TeamColor()
@@ -99,6 +139,11 @@ void ABBotsPlayerState::ScorePoints(int32 Points)
   }
 
   Score += Points;
+
+  if (MyGameState)
+  {
+    MyGameState->UpdatePlayerRank(this);
+  }
 }
 
 void ABBotsPlayerState::GetLifetimeReplicatedProps(TArray< FLifetimeProperty > & OutLifetimeProps) const
@@ -18,6 +18,11 @@ class BATTLEBOTS_API ABBotsPlayerState : public APlayerState, public IBBotsTeamI
 public:
   ABBotsPlayerState(const FObjectInitializer& ObjectInitializer);
 
+  // Registers with the round reset
+  virtual void BeginPlay() override;
+
+  virtual void EndPlay(const EEndPlayReason::Type EndPlayReason) override;
+
   /** clear scores */
   virtual void Reset() override;
 
@@ -33,6 +38,9 @@ public:
 
   virtual void UnregisterPlayerWithSession() override;
 
+  // Keeps the chat router's name index up to date
+  virtual void SetPlayerName(const FString& S) override;
+
   // End APlayerState interface
 
   /**
@@ -74,6 +82,9 @@ protected:
   /** Set the mesh colors based on the current teamnum variable */
   void UpdateTeamColors();
 
+  // Re-indexes the player in the chat router after a team or name change
+  void UpdateChatRouter();
+
   /** team number */
   UPROPERTY(Transient, ReplicatedUsing = OnRep_TeamColor)
   uint8 teamNumber;
@@ -13,50 +13,39 @@ AAOEFireSpell::AAOEFireSpell()
   AoeTickInterval = 0.2;
 
   collisionComp->InitSphereRadius(200.f);
-  collisionComp->SetCollisionProfileName(FName(TEXT("OverlapAll")));
+  // The AOE scheduler tests the volume against the characters, no physics overlaps required
+  collisionComp->SetCollisionProfileName(FName(TEXT("NoCollision")));
 }
 
 
-void AAOEFireSpell::PostInitializeComponents()
+void AAOEFireSpell::InitSpellDamage()
 {
-  Super::PostInitializeComponents();
+  Super::InitSpellDamage();
 
-  if (HasAuthority())
-  {
-    // Sets the dmg done per tick
-    SetDamageToDeal(ProcessElementalDmg(GetPreProcessedDotDamage()));
-  }
+  // Sets the dmg done per tick
+  SetDamageToDeal(GetDotDamage());
 }
 
-void AAOEFireSpell::BeginPlay()
+void AAOEFireSpell::ActivateSpell(const FVector& location, const FRotator& rotation)
 {
-  Super::BeginPlay();
+  Super::ActivateSpell(location, rotation);
 
   if (HasAuthority())
   {
-    // Enables AOE Tick on spawn
-    GetWorldTimerManager().SetTimer(AOETickHandler, this, &AAOEFireSpell::AOETick, AoeTickInterval, true);
+    // Starts dealing dmg to enemies standing in the volume
+    RegisterAOEVolume(AoeTickInterval);
   }
 }
 
-
-void AAOEFireSpell::OnCollisionOverlapBegin(class AActor* OtherActor, class UPrimitiveComponent* OtherComp, int32 OtherBodyIndex, bool bFromSweep, const FHitResult& SweepResult)
+void AAOEFireSpell::DestroySpell()
 {
-  // Because the damage is managed in AOETick, we need to override this method to prevent double processing
-  ABBotCharacter* enemyPlayer = Cast<ABBotCharacter>(OtherActor);
-
-  if (IsEnemy(enemyPlayer)) {
-    if (!OverlappedActors.Contains(enemyPlayer))
-    {
-      OverlappedActors.AddUnique(enemyPlayer);
-    }
-  }
+  /* The spell gets automatically destroyed after spellDuration. */
+  UnregisterAOEVolume();
 }
 
-void AAOEFireSpell::DestroySpell()
+bool AAOEFireSpell::IsBatchedProjectile() const
 {
-  /* The spell gets automatically destroyed after spellDuration. */
-  GetWorldTimerManager().ClearTimer(AOETickHandler);
+  return false;
 }
 
 void AAOEFireSpell::SimulateExplosion_Implementation()
@@ -70,19 +59,6 @@ FVector AAOEFireSpell::GetSpellSpawnLocation()
   return spellSpawnLocation;
 }
 
-void AAOEFireSpell::DealDamage(ABBotCharacter* enemyPlayer)
-{
-  if (HasAuthority())
-  {
-    // Deal damage only on the server
-
-    UGameplayStatics::ApplyDamage(enemyPlayer, GetDamageToDeal(), GetInstigatorController(), this, GetDamageEvent().DamageTypeClass);
-
-    // Ignite on crit?
-    DealUniqueSpellFunctionality(enemyPlayer);
-  }
-}
-
 float AAOEFireSpell::GetPreProcessedDotDamage()
 {
   return damagePerSecond * AoeTickInterval;
@@ -15,48 +15,38 @@ AAOEIceSpell::AAOEIceSpell()
   AoeTickInterval = 0.2;
 
   collisionComp->InitSphereRadius(200.f);
-  collisionComp->SetCollisionProfileName(FName(TEXT("OverlapAll")));
+  // The AOE scheduler tests the volume against the characters, no physics overlaps required
+  collisionComp->SetCollisionProfileName(FName(TEXT("NoCollision")));
 }
 
-void AAOEIceSpell::PostInitializeComponents()
+void AAOEIceSpell::InitSpellDamage()
 {
-  Super::PostInitializeComponents();
+  Super::InitSpellDamage();
 
-  if (HasAuthority())
-  {
-    // Sets the dmg done per tick
-    SetDamageToDeal(ProcessElementalDmg(GetPreProcessedDotDamage()));
-  }
+  // Sets the dmg done per tick
+  SetDamageToDeal(GetDotDamage());
 }
 
-void AAOEIceSpell::BeginPlay()
+void AAOEIceSpell::ActivateSpell(const FVector& location, const FRotator& rotation)
 {
-  Super::BeginPlay();
+  Super::ActivateSpell(location, rotation);
 
   if (HasAuthority())
   {
-    // Enables AOE Tick on spawn
-    GetWorldTimerManager().SetTimer(AOETickHandler, this, &AAOEIceSpell::AOETick, AoeTickInterval, true);
+    // Starts dealing dmg to enemies standing in the volume
+    RegisterAOEVolume(AoeTickInterval);
   }
 }
 
-void AAOEIceSpell::OnCollisionOverlapBegin(class AActor* OtherActor, class UPrimitiveComponent* OtherComp, int32 OtherBodyIndex, bool bFromSweep, const FHitResult& SweepResult)
+void AAOEIceSpell::DestroySpell()
 {
-  // Because the damage is managed in AOETick, we need to override this method to prevent double processing
-  ABBotCharacter* enemyPlayer = Cast<ABBotCharacter>(OtherActor);
-
-  if (IsEnemy(enemyPlayer)) {
-    if (!OverlappedActors.Contains(enemyPlayer))
-    {
-      OverlappedActors.AddUnique(enemyPlayer);
-    }
-  }
+  /* The spell gets automatically destroyed after spellDuration. */
+  UnregisterAOEVolume();
 }
 
-void AAOEIceSpell::DestroySpell()
+bool AAOEIceSpell::IsBatchedProjectile() const
 {
-  /* The spell gets automatically destroyed after spellDuration. */
-  GetWorldTimerManager().ClearTimer(AOETickHandler);
+  return false;
 }
 
 void AAOEIceSpell::SimulateExplosion_Implementation()
@@ -75,14 +65,3 @@ float AAOEIceSpell::GetPreProcessedDotDamage()
   return damagePerSecond * AoeTickInterval;
 }
 
-void AAOEIceSpell::DealDamage(ABBotCharacter* enemyPlayer)
-{
-  if (HasAuthority())
-  {
-    // Deal damage only on the server
-
-    UGameplayStatics::ApplyDamage(enemyPlayer, GetDamageToDeal(), GetInstigatorController(), this, GetDamageEvent().DamageTypeClass);
-
-    DealUniqueSpellFunctionality(enemyPlayer);
-  }
-}
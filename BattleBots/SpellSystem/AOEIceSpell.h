@@ -20,36 +20,30 @@ class BATTLEBOTS_API AAOEIceSpell : public AIceSpell
 public:
   AAOEIceSpell();
 
-  // Called after all components have been initialized with default values
-  virtual void PostInitializeComponents() override;
-
-  virtual void BeginPlay() override;
-
-  // Is called when a spell collides with a player.
-  virtual void OnCollisionOverlapBegin(class AActor* OtherActor, class UPrimitiveComponent* OtherComp, int32 OtherBodyIndex, bool bFromSweep, const FHitResult& SweepResult) override;
+  // Registers the AOE volume every time the spell is cast
+  virtual void ActivateSpell(const FVector& location, const FRotator& rotation) override;
 
   // Returns the spawned spell at mouse location
   virtual FVector GetSpellSpawnLocation() override;
 
 protected:
-  // The rate the aoe ticks
+  // The damage interval the spell damage is balanced around, the AOE scheduler runs at its own fixed rate
   UPROPERTY(EditDefaultsOnly, Category = "AOE Config")
   float AoeTickInterval;
 
   virtual float GetPreProcessedDotDamage() override;
 
-  // Enables AOE tick, to start dealing dmg to overlapping enemies
-  virtual void DealDamage(ABBotCharacter* enemyPlayer) override;
+  // Sets the dmg done per AOE tick
+  virtual void InitSpellDamage() override;
 
   /* The spell gets automatically destroyed after spellDuration.
   * We override this method to prevent spell destruction on contact.*/
   virtual void DestroySpell() override;
 
+  // AOE spells are volumes, not projectiles
+  virtual bool IsBatchedProjectile() const override;
+
   /* Default AOESpells don't play a unique fx/sound at death,
   * instead uses an active fx/sound throughout the duration. */
   virtual void SimulateExplosion_Implementation() override;
-
-private:
-  // Enables AOE spells to tick
-  FTimerHandle AOETickHandler;
 };
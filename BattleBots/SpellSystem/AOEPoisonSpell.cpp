@@ -15,48 +15,38 @@ AAOEPoisonSpell::AAOEPoisonSpell()
   AoeTickInterval = 0.2;
 
   collisionComp->InitSphereRadius(200.f);
-  collisionComp->SetCollisionProfileName(FName(TEXT("OverlapAll")));
+  // The AOE scheduler tests the volume against the characters, no physics overlaps required
+  collisionComp->SetCollisionProfileName(FName(TEXT("NoCollision")));
 }
 
-void AAOEPoisonSpell::PostInitializeComponents()
+void AAOEPoisonSpell::InitSpellDamage()
 {
-  Super::PostInitializeComponents();
+  Super::InitSpellDamage();
 
-  if (HasAuthority())
-  {
-    // Sets the dmg done per tick
-    SetDamageToDeal(ProcessElementalDmg(GetPreProcessedDotDamage()));
-  }
+  // Sets the dmg done per tick
+  SetDamageToDeal(GetDotDamage());
 }
 
-void AAOEPoisonSpell::BeginPlay()
+void AAOEPoisonSpell::ActivateSpell(const FVector& location, const FRotator& rotation)
 {
-  Super::BeginPlay();
+  Super::ActivateSpell(location, rotation);
 
   if (HasAuthority())
   {
-    // Enables AOE Tick on spawn
-    GetWorldTimerManager().SetTimer(AOETickHandler, this, &AAOEPoisonSpell::AOETick, AoeTickInterval, true);
+    // Starts dealing dmg to enemies standing in the volume
+    RegisterAOEVolume(AoeTickInterval);
   }
 }
 
-void AAOEPoisonSpell::OnCollisionOverlapBegin(class AActor* OtherActor, class UPrimitiveComponent* OtherComp, int32 OtherBodyIndex, bool bFromSweep, const FHitResult& SweepResult)
+void AAOEPoisonSpell::DestroySpell()
 {
-  // Because the damage is managed in AOETick, we need to override this method to prevent double processing
-  ABBotCharacter* enemyPlayer = Cast<ABBotCharacter>(OtherActor);
-
-  if (IsEnemy(enemyPlayer)) {
-    if (!OverlappedActors.Contains(enemyPlayer))
-    {
-      OverlappedActors.AddUnique(enemyPlayer);
-    }
-  }
+  /* The spell gets automatically destroyed after spellDuration. */
+  UnregisterAOEVolume();
 }
 
-void AAOEPoisonSpell::DestroySpell()
+bool AAOEPoisonSpell::IsBatchedProjectile() const
 {
-  /* The spell gets automatically destroyed after spellDuration. */
-  GetWorldTimerManager().ClearTimer(AOETickHandler);
+  return false;
 }
 
 void AAOEPoisonSpell::SimulateExplosion_Implementation()
@@ -70,18 +60,6 @@ FVector AAOEPoisonSpell::GetSpellSpawnLocation()
   return spellSpawnLocation;
 }
 
-void AAOEPoisonSpell::DealDamage(ABBotCharacter* enemyPlayer)
-{
-  if (HasAuthority())
-  {
-    // Deal damage only on the server
-    UGameplayStatics::ApplyDamage(enemyPlayer, GetDamageToDeal(), GetInstigatorController(), this, GetDamageEvent().DamageTypeClass);
-    
-    // Apply damage while enemy is in the volume, then apply a poison dot.
-    DealUniqueSpellFunctionality(enemyPlayer);
-  }
-}
-
 float AAOEPoisonSpell::GetPreProcessedDotDamage()
 {
   return damagePerSecond * AoeTickInterval;
@@ -4,3 +4,14 @@
 #include "BBotDmgType.h"
 
 
+UBBotDmgType::UBBotDmgType(const FObjectInitializer& ObjectInitializer)
+  : Super(ObjectInitializer)
+{
+  damageElement = EDamageElement::EMax;
+}
+
+EDamageElement::Type UBBotDmgType::GetDamageElement(TSubclassOf<UDamageType> damageTypeClass)
+{
+  const UBBotDmgType* dmgTypeCDO = damageTypeClass ? Cast<UBBotDmgType>(damageTypeClass->GetDefaultObject()) : nullptr;
+  return dmgTypeCDO ? dmgTypeCDO->damageElement.GetValue() : EDamageElement::EMax;
+}
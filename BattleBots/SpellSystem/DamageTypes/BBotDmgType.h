@@ -5,8 +5,27 @@
 #include "GameFramework/DamageType.h"
 #include "BBotDmgType.generated.h"
 
+// Dense element index, used to look up per element resists and bonus damage
+UENUM(BlueprintType)
+namespace EDamageElement
+{
+  enum Type
+  {
+    EPhysical     UMETA(DisplayName = "Physical"),
+    EFire         UMETA(DisplayName = "Fire"),
+    EIce          UMETA(DisplayName = "Ice"),
+    ELightning    UMETA(DisplayName = "Lightning"),
+    EHoly         UMETA(DisplayName = "Holy"),
+    EPoison       UMETA(DisplayName = "Poison"),
+    // Number of elements, also used for damage types without an element
+    EMax          UMETA(Hidden),
+  };
+}
+
 /**
- * 
+ * Base class of all the BattleBots damage types. Every subclass sets its
+ * element in its constructor, so resolving a damage type to its element
+ * is a read off the class default object instead of a chain of class compares.
  */
 UCLASS()
 class BATTLEBOTS_API UBBotDmgType : public UDamageType
@@ -14,7 +33,12 @@ class BATTLEBOTS_API UBBotDmgType : public UDamageType
 	GENERATED_BODY()
 	
 public:
-  //UBBotDmgType::UBBotDmgType() {}
-  //UBBotDmgType(const FObjectInitializer& ObjectInitializer);
-	
+  UBBotDmgType(const FObjectInitializer& ObjectInitializer);
+
+  // The element this damage type is resisted/boosted as
+  UPROPERTY(EditDefaultsOnly, Category = "DamageType")
+  TEnumAsByte<EDamageElement::Type> damageElement;
+
+  // Returns the element of the damage type, EMax if it has none
+  static EDamageElement::Type GetDamageElement(TSubclassOf<UDamageType> damageTypeClass);
 };
@@ -3,3 +3,9 @@
 #include "BattleBots.h"
 #include "BBotDmgType_Fire.h"
 
+
+UBBotDmgType_Fire::UBBotDmgType_Fire(const FObjectInitializer& ObjectInitializer)
+  : Super(ObjectInitializer)
+{
+  damageElement = EDamageElement::EFire;
+}
@@ -14,8 +14,5 @@ class BATTLEBOTS_API UBBotDmgType_Fire : public UBBotDmgType
 	GENERATED_BODY()
 	
 public:
-//   UBBotDmgType_Fire();
-//   UBBotDmgType_Fire(const FObjectInitializer& ObjectInitializer);
-	
-	
+  UBBotDmgType_Fire(const FObjectInitializer& ObjectInitializer);
 };
@@ -4,5 +4,8 @@
 #include "BBotDmgType_Holy.h"
 
 
-
-
+UBBotDmgType_Holy::UBBotDmgType_Holy(const FObjectInitializer& ObjectInitializer)
+  : Super(ObjectInitializer)
+{
+  damageElement = EDamageElement::EHoly;
+}
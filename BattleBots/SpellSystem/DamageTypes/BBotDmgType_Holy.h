@@ -13,7 +13,6 @@ class BATTLEBOTS_API UBBotDmgType_Holy : public UBBotDmgType
 {
 	GENERATED_BODY()
 	
-	
-	
-	
+public:
+  UBBotDmgType_Holy(const FObjectInitializer& ObjectInitializer);
 };
@@ -4,5 +4,8 @@
 #include "BBotDmgType_Ice.h"
 
 
-
-
+UBBotDmgType_Ice::UBBotDmgType_Ice(const FObjectInitializer& ObjectInitializer)
+  : Super(ObjectInitializer)
+{
+  damageElement = EDamageElement::EIce;
+}
@@ -13,7 +13,6 @@ class BATTLEBOTS_API UBBotDmgType_Ice : public UBBotDmgType
 {
 	GENERATED_BODY()
 	
-	
-	
-	
+public:
+  UBBotDmgType_Ice(const FObjectInitializer& ObjectInitializer);
 };
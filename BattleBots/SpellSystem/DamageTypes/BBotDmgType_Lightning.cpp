@@ -4,5 +4,8 @@
 #include "BBotDmgType_Lightning.h"
 
 
-
-
+UBBotDmgType_Lightning::UBBotDmgType_Lightning(const FObjectInitializer& ObjectInitializer)
+  : Super(ObjectInitializer)
+{
+  damageElement = EDamageElement::ELightning;
+}
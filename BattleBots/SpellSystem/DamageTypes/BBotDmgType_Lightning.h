@@ -13,7 +13,6 @@ class BATTLEBOTS_API UBBotDmgType_Lightning : public UBBotDmgType
 {
 	GENERATED_BODY()
 	
-	
-	
-	
+public:
+  UBBotDmgType_Lightning(const FObjectInitializer& ObjectInitializer);
 };
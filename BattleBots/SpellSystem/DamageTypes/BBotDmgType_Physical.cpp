@@ -4,5 +4,8 @@
 #include "BBotDmgType_Physical.h"
 
 
-
-
+UBBotDmgType_Physical::UBBotDmgType_Physical(const FObjectInitializer& ObjectInitializer)
+  : Super(ObjectInitializer)
+{
+  damageElement = EDamageElement::EPhysical;
+}
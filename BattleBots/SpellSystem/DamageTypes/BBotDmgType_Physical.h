@@ -13,7 +13,6 @@ class BATTLEBOTS_API UBBotDmgType_Physical : public UBBotDmgType
 {
 	GENERATED_BODY()
 	
-	
-	
-	
+public:
+  UBBotDmgType_Physical(const FObjectInitializer& ObjectInitializer);
 };
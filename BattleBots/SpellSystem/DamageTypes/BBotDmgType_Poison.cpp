@@ -4,5 +4,8 @@
 #include "BBotDmgType_Poison.h"
 
 
-
-
+UBBotDmgType_Poison::UBBotDmgType_Poison(const FObjectInitializer& ObjectInitializer)
+  : Super(ObjectInitializer)
+{
+  damageElement = EDamageElement::EPoison;
+}
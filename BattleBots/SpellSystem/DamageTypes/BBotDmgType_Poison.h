@@ -13,7 +13,6 @@ class BATTLEBOTS_API UBBotDmgType_Poison : public UBBotDmgType
 {
 	GENERATED_BODY()
 	
-	
-	
-	
+public:
+  UBBotDmgType_Poison(const FObjectInitializer& ObjectInitializer);
 };
@@ -1,6 +1,7 @@
 // // Copyright 2015 VMR Games, Inc. All Rights Reserved.
 
 #include "BattleBots.h"
+#include "SpellSystem/StatusEffectManager.h"
 #include "FireSpell.h"
 
 
@@ -12,25 +13,16 @@ void AFireSpell::PostInitializeComponents()
   {
     // Set damage type
     defaultDamageEvent.DamageTypeClass = UBBotDmgType_Fire::StaticClass();
-    // Set the ignite damage per ignite tick
-    igniteDamage = FMath::Clamp(ignitePercentage, 0.f, 1.f) * ProcessElementalDmg(GetPreProcessedDotDamage());
-    // Acts as an offset to prevent edge cases with odd tick durations
-    igniteDelay = igniteTick / 2;
   }
 }
 
-float AFireSpell::ProcessElementalDmg(float initialDamage)
+void AFireSpell::InitSpellDamage()
 {
-  if (GetSpellCaster())
-  {
-    float dmgMod = 1 + FMath::Clamp(GetSpellCaster()->GetDamageModifier_Fire(), -1.f, 1.f);
-    GEngine->AddOnScreenDebugMessage(-1, 4.f, FColor::Yellow, FString::FromInt(100 * dmgMod));
-    return FMath::Abs(initialDamage * dmgMod);
-  }
-  else {
-    GEngine->AddOnScreenDebugMessage(-1, 2.f, FColor::Red, TEXT("Fire Caster Is null!!"));
-    return initialDamage;
-  }
+  Super::InitSpellDamage();
+
+  // Set the ignite damage per ignite tick
+  igniteDamage = GetDotDamage(ignitePercentage);
+  igniteDelay = BBotCombat::GetDotFirstTickDelay(igniteTick);
 }
 
 float AFireSpell::GetPreProcessedDotDamage()
@@ -49,29 +41,16 @@ void AFireSpell::DealUniqueSpellFunctionality(ABBotCharacter* enemyPlayer)
 {
   if (HasAuthority())
   {
-	  igniteDelegate.BindUObject(this, &AFireSpell::IgniteEnemy, (ABBotCharacter*)enemyPlayer);
-	
-	  igniteDuration = GetFunctionalityDuration() + GetWorld()->GetTimeSeconds();
-	  GetWorldTimerManager().SetTimer(igniteHandler, igniteDelegate, igniteTick, true, igniteDelay);
+    AStatusEffectManager* statusEffects = GetStatusEffectManager();
+    if (statusEffects)
+    {
+      statusEffects->ApplyDot(enemyPlayer, EStatusEffectType::EIgnite, igniteDamage, igniteTick, igniteDelay, igniteDuration, GetInstigatorController(), this, GetDamageType());
+    }
   }
 }
 
-void AFireSpell::IgniteEnemy(ABBotCharacter* enemyPlayer)
+bool AFireSpell::IsBatchedProjectile() const
 {
-  if (HasAuthority())
-  {
-	  if (igniteDuration <= GetWorld()->GetTimeSeconds())
-	  {
-	    GetWorldTimerManager().ClearTimer(igniteHandler);
-	  }
-    else if (enemyPlayer)
-	  {
-	    UGameplayStatics::ApplyDamage(enemyPlayer, igniteDamage, GetInstigatorController(), this, GetDamageType());
-	  }
-  }
+  // Piercing projectiles keep their spell actor, they hit several enemies along their path
+  return !spellDataInfo.bIsPiercing;
 }
-
-float AFireSpell::GetFunctionalityDuration()
-{
-  return GetClass()->GetDefaultObject<AFireSpell>()->igniteDuration;
-}
\ No newline at end of file
@@ -41,28 +41,21 @@ public:
 protected:
   virtual float GetPreProcessedDotDamage() override;
 
+  // Sets the ignite damage based on the current caster
+  virtual void InitSpellDamage() override;
+
   // Process unique spell functionality such as Ignite.
   virtual void DealUniqueSpellFunctionality(ABBotCharacter* enemyPlayer) override;
 
-  virtual float GetFunctionalityDuration() override;
+  // Non-piercing casts are simulated by the projectile manager
+  virtual bool IsBatchedProjectile() const override;
 
-  // Processes final elemental damage post item dmg modifiers
-  virtual float ProcessElementalDmg(float initialDamage) override;
 
 private:
-  // Handles the ignite timers
-  FTimerHandle igniteHandler;
-
-  // Ignite delegate with an enemyPlayer payload
-  FTimerDelegate igniteDelegate;
-
   // The damage done per igniteTick
   UPROPERTY()
   float igniteDamage;
 
   // The initial delay for the first ignite
   float igniteDelay;
-
-  UFUNCTION()
-  void IgniteEnemy(ABBotCharacter* enemyPlayer);
 };
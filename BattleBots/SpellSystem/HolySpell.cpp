@@ -17,18 +17,6 @@ void AHolySpell::PostInitializeComponents()
   }
 }
 
-float AHolySpell::ProcessElementalDmg(float initialDamage)
-{
-  if (GetSpellCaster()) {
-    float dmgMod = 1 + FMath::Clamp(GetSpellCaster()->GetDamageModifier_Holy(), -1.f, 1.f);
-    return FMath::Abs(initialDamage * dmgMod);
-  }
-  else {
-    GEngine->AddOnScreenDebugMessage(-1, 2.f, FColor::Red, TEXT("Caster is null - holy"));
-    return initialDamage;
-  }
-}
-
 FDamageEvent& AHolySpell::GetDamageEvent()
 {
   return defaultDamageEvent;
@@ -20,8 +20,4 @@ public:
 
   // Returns the damage event and type
   virtual FDamageEvent& GetDamageEvent() override;
-
-protected:
-  // Processes final elemental damage post item dmg modifiers
-  virtual float ProcessElementalDmg(float initialDamage) override;
 };
@@ -1,6 +1,7 @@
 // // Copyright 2015 VMR Games, Inc. All Rights Reserved.
 
 #include "BattleBots.h"
+#include "SpellSystem/StatusEffectManager.h"
 #include "IceSpell.h"
 
 
@@ -16,18 +17,6 @@ void AIceSpell::PostInitializeComponents()
 }
 
 
-float AIceSpell::ProcessElementalDmg(float initialDamage)
-{
-  if (GetSpellCaster()) {
-    float dmgMod = 1 + FMath::Clamp(GetSpellCaster()->GetDamageModifier_Ice(), -1.f, 1.f);
-    return FMath::Abs(initialDamage * dmgMod);
-  }
-  else {
-    GEngine->AddOnScreenDebugMessage(-1, 2.f, FColor::Red, TEXT("Caster is null - Ice"));
-    return initialDamage;
-  }
-}
-
 FDamageEvent& AIceSpell::GetDamageEvent()
 {
   return defaultDamageEvent;
@@ -37,44 +26,17 @@ void AIceSpell::DealUniqueSpellFunctionality(ABBotCharacter* enemyPlayer)
 {
   if (HasAuthority())
   {
-	  // Slow the enemy movement speed
-	  SlowEnemy(enemyPlayer);
-	
-	  // Bind enemy player to SlowEnemyEnd delegate
-	  slowMovementDelegate.BindUObject(this, &AIceSpell::SlowEnemyEnd, (ABBotCharacter*)enemyPlayer);
-	  // Remove the slow effect after the slow duration
-	  GetWorldTimerManager().SetTimer(slowMovementHandler, slowMovementDelegate, slowDuration, false);
+    // Slow the enemy movement speed, the manager removes the slow after the slow duration
+    AStatusEffectManager* statusEffects = GetStatusEffectManager();
+    if (statusEffects)
+    {
+      statusEffects->ApplySlow(enemyPlayer, MakeNegative(slowPercentage), slowDuration);
+    }
   }
 }
 
-float AIceSpell::GetFunctionalityDuration()
-{
-  return slowDuration;
-}
-
-void AIceSpell::SlowEnemy(ABBotCharacter* enemyPlayer)
+bool AIceSpell::IsBatchedProjectile() const
 {
-  if (HasAuthority())
-  {
-    enemyPlayer->SlowPlayer(MakeNegative(slowPercentage), this);
-  }
-}
-
-void AIceSpell::SlowEnemyEnd(ABBotCharacter* enemyPlayer)
-{
-  if (HasAuthority())
-  {
-	  // Reverse the slow effect once the duration is up
-    enemyPlayer->ClearSlow();
-	  // Clear the timer once the duration ends
-    ClearUniqueTimers();
-  }
-}
-
-void AIceSpell::ClearUniqueTimers()
-{
-  if (HasAuthority())
-  {
-  	GetWorldTimerManager().ClearTimer(slowMovementHandler);
-  }
+  // Piercing projectiles keep their spell actor, they hit several enemies along their path
+  return !spellDataInfo.bIsPiercing;
 }
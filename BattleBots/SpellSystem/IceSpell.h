@@ -26,17 +26,12 @@ public:
   // Returns the damage event and type
   virtual FDamageEvent& GetDamageEvent() override;
 
-  // Clears the slow timers
-  virtual void ClearUniqueTimers() override;
-
   // TODO: Create a custom math library
   // Returns the negative version of num 
   template<class T>
   static FORCEINLINE T MakeNegative(const T num) { return FMath::Abs(num) * -1; }
 
 protected:
-  // Processes final elemental damage post item dmg modifiers
-  virtual float ProcessElementalDmg(float initialDamage) override;
 
   // The enemy player is slowed by x%
   UPROPERTY(EditDefaultsOnly, Category = "IceSpellConfig")
@@ -51,24 +46,6 @@ protected:
   // Process unique spell functionality such as slow enemy movement.
   virtual void DealUniqueSpellFunctionality(ABBotCharacter* enemyPlayer) override;
 
-  // Returns the slow duration
-  virtual float GetFunctionalityDuration() override;
-
-private:
-  // The time at the start of the slow
-  float currentTime;
-
-  // Handles the slow player timers
-  FTimerHandle slowMovementHandler;
-
-  // Ignite delegate with an enemyPlayer payload
-  FTimerDelegate slowMovementDelegate;
-
-  // Slows the enemy movement speed
-  UFUNCTION()
-  void SlowEnemy(ABBotCharacter* enemyPlayer);
-
-  // Removes the slow effect and clears the slow timer
-  UFUNCTION()
-  void SlowEnemyEnd(ABBotCharacter* enemyPlayer);
+  // Non-piercing casts are simulated by the projectile manager
+  virtual bool IsBatchedProjectile() const override;
 };
\ No newline at end of file
@@ -16,18 +16,6 @@ void ALightningSpell::PostInitializeComponents()
   }
 }
 
-float ALightningSpell::ProcessElementalDmg(float initialDamage)
-{
-  if (GetSpellCaster()) {
-    float dmgMod = 1 + FMath::Clamp(GetSpellCaster()->GetDamageModifier_Lightning(), -1.f, 1.f);
-    return FMath::Abs(initialDamage * dmgMod);
-  }
-  else {
-    GEngine->AddOnScreenDebugMessage(-1, 2.f, FColor::Red, TEXT("Caster is null - Lightning"));
-    return initialDamage;
-  }
-}
-
 FDamageEvent& ALightningSpell::GetDamageEvent()
 {
   return defaultDamageEvent;
@@ -24,6 +24,4 @@ public:
 protected:
   FDamageEvent defaultDamageEvent;
 
-  // Processes final elemental damage post item dmg modifiers
-  virtual float ProcessElementalDmg(float initialDamage) override;
 };
@@ -1,6 +1,7 @@
 // // Copyright 2015 VMR Games, Inc. All Rights Reserved.
 
 #include "BattleBots.h"
+#include "SpellSystem/StatusEffectManager.h"
 #include "PoisonSpell.h"
 
 
@@ -13,23 +14,16 @@ void APoisonSpell::PostInitializeComponents()
   {
     // Set the damage type of the spell to poison
     defaultDamageEvent.DamageTypeClass = UBBotDmgType_Poison::StaticClass();
-    // Set the dot damage per poison tick
-    poisonDotDamage = ProcessElementalDmg(GetPreProcessedDotDamage());
-    // Acts as an offset to prevent edge cases with odd tick durations
-    poisonDotDelay = poisonTick / 2;
   }
 }
 
-float APoisonSpell::ProcessElementalDmg(float initialDamage)
+void APoisonSpell::InitSpellDamage()
 {
-  if (GetSpellCaster()) {
-    float dmgMod = 1 + FMath::Clamp(GetSpellCaster()->GetDamageModifier_Poison(), -1.f, 1.f);
-    return FMath::Abs(initialDamage * dmgMod);
-  }
-  else {
-    GEngine->AddOnScreenDebugMessage(-1, 2.f, FColor::Red, TEXT("Caster is null - poison"));
-    return initialDamage;
-  }
+  Super::InitSpellDamage();
+
+  // Set the dot damage per poison tick
+  poisonDotDamage = GetDotDamage();
+  poisonDotDelay = BBotCombat::GetDotFirstTickDelay(poisonTick);
 }
 
 float APoisonSpell::GetPreProcessedDotDamage()
@@ -42,16 +36,12 @@ FDamageEvent& APoisonSpell::GetDamageEvent()
   return defaultDamageEvent;
 }
 
-void APoisonSpell::DealDamage(ABBotCharacter* enemyPlayer)
+void APoisonSpell::ApplySpellHit(ABBotCharacter* enemyPlayer, const FVector& hitLocation)
 {
   if (HasAuthority())
   {
-    // Deal damage only on the server
-
     // Deal poison damage per poisonTick on the enemy player
     DealUniqueSpellFunctionality(enemyPlayer);
-
-    DestroySpell();
   }
 }
 
@@ -59,29 +49,16 @@ void APoisonSpell::DealUniqueSpellFunctionality(ABBotCharacter* enemyPlayer)
 {
   if (HasAuthority())
   {
-	  poisonDotDelegate.BindUObject(this, &APoisonSpell::PoisonEnemy, (ABBotCharacter*)enemyPlayer);
-	
-	  poisonDuration = GetFunctionalityDuration() + GetWorld()->GetTimeSeconds();
-	  GetWorldTimerManager().SetTimer(poisonDotHandler, poisonDotDelegate, poisonTick, true, poisonDotDelay);
+    AStatusEffectManager* statusEffects = GetStatusEffectManager();
+    if (statusEffects)
+    {
+      statusEffects->ApplyDot(enemyPlayer, EStatusEffectType::EPoison, poisonDotDamage, poisonTick, poisonDotDelay, poisonDuration, GetInstigatorController(), this, GetDamageType());
+    }
   }
 }
 
-void APoisonSpell::PoisonEnemy(ABBotCharacter* enemyPlayer)
+bool APoisonSpell::IsBatchedProjectile() const
 {
-  if (HasAuthority())
-  {
-	  if (poisonDuration <= GetWorld()->GetTimeSeconds())
-	  {
-	    GetWorldTimerManager().ClearTimer(poisonDotHandler);
-	  }
-    else if (enemyPlayer)
-	  {
-	    UGameplayStatics::ApplyDamage(enemyPlayer, poisonDotDamage, GetInstigatorController(), this, GetDamageType());
-	  }
-  }
+  // Piercing projectiles keep their spell actor, they hit several enemies along their path
+  return !spellDataInfo.bIsPiercing;
 }
-
-float APoisonSpell::GetFunctionalityDuration()
-{
-  return GetClass()->GetDefaultObject<APoisonSpell>()->poisonDuration;
-}
\ No newline at end of file
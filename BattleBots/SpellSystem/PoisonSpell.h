@@ -34,35 +34,26 @@ public:
   virtual FDamageEvent& GetDamageEvent() override;
 
 protected:
-  // Processes final elemental damage post item dmg modifiers
-  virtual float ProcessElementalDmg(float initialDamage) override;
 
   virtual float GetPreProcessedDotDamage() override;
 
-  // Deals damage to the actor and manages spell death. Override spell functionality, ex: Ignite, slow, etc.
-  virtual void DealDamage(ABBotCharacter* enemyPlayer) override;
+  // Sets the poison dot damage based on the current caster
+  virtual void InitSpellDamage() override;
+
+  // Poison skills deal no hit damage, the hit only applies the poison dot
+  virtual void ApplySpellHit(ABBotCharacter* enemyPlayer, const FVector& hitLocation) override;
 
   // Process unique spell functionality such as turning poison skills into DOTs.
   virtual void DealUniqueSpellFunctionality(ABBotCharacter* enemyPlayer) override;
 
-  // Returns poison dot duration
-  virtual float GetFunctionalityDuration() override;
+  // Non-piercing casts are simulated by the projectile manager
+  virtual bool IsBatchedProjectile() const override;
 
 private:
-  // Handles the ignite timers
-  FTimerHandle poisonDotHandler;
-
-  // Ignite delegate with an enemyPlayer payload
-  FTimerDelegate poisonDotDelegate;
-
   // The damage done per poisonTick
   float poisonDotDamage;
 
   // The initial delay before poisoning the enemy player
   float poisonDotDelay;
-
-  // Called on every poison tick
-  UFUNCTION()
-  void PoisonEnemy(ABBotCharacter* enemyPlayer);
 };
 
@@ -0,0 +1,221 @@
+// Copyright 2015 VMR Games, Inc. All Rights Reserved.
+
+#include "BattleBots.h"
+#include "Character/BBotCharacter.h"
+#include "SpellSystem/SpellSystem.h"
+#include "World/BBotsSpatialGrid.h"
+#include "BattleBotsGameMode.h"
+#include "SpellAOEScheduler.h"
+
+
+ASpellAOEScheduler::ASpellAOEScheduler()
+{
+  PrimaryActorTick.bCanEverTick = true;
+
+  // The scheduler lives on the server only
+  bReplicates = false;
+
+  aoeTickInterval = 0.2f;
+  characterQueryPadding = 100.f;
+  stepAccumulator = 0.f;
+  bSteppingVolumes = false;
+}
+
+void ASpellAOEScheduler::Tick(float DeltaSeconds)
+{
+  BBOTS_SCOPE_CYCLE_COUNTER(AOETick);
+  Super::Tick(DeltaSeconds);
+
+  if (!HasAuthority() || volumeSpells.Num() == 0)
+  {
+    stepAccumulator = 0.f;
+    return;
+  }
+
+  stepAccumulator += DeltaSeconds;
+
+  // Fixed rate steps, so the AOE damage does not depend on the server frame rate
+  while (stepAccumulator >= aoeTickInterval)
+  {
+    stepAccumulator -= aoeTickInterval;
+    StepVolumes(aoeTickInterval);
+  }
+}
+
+void ASpellAOEScheduler::RegisterVolume(ASpellSystem* spell, const FVector& center, float radius, float damagePerSecond, float duration)
+{
+  if (!spell || !HasAuthority())
+  {
+    return;
+  }
+
+  // A spell only owns one volume, re-registering moves it
+  UnregisterVolume(spell);
+
+  volumeCenters.Add(center);
+  volumeRadii.Add(radius);
+  volumeDps.Add(damagePerSecond);
+  volumeDamageTypes.Add(spell->GetDamageEvent().DamageTypeClass);
+  volumeInstigators.Add(spell->GetInstigatorController());
+  volumeSpells.Add(spell);
+  volumeExpiry.Add(GetWorld()->GetTimeSeconds() + duration);
+}
+
+void ASpellAOEScheduler::UnregisterVolume(ASpellSystem* spell)
+{
+  for (int32 i = 0; i < volumeSpells.Num(); i++)
+  {
+    if (volumeSpells[i].Get() == spell)
+    {
+      RemoveVolumeAt(i);
+      return;
+    }
+  }
+}
+
+float ASpellAOEScheduler::GetEnemyDpsAt(const FVector& location, float padding, uint8 teamNum) const
+{
+  ABattleBotsGameMode* GM = GetWorld()->GetAuthGameMode<ABattleBotsGameMode>();
+  const float currentTime = GetWorld()->GetTimeSeconds();
+  float enemyDps = 0.f;
+
+  for (int32 v = 0; v < volumeSpells.Num(); v++)
+  {
+    // Expired volumes are only dropped on the next step
+    if (volumeExpiry[v] <= currentTime || !volumeSpells[v].IsValid())
+    {
+      continue;
+    }
+
+    const float reach = volumeRadii[v] + padding;
+    if (FVector::DistSquared(volumeCenters[v], location) > reach * reach)
+    {
+      continue;
+    }
+
+    AController* instigator = volumeInstigators[v].Get();
+    ABBotsPlayerState* instigatorPS = instigator ? Cast<ABBotsPlayerState>(instigator->PlayerState) : nullptr;
+    // Same relation the volume's damage goes through, 255 for an instigator without a PlayerState
+    if (GM && GM->CanTeamsDealDamage(instigatorPS ? instigatorPS->GetTeamNum() : 255, teamNum))
+    {
+      enemyDps += volumeDps[v];
+    }
+  }
+
+  return enemyDps;
+}
+
+void ASpellAOEScheduler::RemoveVolumeAt(int32 index)
+{
+  // Keep the indices of the step stable, the entry no longer matches a spell and is skipped
+  if (bSteppingVolumes)
+  {
+    volumeSpells[index] = nullptr;
+    volumeExpiry[index] = -1.f;
+    return;
+  }
+
+  volumeCenters.RemoveAtSwap(index, 1, false);
+  volumeRadii.RemoveAtSwap(index, 1, false);
+  volumeDps.RemoveAtSwap(index, 1, false);
+  volumeDamageTypes.RemoveAtSwap(index, 1, false);
+  volumeInstigators.RemoveAtSwap(index, 1, false);
+  volumeSpells.RemoveAtSwap(index, 1, false);
+  volumeExpiry.RemoveAtSwap(index, 1, false);
+}
+
+void ASpellAOEScheduler::CompactVolumes()
+{
+  const float currentTime = GetWorld()->GetTimeSeconds();
+
+  // Drops the marked volumes, along with expired volumes and volumes whose spell is gone
+  for (int32 i = volumeSpells.Num() - 1; i >= 0; i--)
+  {
+    if (!volumeSpells[i].IsValid() || volumeExpiry[i] <= currentTime)
+    {
+      RemoveVolumeAt(i);
+    }
+  }
+}
+
+void ASpellAOEScheduler::StepVolumes(float stepSeconds)
+{
+  CompactVolumes();
+
+  if (volumeSpells.Num() == 0)
+  {
+    return;
+  }
+
+  ABattleBotsGameMode* GM = GetWorld()->GetAuthGameMode<ABattleBotsGameMode>();
+  ABBotsSpatialGrid* spatialGrid = GM ? GM->GetSpatialGrid() : nullptr;
+
+  if (!spatialGrid)
+  {
+    return;
+  }
+
+  // Volumes registered during the step are appended and only stepped next time
+  const int32 numVolumes = volumeSpells.Num();
+  bSteppingVolumes = true;
+
+  for (int32 v = 0; v < numVolumes; v++)
+  {
+    // Unregistered earlier in this step
+    if (!volumeSpells[v].IsValid())
+    {
+      continue;
+    }
+
+    const FVector center = volumeCenters[v];
+    const float radius = volumeRadii[v];
+    const float stepDamage = volumeDps[v] * stepSeconds;
+    ASpellSystem* spell = volumeSpells[v].Get();
+    AController* instigator = volumeInstigators[v].Get();
+    APawn* caster = spell->GetInstigator();
+
+    // Friendly fire rules are checked by CanRecieveDamage, so the grid is not filtered by team
+    stepCandidates.Reset();
+    spatialGrid->QueryRadius(center, radius + characterQueryPadding, stepCandidates);
+
+    for (ABBotCharacter* enemy : stepCandidates)
+    {
+      if (enemy == caster || !enemy->IsAlive() || enemy->IsDying())
+      {
+        continue;
+      }
+
+      // Sphere vs upright capsule, closest point on the capsule segment to the volume center
+      float capsuleRadius, capsuleHalfHeight;
+      enemy->GetCapsuleComponent()->GetScaledCapsuleSize(capsuleRadius, capsuleHalfHeight);
+
+      const FVector location = enemy->GetActorLocation();
+      const float segmentHalfHeight = FMath::Max(capsuleHalfHeight - capsuleRadius, 0.f);
+      const float closestZ = FMath::Clamp(center.Z, location.Z - segmentHalfHeight, location.Z + segmentHalfHeight);
+      const float distSquared = FVector::DistSquaredXY(center, location) + FMath::Square(center.Z - closestZ);
+      const float overlapRadius = radius + capsuleRadius;
+
+      if (distSquared > overlapRadius * overlapRadius)
+      {
+        continue;
+      }
+
+      if (enemy->CanRecieveDamage(instigator, volumeDamageTypes[v]))
+      {
+        UGameplayStatics::ApplyDamage(enemy, stepDamage, instigator, spell, volumeDamageTypes[v]);
+
+        // The damage can kill the caster and reset the spell, which unregisters this volume
+        if (!volumeSpells[v].IsValid())
+        {
+          break;
+        }
+
+        // Ignite, slow, poison, etc.
+        spell->DealUniqueSpellFunctionality(enemy);
+      }
+    }
+  }
+
+  bSteppingVolumes = false;
+  CompactVolumes();
+}
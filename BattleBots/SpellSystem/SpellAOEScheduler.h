@@ -0,0 +1,85 @@
+// Copyright 2015 VMR Games, Inc. All Rights Reserved.
+
+#pragma once
+
+#include "GameFramework/Info.h"
+#include "SpellAOEScheduler.generated.h"
+
+class ASpellSystem;
+class ABBotCharacter;
+
+/**
+ * ASpellAOEScheduler owns every live AOE volume in the world and deals their
+ * damage in a single pass at a fixed AOE rate, instead of every AOE spell
+ * running its own looping timer over its overlapped actors.
+ * Volumes are stored as parallel arrays so the overlap pass only touches
+ * the data it needs, and only the characters the spatial grid returns for
+ * each volume are tested. The scheduler is owned by the game mode and only
+ * exists on the server.
+ */
+UCLASS()
+class BATTLEBOTS_API ASpellAOEScheduler : public AInfo
+{
+  GENERATED_BODY()
+
+public:
+  ASpellAOEScheduler();
+
+  // Steps the AOE volumes at the fixed AOE rate
+  virtual void Tick(float DeltaSeconds) override;
+
+  /* Adds a damaging volume owned by spell. The volume deals damagePerSecond,
+  split over the fixed AOE steps, until it is unregistered or its duration is up. */
+  void RegisterVolume(ASpellSystem* spell, const FVector& center, float radius, float damagePerSecond, float duration);
+
+  // Removes the volume owned by spell
+  void UnregisterVolume(ASpellSystem* spell);
+
+  // Returns the summed damage per second of the live volumes within padding of location that can hurt teamNum
+  float GetEnemyDpsAt(const FVector& location, float padding, uint8 teamNum) const;
+
+  // Returns the number of live AOE volumes
+  FORCEINLINE int32 GetNumVolumes() const { return volumeSpells.Num(); }
+
+  // Returns the fixed AOE rate in seconds
+  FORCEINLINE float GetTickInterval() const { return aoeTickInterval; }
+
+protected:
+  // The fixed rate all AOE volumes deal damage at
+  UPROPERTY(EditDefaultsOnly, Category = "AOE Config")
+  float aoeTickInterval;
+
+  // Added to the volume radius when querying the spatial grid, should cover the widest character capsule
+  UPROPERTY(EditDefaultsOnly, Category = "AOE Config")
+  float characterQueryPadding;
+
+private:
+  // Time accumulated towards the next AOE step
+  float stepAccumulator;
+
+  /* AOE volume data, one entry per volume at the same index.
+  Volumes are removed with RemoveAtSwap so the arrays stay packed,
+  except during a step where they are only marked and compacted after. */
+  TArray<FVector> volumeCenters;
+  TArray<float> volumeRadii;
+  TArray<float> volumeDps;
+  TArray<TSubclassOf<UDamageType>> volumeDamageTypes;
+  TArray<TWeakObjectPtr<AController>> volumeInstigators;
+  TArray<TWeakObjectPtr<ASpellSystem>> volumeSpells;
+  TArray<float> volumeExpiry;
+
+  // Characters near the current volume, reused between volumes to avoid allocations
+  TArray<ABBotCharacter*> stepCandidates;
+
+  // True while StepVolumes deals damage, a death can unregister volumes from inside the step
+  bool bSteppingVolumes;
+
+  // Deals one step of damage for every live volume
+  void StepVolumes(float stepSeconds);
+
+  // Removes the volume at index, or marks it for CompactVolumes during a step
+  void RemoveVolumeAt(int32 index);
+
+  // Removes the volumes marked during a step
+  void CompactVolumes();
+};
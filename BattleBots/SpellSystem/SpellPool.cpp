@@ -0,0 +1,155 @@
+// Copyright 2015 VMR Games, Inc. All Rights Reserved.
+
+#include "BattleBots.h"
+#include "SpellSystem/SpellSystem.h"
+#include "SpellPool.h"
+
+
+ASpellPool::ASpellPool()
+{
+  // The pool lives on the server only
+  bReplicates = false;
+
+  prewarmCountPerSpell = 4;
+  maxPooledPerSpell = 32;
+}
+
+void ASpellPool::PrewarmSpell(TSubclassOf<ASpellSystem> spellClass)
+{
+  if (!spellClass || !HasAuthority())
+  {
+    return;
+  }
+
+  TArray<TWeakObjectPtr<ASpellSystem>>& freeList = freeSpells.FindOrAdd(spellClass);
+
+  for (int32 i = 0; i < prewarmCountPerSpell && freeList.Num() < maxPooledPerSpell; i++)
+  {
+    ASpellSystem* newSpell = SpawnPooledSpell(spellClass, GetActorLocation(), FRotator::ZeroRotator, nullptr, nullptr);
+
+    if (newSpell)
+    {
+      // Spawned spells start active, hide them until they are cast
+      newSpell->DeactivateSpell();
+      freeList.Add(newSpell);
+      poolStats.prewarmed++;
+    }
+  }
+}
+
+ASpellSystem* ASpellPool::AcquireSpell(TSubclassOf<ASpellSystem> spellClass, const FVector& location, const FRotator& rotation, AActor* spellOwner, APawn* spellInstigator)
+{
+  if (!spellClass || !HasAuthority())
+  {
+    return nullptr;
+  }
+
+  ASpellSystem* spell = PopFreeSpell(spellClass);
+
+  if (spell)
+  {
+    poolStats.hits++;
+    spell->SetOwner(spellOwner);
+    spell->Instigator = spellInstigator;
+  }
+  else
+  {
+    poolStats.misses++;
+    spell = SpawnPooledSpell(spellClass, location, rotation, spellOwner, spellInstigator);
+  }
+
+  if (spell)
+  {
+    poolStats.numActive++;
+    spell->ActivateSpell(location, rotation);
+  }
+
+  return spell;
+}
+
+void ASpellPool::ReleaseSpell(ASpellSystem* spell)
+{
+  if (!spell || !spell->IsPooledSpellActive())
+  {
+    // Already released, multiple death paths can release the same spell
+    return;
+  }
+
+  spell->DeactivateSpell();
+  poolStats.releases++;
+  poolStats.numActive = FMath::Max(poolStats.numActive - 1, 0);
+
+  TArray<TWeakObjectPtr<ASpellSystem>>& freeList = freeSpells.FindOrAdd(spell->GetClass());
+
+  if (freeList.Num() < maxPooledPerSpell)
+  {
+    freeList.Add(spell);
+  }
+  else
+  {
+    // The pool is full, no need to keep this one around
+    spell->Destroy();
+  }
+}
+
+FSpellPoolStats ASpellPool::GetPoolStats() const
+{
+  FSpellPoolStats currentStats = poolStats;
+  currentStats.numPooled = 0;
+
+  for (auto It = freeSpells.CreateConstIterator(); It; ++It)
+  {
+    currentStats.numPooled += It.Value().Num();
+  }
+
+  return currentStats;
+}
+
+void ASpellPool::LogPoolStats() const
+{
+  const FSpellPoolStats currentStats = GetPoolStats();
+  const int32 totalRequests = currentStats.hits + currentStats.misses;
+  const float hitRate = totalRequests > 0 ? (100.f * currentStats.hits) / totalRequests : 0.f;
+
+  UE_LOG(LogBattleBots, Log, TEXT("SpellPool: hits %d, misses %d (%.1f%% hit rate), releases %d, prewarmed %d, pooled %d, active %d"),
+    currentStats.hits, currentStats.misses, hitRate, currentStats.releases, currentStats.prewarmed, currentStats.numPooled, currentStats.numActive);
+
+  for (auto It = freeSpells.CreateConstIterator(); It; ++It)
+  {
+    UE_LOG(LogBattleBots, Log, TEXT("  %s: %d pooled"), *GetNameSafe(It.Key()), It.Value().Num());
+  }
+}
+
+ASpellSystem* ASpellPool::SpawnPooledSpell(TSubclassOf<ASpellSystem> spellClass, const FVector& location, const FRotator& rotation, AActor* spellOwner, APawn* spellInstigator)
+{
+  FActorSpawnParameters spawnInfo;
+  spawnInfo.Owner = spellOwner;
+  spawnInfo.Instigator = spellInstigator;
+  spawnInfo.bNoCollisionFail = true;
+
+  ASpellSystem* newSpell = GetWorld()->SpawnActor<ASpellSystem>(spellClass, location, rotation, spawnInfo);
+
+  if (newSpell)
+  {
+    newSpell->SetSpellPool(this);
+  }
+
+  return newSpell;
+}
+
+ASpellSystem* ASpellPool::PopFreeSpell(UClass* spellClass)
+{
+  TArray<TWeakObjectPtr<ASpellSystem>>* freeList = freeSpells.Find(spellClass);
+
+  while (freeList && freeList->Num() > 0)
+  {
+    ASpellSystem* spell = freeList->Pop(false).Get();
+
+    if (spell && !spell->IsPendingKill())
+    {
+      return spell;
+    }
+  }
+
+  return nullptr;
+}
@@ -0,0 +1,88 @@
+// Copyright 2015 VMR Games, Inc. All Rights Reserved.
+
+#pragma once
+
+#include "GameFramework/Info.h"
+#include "SpellPool.generated.h"
+
+class ASpellSystem;
+
+// Pool usage counters, used to size the pre-warm counts per map
+USTRUCT(BlueprintType)
+struct FSpellPoolStats{
+  GENERATED_USTRUCT_BODY()
+
+  // Spells that were handed out from the free list
+  UPROPERTY(BlueprintReadOnly, Category = "SpellPool")
+  int32 hits;
+  // Spells that had to be spawned because the free list was empty
+  UPROPERTY(BlueprintReadOnly, Category = "SpellPool")
+  int32 misses;
+  // Spells that were returned to the free list
+  UPROPERTY(BlueprintReadOnly, Category = "SpellPool")
+  int32 releases;
+  // Spells that were spawned ahead of time from the characters spell bars
+  UPROPERTY(BlueprintReadOnly, Category = "SpellPool")
+  int32 prewarmed;
+  // Spells currently sitting in the free lists
+  UPROPERTY(BlueprintReadOnly, Category = "SpellPool")
+  int32 numPooled;
+  // Spells currently active in the world
+  UPROPERTY(BlueprintReadOnly, Category = "SpellPool")
+  int32 numActive;
+
+  FSpellPoolStats()
+    : hits(0), misses(0), releases(0), prewarmed(0), numPooled(0), numActive(0)
+  {}
+};
+
+/**
+ * ASpellPool recycles spell actors per world. Casting a spell activates a
+ * pooled actor instead of spawning a new one, and the spell is deactivated
+ * and returned to the pool once it explodes or its life time is up.
+ * The pool is owned by the game mode and only exists on the server.
+ */
+UCLASS()
+class BATTLEBOTS_API ASpellPool : public AInfo
+{
+  GENERATED_BODY()
+
+public:
+  ASpellPool();
+
+  // Spawns spells of the given class ahead of time. Called when a spell is added to a spell bar.
+  void PrewarmSpell(TSubclassOf<ASpellSystem> spellClass);
+
+  // Returns an active spell at location, spawning a new one if the pool is empty
+  ASpellSystem* AcquireSpell(TSubclassOf<ASpellSystem> spellClass, const FVector& location, const FRotator& rotation, AActor* spellOwner, APawn* spellInstigator);
+
+  // Deactivates the spell and puts it back in the free list
+  void ReleaseSpell(ASpellSystem* spell);
+
+  UFUNCTION(BlueprintCallable, Category = "SpellPool")
+  FSpellPoolStats GetPoolStats() const;
+
+  // Prints the pool stats to the log
+  void LogPoolStats() const;
+
+protected:
+  // The number of spells spawned ahead of time every time a spell is added to a spell bar
+  UPROPERTY(EditDefaultsOnly, Category = "SpellPool")
+  int32 prewarmCountPerSpell;
+
+  // The maximum number of inactive spells kept per spell class, extra spells are destroyed on release
+  UPROPERTY(EditDefaultsOnly, Category = "SpellPool")
+  int32 maxPooledPerSpell;
+
+private:
+  // Inactive spells per spell class
+  TMap<UClass*, TArray<TWeakObjectPtr<ASpellSystem>>> freeSpells;
+
+  FSpellPoolStats poolStats;
+
+  // Spawns a new spell owned by the pool. It starts active like any spawned spell, callers activate or deactivate it
+  ASpellSystem* SpawnPooledSpell(TSubclassOf<ASpellSystem> spellClass, const FVector& location, const FRotator& rotation, AActor* spellOwner, APawn* spellInstigator);
+
+  // Pops a valid spell from the free list, skipping spells destroyed outside of the pool
+  ASpellSystem* PopFreeSpell(UClass* spellClass);
+};
@@ -0,0 +1,568 @@
+// Copyright 2015 VMR Games, Inc. All Rights Reserved.
+
+#include "BattleBots.h"
+#include "Character/BBotCharacter.h"
+#include "SpellSystem/SpellSystem.h"
+#include "World/BBotsSpatialGrid.h"
+#include "BattleBotsGameMode.h"
+#include "SpellSystem/SpellPool.h"
+#include "Combat/BBotsCombatLog.h"
+#include "Online/BBotsPlayerState.h"
+#include "BattleBotsPlayerController.h"
+#include "SpellProjectileManager.h"
+
+
+ASpellProjectileManager::ASpellProjectileManager()
+{
+  PrimaryActorTick.bCanEverTick = true;
+
+  /* Clients need the manager to simulate the fx. It has no replicated properties,
+  the launch and end events go through the player controllers of the relevant players. */
+  bReplicates = true;
+  bAlwaysRelevant = true;
+
+  characterQueryPadding = 100.f;
+  endEventTimeout = 1.f;
+  nextProjectileId = 0;
+}
+
+void ASpellProjectileManager::Tick(float DeltaSeconds)
+{
+  BBOTS_SCOPE_CYCLE_COUNTER(ProjectileTick);
+  Super::Tick(DeltaSeconds);
+
+  if (HasAuthority())
+  {
+    // Live spells are the spell actors out of the pool plus the batched projectiles
+    ABattleBotsGameMode* GM = GetWorld()->GetAuthGameMode<ABattleBotsGameMode>();
+    const int32 numActiveSpells = GM && GM->GetSpellPool() ? GM->GetSpellPool()->GetPoolStats().numActive : 0;
+    BBOTS_SET_COUNTER(LiveSpells, numActiveSpells + projectiles.Num());
+  }
+
+  if (projectiles.Num() == 0)
+  {
+    return;
+  }
+
+  const float currentTime = GetServerTime();
+
+  if (HasAuthority())
+  {
+    StepProjectilesServer(currentTime);
+  }
+
+  // Listen servers show the fx as well
+  if (GetNetMode() != NM_DedicatedServer)
+  {
+    StepProjectilesClient(currentTime);
+  }
+}
+
+void ASpellProjectileManager::BeginPlay()
+{
+  Super::BeginPlay();
+
+  RegisterForReset(this, EResetPriority::EManagers);
+}
+
+void ASpellProjectileManager::EndPlay(const EEndPlayReason::Type EndPlayReason)
+{
+  UnregisterForReset(this);
+
+  Super::EndPlay(EndPlayReason);
+}
+
+void ASpellProjectileManager::Reset_Implementation()
+{
+  for (int32 i = projectiles.Num() - 1; i >= 0; i--)
+  {
+    EndProjectileAt(i, projectiles[i].location, false);
+  }
+}
+
+float ASpellProjectileManager::GetServerTime() const
+{
+  AGameState* const GS = GetWorld()->GameState;
+  return GS ? GS->GetServerWorldTimeSeconds() : GetWorld()->GetTimeSeconds();
+}
+
+void ASpellProjectileManager::LaunchProjectile(ASpellSystem* spell, const FVector& location, const FRotator& rotation, int32 predictionKey)
+{
+  if (!spell || !HasAuthority())
+  {
+    return;
+  }
+
+  // The caster's damage modifiers may have changed since the last cast
+  spell->InitSpellDamage();
+
+  FSpellProjectile projectile;
+  projectile.projectileId = nextProjectileId++;
+  projectile.predictionKey = predictionKey;
+  projectile.origin = location;
+  projectile.velocity = rotation.RotateVector(spell->initialLocalVelocity);
+  projectile.radius = spell->collisionComp->GetScaledSphereRadius();
+  projectile.spawnTime = GetServerTime();
+  projectile.lifeTime = spell->spellDataInfo.spellDuration;
+  projectile.location = location;
+  projectile.spellClass = spell->GetClass();
+  projectile.spellManager = spell;
+  projectile.caster = spell->GetInstigator();
+  projectile.casterTeamNum = spell->GetSpellCaster() ? spell->GetSpellCaster()->GetTeamNum() : 255;
+
+  const int32 index = projectiles.Add(projectile);
+
+  ABattleBotsGameMode* GM = GetWorld()->GetAuthGameMode<ABattleBotsGameMode>();
+  if (GM && GM->GetCombatLog())
+  {
+    GM->GetCombatLog()->LogProjectileSpawn(projectile.caster.Get(), projectile.spellClass, projectile.projectileId);
+  }
+
+  SendLaunch(index);
+
+  // Listen servers already simulate the projectile, it only needs the fx
+  if (GetNetMode() != NM_DedicatedServer)
+  {
+    CreateVisual(index);
+  }
+}
+
+void ASpellProjectileManager::SendLaunch(int32 index)
+{
+  FSpellProjectile& projectile = projectiles[index];
+
+  for (FConstPlayerControllerIterator It = GetWorld()->GetPlayerControllerIterator(); It; ++It)
+  {
+    ABattleBotsPlayerController* PC = Cast<ABattleBotsPlayerController>(*It);
+    if (!PC || PC->IsLocalController() || !IsRelevantTo(projectile, PC))
+    {
+      continue;
+    }
+
+    projectile.recipients.Add(PC);
+    PC->ClientLaunchProjectile(projectile.projectileId, projectile.origin, projectile.velocity, projectile.radius, projectile.spawnTime, projectile.lifeTime, projectile.spellClass,
+      projectile.caster.Get(), projectile.predictionKey);
+  }
+}
+
+bool ASpellProjectileManager::IsRelevantTo(const FSpellProjectile& projectile, const ABattleBotsPlayerController* PC) const
+{
+  const APawn* caster = projectile.caster.Get();
+  if (caster && caster->Controller == PC)
+  {
+    return true;
+  }
+
+  const ASpellSystem* spellDefaults = projectile.spellClass ? projectile.spellClass->GetDefaultObject<ASpellSystem>() : nullptr;
+  if (!spellDefaults)
+  {
+    return false;
+  }
+
+  FVector viewLocation;
+  FRotator viewRotation;
+  PC->GetPlayerViewPoint(viewLocation, viewRotation);
+
+  // The closest the projectile gets to the viewer over its whole range
+  const FVector closestPoint = FMath::ClosestPointOnSegment(viewLocation, projectile.origin, projectile.GetLocationAt(projectile.spawnTime + projectile.lifeTime));
+  const float distSquared = (closestPoint - viewLocation).SizeSquared();
+
+  const ABBotsPlayerState* viewerPS = Cast<ABBotsPlayerState>(PC->PlayerState);
+  if (viewerPS && viewerPS->GetTeamNum() == projectile.casterTeamNum)
+  {
+    return distSquared < spellDefaults->allyNetCullDistanceSquared;
+  }
+
+  return distSquared < spellDefaults->NetCullDistanceSquared;
+}
+
+void ASpellProjectileManager::LaunchPredictedProjectile(ASpellSystem* spell, const FVector& location, const FRotator& rotation, int32 predictionKey)
+{
+  // The server launches the real projectile, only remote clients predict
+  if (!spell || HasAuthority() || predictionKey == INDEX_NONE)
+  {
+    return;
+  }
+
+  for (const FSpellProjectile& serverProjectile : projectiles)
+  {
+    if (serverProjectile.predictionKey == predictionKey && serverProjectile.caster == spell->GetInstigator())
+    {
+      // The server projectile arrived before our cast bar ended
+      return;
+    }
+  }
+
+  FSpellProjectile projectile;
+  projectile.predictionKey = predictionKey;
+  projectile.origin = location;
+  projectile.velocity = rotation.RotateVector(spell->initialLocalVelocity);
+  projectile.radius = spell->collisionComp->GetScaledSphereRadius();
+  projectile.spawnTime = GetServerTime();
+  projectile.lifeTime = spell->spellDataInfo.spellDuration;
+  projectile.location = location;
+  projectile.spellClass = spell->GetClass();
+  projectile.caster = spell->GetInstigator();
+
+  CreateVisual(projectiles.Add(projectile));
+}
+
+void ASpellProjectileManager::CancelPredictedProjectile(int32 predictionKey)
+{
+  const int32 index = FindPredictedProjectile(predictionKey);
+  if (index != INDEX_NONE)
+  {
+    EndProjectileAt(index, projectiles[index].location, false);
+  }
+}
+
+void ASpellProjectileManager::StepProjectilesServer(float currentTime)
+{
+  // Iterate backwards, ended projectiles are removed with RemoveAtSwap
+  for (int32 i = projectiles.Num() - 1; i >= 0; i--)
+  {
+    FSpellProjectile& projectile = projectiles[i];
+    ASpellSystem* spell = projectile.spellManager.Get();
+
+    if (!spell)
+    {
+      // The caster left the match and took its spell bar with it
+      EndProjectileAt(i, projectile.location, false);
+      continue;
+    }
+
+    const float endTime = projectile.spawnTime + projectile.lifeTime;
+    const FVector start = projectile.location;
+    const FVector end = projectile.GetLocationAt(FMath::Min(currentTime, endTime));
+
+    float hitFraction;
+    ABBotCharacter* enemy;
+
+    if (SweepProjectile(projectile, start, end, hitFraction, enemy))
+    {
+      const FVector hitLocation = FMath::Lerp(start, end, hitFraction);
+
+      if (enemy)
+      {
+        spell->ApplySpellHit(enemy, hitLocation);
+      }
+      EndProjectileAt(i, hitLocation, true);
+      continue;
+    }
+
+    projectile.location = end;
+
+    if (currentTime >= endTime)
+    {
+      // Out of range, non-piercing projectiles fade out without exploding
+      EndProjectileAt(i, end, false);
+    }
+  }
+}
+
+void ASpellProjectileManager::StepProjectilesClient(float currentTime)
+{
+  for (int32 i = projectiles.Num() - 1; i >= 0; i--)
+  {
+    FSpellProjectile& projectile = projectiles[i];
+    const float endTime = projectile.spawnTime + projectile.lifeTime;
+
+    /* Clients hold the fx at the end of its range until the end event arrives.
+    The server already moved the projectile while stepping it. */
+    if (!HasAuthority())
+    {
+      if (projectile.projectileId == INDEX_NONE && currentTime >= endTime)
+      {
+        // No end event comes for a predicted projectile the server never launched
+        EndProjectileAt(i, projectile.location, false);
+        continue;
+      }
+
+      if (currentTime >= endTime + endEventTimeout)
+      {
+        // The end event was dropped
+        EndProjectileAt(i, projectile.location, false);
+        continue;
+      }
+
+      projectile.location = projectile.GetLocationAt(FMath::Min(currentTime, endTime));
+    }
+
+    if (projectile.visual)
+    {
+      projectile.visual->SetWorldLocation(projectile.location);
+    }
+  }
+}
+
+bool ASpellProjectileManager::SweepProjectile(const FSpellProjectile& projectile, const FVector& start, const FVector& end, float& outHitFraction, ABBotCharacter*& outEnemy)
+{
+  outHitFraction = 1.f;
+  outEnemy = nullptr;
+
+  const FVector delta = end - start;
+  if (delta.IsNearlyZero())
+  {
+    return false;
+  }
+
+  APawn* caster = projectile.caster.Get();
+
+  ABattleBotsGameMode* GM = GetWorld()->GetAuthGameMode<ABattleBotsGameMode>();
+  ABBotsSpatialGrid* spatialGrid = GM ? GM->GetSpatialGrid() : nullptr;
+
+  bool bHit = false;
+
+  if (spatialGrid)
+  {
+    // One query around the swept segment, then exact swept sphere vs capsule tests
+    const float halfLength = delta.Size() * 0.5f;
+    stepCandidates.Reset();
+    spatialGrid->QueryRadius(start + delta * 0.5f, halfLength + projectile.radius + characterQueryPadding, stepCandidates);
+
+    for (ABBotCharacter* candidate : stepCandidates)
+    {
+      if (candidate == caster || !candidate->IsAlive() || candidate->IsDying())
+      {
+        continue;
+      }
+
+      float capsuleRadius, capsuleHalfHeight;
+      candidate->GetCapsuleComponent()->GetScaledCapsuleSize(capsuleRadius, capsuleHalfHeight);
+
+      float fraction;
+      if (SweepSphereCapsule(start, delta, projectile.radius, candidate->GetActorLocation(), capsuleRadius, capsuleHalfHeight, fraction)
+        && fraction < outHitFraction
+        && GM->CanTeamsDealDamage(projectile.casterTeamNum, candidate->GetTeamNum()))
+      {
+        // Allies are passed through, same as the spell actors
+        outHitFraction = fraction;
+        outEnemy = candidate;
+        bHit = true;
+      }
+    }
+  }
+
+  // Walls stop the projectile, characters and other spells are not part of the static world
+  FCollisionQueryParams queryParams(FName(TEXT("SpellProjectileSweep")), false, caster);
+  FHitResult worldHit;
+
+  if (GetWorld()->SweepSingleByObjectType(worldHit, start, end, FQuat::Identity, FCollisionObjectQueryParams(ECC_WorldStatic), FCollisionShape::MakeSphere(projectile.radius), queryParams)
+    && worldHit.Time < outHitFraction)
+  {
+    outHitFraction = worldHit.Time;
+    outEnemy = nullptr;
+    bHit = true;
+  }
+
+  return bHit;
+}
+
+bool ASpellProjectileManager::SweepSphereCapsule(const FVector& start, const FVector& delta, float radius, const FVector& capsuleCenter, float capsuleRadius, float capsuleHalfHeight, float& outFraction)
+{
+  // Sweep a point against the capsule grown by the sphere radius
+  const float sweptRadius = radius + capsuleRadius;
+  const float sweptRadiusSquared = sweptRadius * sweptRadius;
+  const float segmentHalfHeight = FMath::Max(capsuleHalfHeight - capsuleRadius, 0.f);
+  const float bottomZ = capsuleCenter.Z - segmentHalfHeight;
+  const float topZ = capsuleCenter.Z + segmentHalfHeight;
+
+  // Already overlapping at the start of the step
+  const float startClosestZ = FMath::Clamp(start.Z, bottomZ, topZ);
+  if (FVector::DistSquaredXY(start, capsuleCenter) + FMath::Square(start.Z - startClosestZ) <= sweptRadiusSquared)
+  {
+    outFraction = 0.f;
+    return true;
+  }
+
+  outFraction = 1.f;
+  bool bHit = false;
+
+  // Side of the capsule, the segment is upright so this is a circle in XY
+  const float a = FMath::Square(delta.X) + FMath::Square(delta.Y);
+  if (a > SMALL_NUMBER)
+  {
+    const float dx = start.X - capsuleCenter.X;
+    const float dy = start.Y - capsuleCenter.Y;
+    const float b = dx * delta.X + dy * delta.Y;
+    const float c = dx * dx + dy * dy - sweptRadiusSquared;
+    const float discriminant = b * b - a * c;
+
+    if (discriminant >= 0.f)
+    {
+      const float t = (-b - FMath::Sqrt(discriminant)) / a;
+      const float z = start.Z + delta.Z * t;
+
+      if (t >= 0.f && t <= outFraction && z >= bottomZ && z <= topZ)
+      {
+        outFraction = t;
+        bHit = true;
+      }
+    }
+  }
+
+  // Caps of the capsule, entering through the flat ends is covered by these spheres
+  const float deltaSquared = delta.SizeSquared();
+  const float capZ[2] = { bottomZ, topZ };
+
+  for (int32 i = 0; i < 2; i++)
+  {
+    const FVector toStart = start - FVector(capsuleCenter.X, capsuleCenter.Y, capZ[i]);
+    const float b = FVector::DotProduct(toStart, delta);
+    const float c = toStart.SizeSquared() - sweptRadiusSquared;
+    const float discriminant = b * b - deltaSquared * c;
+
+    if (discriminant >= 0.f)
+    {
+      const float t = (-b - FMath::Sqrt(discriminant)) / deltaSquared;
+
+      if (t >= 0.f && t <= outFraction)
+      {
+        outFraction = t;
+        bHit = true;
+      }
+    }
+  }
+
+  return bHit;
+}
+
+void ASpellProjectileManager::EndProjectileAt(int32 index, const FVector& endLocation, bool bExploded)
+{
+  const FSpellProjectile& projectile = projectiles[index];
+
+  if (HasAuthority())
+  {
+    // Players that never saw the launch do not need the end
+    for (const TWeakObjectPtr<ABattleBotsPlayerController>& recipient : projectile.recipients)
+    {
+      if (recipient.IsValid())
+      {
+        recipient->ClientEndProjectile(projectile.projectileId, endLocation, bExploded);
+      }
+    }
+  }
+
+  if (bExploded && GetNetMode() != NM_DedicatedServer)
+  {
+    SimulateExplosion(projectile.spellClass, endLocation);
+  }
+
+  if (projectile.visual)
+  {
+    projectile.visual->DestroyComponent();
+  }
+
+  projectiles.RemoveAtSwap(index, 1, false);
+}
+
+int32 ASpellProjectileManager::FindPredictedProjectile(int32 predictionKey) const
+{
+  for (int32 i = 0; i < projectiles.Num(); i++)
+  {
+    if (projectiles[i].projectileId == INDEX_NONE && projectiles[i].predictionKey == predictionKey)
+    {
+      return i;
+    }
+  }
+  return INDEX_NONE;
+}
+
+int32 ASpellProjectileManager::FindProjectile(int32 projectileId) const
+{
+  for (int32 i = 0; i < projectiles.Num(); i++)
+  {
+    if (projectiles[i].projectileId == projectileId)
+    {
+      return i;
+    }
+  }
+  return INDEX_NONE;
+}
+
+void ASpellProjectileManager::ReceiveLaunch(int32 projectileId, const FVector& origin, const FVector& velocity, float radius, float spawnTime, float lifeTime, TSubclassOf<ASpellSystem> spellClass, APawn* caster, int32 predictionKey)
+{
+  // The server shows its own projectiles when it launches them
+  if (HasAuthority() || !spellClass)
+  {
+    return;
+  }
+
+  int32 index = INDEX_NONE;
+
+  if (caster && caster->IsLocallyControlled() && predictionKey != INDEX_NONE)
+  {
+    // Our own cast, the server projectile takes over the predicted one and its fx
+    index = FindPredictedProjectile(predictionKey);
+  }
+
+  if (index == INDEX_NONE)
+  {
+    index = projectiles.Add(FSpellProjectile());
+  }
+
+  // Clients follow the server trajectory from here on
+  FSpellProjectile& projectile = projectiles[index];
+  projectile.projectileId = projectileId;
+  projectile.predictionKey = predictionKey;
+  projectile.origin = origin;
+  projectile.velocity = velocity;
+  projectile.radius = radius;
+  projectile.spawnTime = spawnTime;
+  projectile.lifeTime = lifeTime;
+  projectile.spellClass = spellClass;
+  projectile.caster = caster;
+  projectile.location = projectile.GetLocationAt(FMath::Min(GetServerTime(), spawnTime + lifeTime));
+
+  CreateVisual(index);
+}
+
+void ASpellProjectileManager::CreateVisual(int32 index)
+{
+  FSpellProjectile& projectile = projectiles[index];
+
+  if (projectile.visual || !projectile.spellClass)
+  {
+    return;
+  }
+
+  const ASpellSystem* spellDefaults = projectile.spellClass->GetDefaultObject<ASpellSystem>();
+
+  if (spellDefaults->particleComp && spellDefaults->particleComp->Template)
+  {
+    projectile.visual = UGameplayStatics::SpawnEmitterAtLocation(this, spellDefaults->particleComp->Template, projectile.location, projectile.velocity.Rotation(), false);
+  }
+}
+
+void ASpellProjectileManager::ReceiveEnd(int32 projectileId, const FVector& endLocation, bool bExploded)
+{
+  // The server already ended the projectile before sending the event
+  if (HasAuthority())
+  {
+    return;
+  }
+
+  const int32 index = FindProjectile(projectileId);
+  if (index != INDEX_NONE)
+  {
+    EndProjectileAt(index, endLocation, bExploded);
+  }
+}
+
+void ASpellProjectileManager::SimulateExplosion(TSubclassOf<ASpellSystem> spellClass, const FVector& location)
+{
+  if (!spellClass)
+  {
+    return;
+  }
+
+  const ASpellSystem* spellDefaults = spellClass->GetDefaultObject<ASpellSystem>();
+
+  // Play sound and particle effect on contact
+  if (spellDefaults->explosionSound) {
+    UGameplayStatics::PlaySoundAtLocation(this, spellDefaults->explosionSound, location);
+  }
+  if (spellDefaults->spellFX) {
+    UGameplayStatics::SpawnEmitterAtLocation(this, spellDefaults->spellFX, location);
+  }
+}
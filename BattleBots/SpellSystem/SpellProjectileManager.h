@@ -0,0 +1,171 @@
+// Copyright 2015 VMR Games, Inc. All Rights Reserved.
+
+#pragma once
+
+#include "Interfaces/BBotsResetInterface.h"
+#include "GameFramework/Info.h"
+#include "SpellProjectileManager.generated.h"
+
+class ASpellSystem;
+class ABBotCharacter;
+class ABattleBotsPlayerController;
+
+// A projectile simulated by the projectile manager instead of a spell actor
+USTRUCT()
+struct FSpellProjectile
+{
+  GENERATED_USTRUCT_BODY()
+
+  // Matches the projectile between the server and the clients, INDEX_NONE for predicted projectiles
+  int32 projectileId;
+
+  // The prediction key of the cast, matches a client predicted projectile with the server one
+  int32 predictionKey;
+
+  FVector origin;
+  FVector velocity;
+  float radius;
+
+  // Server world time of the launch, the projectile is at origin + velocity * (time - spawnTime)
+  float spawnTime;
+  float lifeTime;
+
+  // The location at the end of the last step
+  FVector location;
+
+  // The spell class the projectile was cast from, used for its fx/sound
+  UPROPERTY()
+  TSubclassOf<ASpellSystem> spellClass;
+
+  // Server only: the spell bar spell that deals the damage on hit
+  TWeakObjectPtr<ASpellSystem> spellManager;
+
+  // The caster is never hit by its own projectile
+  TWeakObjectPtr<APawn> caster;
+
+  // Server only: the team of the caster at launch, resolves enemies without player state lookups
+  uint8 casterTeamNum;
+
+  // Server only: the remote players the launch was sent to, the end goes to the same players
+  TArray<TWeakObjectPtr<ABattleBotsPlayerController>> recipients;
+
+  // Client only: the projectile fx
+  UPROPERTY()
+  UParticleSystemComponent* visual;
+
+  FSpellProjectile()
+    : projectileId(INDEX_NONE), predictionKey(INDEX_NONE), origin(FVector::ZeroVector), velocity(FVector::ZeroVector), radius(0.f),
+    spawnTime(0.f), lifeTime(0.f), location(FVector::ZeroVector), spellClass(nullptr), casterTeamNum(255), visual(nullptr)
+  {}
+
+  FORCEINLINE FVector GetLocationAt(float time) const { return origin + velocity * (time - spawnTime); }
+};
+
+/**
+ * ASpellProjectileManager moves every non-piercing spell projectile in one
+ * batched step, instead of each cast being a replicated actor with its own
+ * projectile movement. The server sweeps the projectiles against the
+ * characters of the spatial grid and the static world and deals the hits.
+ * Clients receive one spawn and one end event per projectile and move the
+ * fx along the same straight line from the replicated server time. The
+ * events only go to the players the projectile is relevant to, with the
+ * distance and team rules of the spell actors, and are sent unreliably
+ * through their player controllers since they are purely cosmetic.
+ * The manager is spawned by the game mode and replicated to every client.
+ */
+UCLASS()
+class BATTLEBOTS_API ASpellProjectileManager : public AInfo, public IBBotsResetInterface
+{
+  GENERATED_BODY()
+
+public:
+  ASpellProjectileManager();
+
+  // Steps all projectiles, hit tests on the server and moves the fx on clients
+  virtual void Tick(float DeltaSeconds) override;
+
+  // Registers with the round reset
+  virtual void BeginPlay() override;
+
+  virtual void EndPlay(const EEndPlayReason::Type EndPlayReason) override;
+
+  // Interface call on match reset, ends all projectiles without exploding them
+  virtual void Reset_Implementation() override;
+
+  // Launches a projectile of spell from location along rotation. Server only.
+  void LaunchProjectile(ASpellSystem* spell, const FVector& location, const FRotator& rotation, int32 predictionKey = INDEX_NONE);
+
+  /* Shows a cosmetic projectile on the casting client ahead of the server. It is replaced
+  by the server projectile with the same prediction key, or fades out at the end of its range. */
+  void LaunchPredictedProjectile(ASpellSystem* spell, const FVector& location, const FRotator& rotation, int32 predictionKey);
+
+  // Removes the predicted projectile of a cast the server rejected
+  void CancelPredictedProjectile(int32 predictionKey);
+
+  // Creates the fx of a projectile launched by the server. Client only, see ABattleBotsPlayerController::ClientLaunchProjectile.
+  void ReceiveLaunch(int32 projectileId, const FVector& origin, const FVector& velocity, float radius, float spawnTime, float lifeTime, TSubclassOf<ASpellSystem> spellClass, APawn* caster, int32 predictionKey);
+
+  // Removes the fx of a projectile, and plays the explosion if it hit something. Client only.
+  void ReceiveEnd(int32 projectileId, const FVector& endLocation, bool bExploded);
+
+  // Returns the number of live projectiles
+  FORCEINLINE int32 GetNumProjectiles() const { return projectiles.Num(); }
+
+protected:
+  // Added to the swept segment when querying the spatial grid, should cover the widest character capsule
+  UPROPERTY(EditDefaultsOnly, Category = "Projectile Config")
+  float characterQueryPadding;
+
+  // Seconds a client keeps a projectile at the end of its range waiting for the unreliable end event
+  UPROPERTY(EditDefaultsOnly, Category = "Projectile Config")
+  float endEventTimeout;
+
+private:
+  UPROPERTY()
+  TArray<FSpellProjectile> projectiles;
+
+  // The id of the next launched projectile
+  int32 nextProjectileId;
+
+  // Characters near the current projectile, reused between projectiles to avoid allocations
+  TArray<ABBotCharacter*> stepCandidates;
+
+  // Returns the replicated server world time
+  float GetServerTime() const;
+
+  // Sweeps and moves every projectile, dealing the hits
+  void StepProjectilesServer(float currentTime);
+
+  // Moves the projectile fx
+  void StepProjectilesClient(float currentTime);
+
+  /* Sweeps the projectile from start to end. Returns true and the hit fraction
+  if it hit the world or an enemy, enemy is null for world hits */
+  bool SweepProjectile(const FSpellProjectile& projectile, const FVector& start, const FVector& end, float& outHitFraction, ABBotCharacter*& outEnemy);
+
+  /* Sweeps a sphere from start along delta against an upright capsule.
+  Returns true and the first hit fraction if they touch within the step. */
+  static bool SweepSphereCapsule(const FVector& start, const FVector& delta, float radius, const FVector& capsuleCenter, float capsuleRadius, float capsuleHalfHeight, float& outFraction);
+
+  // Removes the projectile at index and plays its explosion if bExploded. The server forwards the end to the clients.
+  void EndProjectileAt(int32 index, const FVector& endLocation, bool bExploded);
+
+  // Returns the index of the projectile with projectileId, INDEX_NONE if it is not live
+  int32 FindProjectile(int32 projectileId) const;
+
+  // Returns the index of the predicted projectile with predictionKey, INDEX_NONE if it is not live
+  int32 FindPredictedProjectile(int32 predictionKey) const;
+
+  // Spawns the fx of the projectile at index
+  void CreateVisual(int32 index);
+
+  // Sends the launch of the projectile at index to the remote players it is relevant to
+  void SendLaunch(int32 index);
+
+  /* Same rules as ASpellSystem::IsNetRelevantFor: always relevant to the caster, to allies within
+  allyNetCullDistanceSquared and to enemies within NetCullDistanceSquared of the projectile path. */
+  bool IsRelevantTo(const FSpellProjectile& projectile, const ABattleBotsPlayerController* PC) const;
+
+  // Plays the explosion fx/sound of the spell class
+  void SimulateExplosion(TSubclassOf<ASpellSystem> spellClass, const FVector& location);
+};
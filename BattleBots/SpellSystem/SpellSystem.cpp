@@ -3,6 +3,11 @@
 #include "BattleBots.h"
 #include "BattleBotsGameMode.h"
 #include "Character/BBotCharacter.h"
+#include "Online/BBotsPlayerState.h"
+#include "SpellSystem/SpellPool.h"
+#include "SpellSystem/SpellAOEScheduler.h"
+#include "SpellSystem/SpellProjectileManager.h"
+#include "Combat/BBotsCombatLog.h"
 #include "SpellSystem.h"
 
 
@@ -15,7 +20,11 @@ ASpellSystem::ASpellSystem()
   //Must be true for an Actor to replicate anything
   bReplicates = true;
   bReplicateMovement = true;
-  bAlwaysRelevant = true;
+
+  // Relevancy is distance and team based, see IsNetRelevantFor
+  bAlwaysRelevant = false;
+  NetCullDistanceSquared = FMath::Square(5000.f);
+  allyNetCullDistanceSquared = FMath::Square(10000.f);
 
   collisionComp = CreateDefaultSubobject<USphereComponent>(TEXT("CollisonComp"));
   collisionComp->OnComponentBeginOverlap.AddDynamic(this, &ASpellSystem::OnCollisionOverlapBegin);
@@ -37,6 +46,13 @@ ASpellSystem::ASpellSystem()
 
   projectileMovementComp = CreateDefaultSubobject<UProjectileMovementComponent>(TEXT("ProjectileMovementComp"));
   projectileMovementComp->ProjectileGravityScale = 0;
+
+  spellPool = nullptr;
+  bPooledSpellActive = false;
+  bSpellBarManager = false;
+  castPredictionKey = INDEX_NONE;
+  casterTeamNum = 255;
+  bAOEVolumeRegistered = false;
 }
 
 // Called after all components have been initialized with default values
@@ -48,16 +64,18 @@ void ASpellSystem::PostInitializeComponents()
   // Initialize the spell speed, by changing velocity to direction. Directly changing PMC->initialSpeed is a known engine bug.
   //projectileMovementComp->Velocity = projectileMovementComp->Velocity.GetSafeNormal() * spellDataInfo.spellSpeed;
 
+  // The movement component already rotated the initial velocity, keep it in local space so pooled spells can restart it
+  initialLocalVelocity = GetActorRotation().UnrotateVector(projectileMovementComp->Velocity);
+
   if (HasAuthority())
   {
     // Sets the default damage event type
     defaultDamageEvent.DamageTypeClass = UDamageType::StaticClass();
-
-    SetDamageToDeal(spellDataInfo.spellDamage);
-
-    // Sets the spell dps (Used for AOETicks) - Possible bug if DerivedClasses call Super::PostInitializeComponents() last
-    damagePerSecond = GetDamageToDeal() / spellDataInfo.spellDuration;
-    GEngine->AddOnScreenDebugMessage(-1, 4.f, FColor::Yellow, FString::FromInt(damagePerSecond * 100));
+  }
+  else
+  {
+    // Hits are resolved on the server, client proxies never generate overlaps
+    collisionComp->bGenerateOverlapEvents = false;
   }
 }
 
@@ -67,18 +85,166 @@ void ASpellSystem::BeginPlay()
 {
   Super::BeginPlay();
 
+  RegisterForReset(this, EResetPriority::EWorld);
+}
+
+void ASpellSystem::EndPlay(const EEndPlayReason::Type EndPlayReason)
+{
+  UnregisterForReset(this);
+
+  Super::EndPlay(EndPlayReason);
+}
+
+void ASpellSystem::InitSpellDamage()
+{
+  SetDamageToDeal(spellDataInfo.spellDamage);
+
+  // Sets the spell dps (Used for AOETicks) - Derived classes must call Super::InitSpellDamage() first
+  damagePerSecond = GetDamageToDeal() / spellDataInfo.spellDuration;
+}
+
+void ASpellSystem::InitSpellBarManager()
+{
+  bSpellBarManager = true;
+
+  // Only the owner needs the cool down and damage of its spell bar
+  bOnlyRelevantToOwner = true;
+  bReplicateMovement = false;
+
+  // Managers never move, they only wake up when a cast changes their replicated state
+  SetNetDormancy(DORM_DormantAll);
+
+  SetActorEnableCollision(false);
+  SetActorHiddenInGame(true);
+}
+
+bool ASpellSystem::IsNetRelevantFor(const AActor* RealViewer, const AActor* ViewTarget, const FVector& SrcLocation) const
+{
+  if (bSpellBarManager || !bPooledSpellActive)
+  {
+    // Hidden spells are irrelevant by default, managers are owner only
+    return Super::IsNetRelevantFor(RealViewer, ViewTarget, SrcLocation);
+  }
+
+  const APawn* caster = Instigator;
+  if (caster && (ViewTarget == caster || RealViewer == caster->Controller))
+  {
+    return true;
+  }
+
+  const float distSquared = (GetActorLocation() - SrcLocation).SizeSquared();
+
+  const APlayerController* viewerPC = Cast<APlayerController>(RealViewer);
+  const ABBotsPlayerState* viewerPS = viewerPC ? Cast<ABBotsPlayerState>(viewerPC->PlayerState) : nullptr;
+  const ABBotsPlayerState* casterPS = caster ? Cast<ABBotsPlayerState>(caster->PlayerState) : nullptr;
+
+  if (viewerPS && casterPS && viewerPS->GetTeamNum() == casterPS->GetTeamNum())
+  {
+    return distSquared < allyNetCullDistanceSquared;
+  }
+
+  return distSquared < NetCullDistanceSquared;
+}
+
+void ASpellSystem::ActivateSpell(const FVector& location, const FRotator& rotation)
+{
+  bPooledSpellActive = true;
+
+  // Pooled spells sleep between casts, wake up before the activation is multicast
+  SetNetDormancy(DORM_Awake);
+
+  SetActorLocationAndRotation(location, rotation);
+  OverlappedActors.Empty();
+
   if (HasAuthority())
   {
     if (!GetSpellCaster()) {
       // Check if spell caster is set under server
       GEngine->AddOnScreenDebugMessage(-1, 4.f, FColor::Yellow, TEXT("Spell caster is NULL"));
     }
+
+    // The caster may have changed since the last time this spell was cast
+    InitSpellDamage();
+    casterTeamNum = GetSpellCaster() ? GetSpellCaster()->GetTeamNum() : 255;
+  }
+
+  SimulateActivation();
+}
+
+void ASpellSystem::DeactivateSpell()
+{
+  bPooledSpellActive = false;
+
+  // Clears the destruction and release timers bound to this spell
+  GetWorldTimerManager().ClearAllTimersForObject(this);
+  UnregisterAOEVolume();
+
+  OverlappedActors.Empty();
+
+  // Sent before the channel goes dormant, the clients would keep the spell flying otherwise
+  SimulateDeactivation();
+
+  if (HasAuthority())
+  {
+    // The channel sends the hidden state one last time, then sleeps until the spell is cast again
+    SetNetDormancy(DORM_DormantAll);
+  }
+}
+
+void ASpellSystem::ReturnToPool()
+{
+  if (spellPool)
+  {
+    spellPool->ReleaseSpell(this);
+  }
+  else if (!IsPendingKill())
+  {
+    Destroy();
   }
 }
 
+void ASpellSystem::SimulateActivation_Implementation()
+{
+  // Multicast function that runs on both the client and the server
+  SetActorEnableCollision(true);
+  SetActorHiddenInGame(false);
+
+  RestartProjectileMovement();
+
+  if (particleComp->Template)
+  {
+    particleComp->ActivateSystem(true);
+  }
+}
+
+void ASpellSystem::SimulateDeactivation_Implementation()
+{
+  // Multicast function that runs on both the client and the server
+  SetActorEnableCollision(false);
+  SetActorHiddenInGame(true);
+
+  projectileMovementComp->StopMovementImmediately();
+  projectileMovementComp->Deactivate();
+  particleComp->DeactivateSystem();
+}
+
+void ASpellSystem::RestartProjectileMovement()
+{
+  projectileMovementComp->SetUpdatedComponent(RootComponent);
+  projectileMovementComp->SetVelocityInLocalSpace(initialLocalVelocity);
+  projectileMovementComp->Activate(true);
+}
+
 // Called when a spell collides with a player
 void ASpellSystem::OnCollisionOverlapBegin(class AActor* OtherActor, class UPrimitiveComponent* OtherComp, int32 OtherBodyIndex, bool bFromSweep, const FHitResult& SweepResult)
 {
+  BBOTS_SCOPE_CYCLE_COUNTER(SpellOverlap);
+
+  if (!HasAuthority())
+  {
+    return;
+  }
+
   ABBotCharacter* enemyPlayer = Cast<ABBotCharacter>(OtherActor);
   //@todo: Set spells to ignore each other in editor
   ASpellSystem* otherSpell = Cast<ASpellSystem>(OtherActor);
@@ -108,47 +274,54 @@ void ASpellSystem::OnCollisionOverlapEnd(class AActor* OtherActor, class UPrimit
   }
 }
 
-bool ASpellSystem::IsEnemy(ABBotCharacter* possibleEnemy)
+bool ASpellSystem::IsEnemy(ABBotCharacter* possibleEnemy) const
 {
-  if (Role < ROLE_Authority)
-  {
-    ServerIsEnemy(possibleEnemy);
-  }
-  else
+  if (!HasAuthority() || !possibleEnemy || possibleEnemy == Instigator || !possibleEnemy->IsAlive())
   {
-    return (possibleEnemy
-         && possibleEnemy != GetSpellCaster()
-         && possibleEnemy->CanRecieveDamage(Instigator->Controller, GetDamageType()));
+    return false;
   }
-  return false;
-}
 
-void ASpellSystem::ServerIsEnemy_Implementation(ABBotCharacter* possibleEnemy)
-{
-  IsEnemy(possibleEnemy);
+  // The game mode's team relation, the same rule CanRecieveDamage applies through CanDealDamage
+  ABattleBotsGameMode* GM = GetWorld()->GetAuthGameMode<ABattleBotsGameMode>();
+  return GM && GM->CanTeamsDealDamage(casterTeamNum, possibleEnemy->GetTeamNum());
 }
 
-bool ASpellSystem::ServerIsEnemy_Validate(ABBotCharacter* possibleEnemy)
+// Deal basic projectile functionality and damage
+void ASpellSystem::DealDamage(ABBotCharacter* enemyPlayer)
 {
-  return true;
+  if (HasAuthority())
+  {
+    ApplySpellHit(enemyPlayer, GetActorLocation());
+    DestroySpell();
+  }
 }
 
-// Deal basic projectile functionality and damage
-void ASpellSystem::DealDamage(ABBotCharacter* enemyPlayer)
+void ASpellSystem::ApplySpellHit(ABBotCharacter* enemyPlayer, const FVector& hitLocation)
 {
   if (HasAuthority())
   {
     if (spellDataInfo.bKnockBack)
     {
-      enemyPlayer->KnockbackPlayer(GetActorLocation());
+      enemyPlayer->KnockbackPlayer(hitLocation);
+    }
+
+    ABattleBotsGameMode* GM = GetWorld()->GetAuthGameMode<ABattleBotsGameMode>();
+    if (GM && GM->GetCombatLog())
+    {
+      GM->GetCombatLog()->LogHit(GetSpellCaster(), enemyPlayer, GetClass());
     }
 
     UGameplayStatics::ApplyDamage(enemyPlayer, GetDamageToDeal(), GetInstigatorController(), this, GetDamageEvent().DamageTypeClass);
     DealUniqueSpellFunctionality(enemyPlayer);
-    DestroySpell();
   }
 }
 
+bool ASpellSystem::IsBatchedProjectile() const
+{
+  // Spell actors by default, projectile spells opt in
+  return false;
+}
+
 void ASpellSystem::DealUniqueSpellFunctionality(ABBotCharacter* enemyPlayer)
 {
   // Must be overriden -  Ignite , Slow, Heal, KnockBack,etc
@@ -164,10 +337,27 @@ float ASpellSystem::GetCastTime() const
   return spellDataInfo.castTime;
 }
 
-// No processing required for default damage types
 float ASpellSystem::ProcessElementalDmg(float initialDamage)
 {
-  return initialDamage;
+  return BBotCombat::ApplyDamageModifier(initialDamage, GetCasterDamageModifier());
+}
+
+float ASpellSystem::GetCasterDamageModifier()
+{
+  const EDamageElement::Type element = UBBotDmgType::GetDamageElement(GetDamageType());
+
+  // No processing required for default damage types
+  if (element == EDamageElement::EMax) {
+    return 0.f;
+  }
+
+  if (GetSpellCaster()) {
+    return GetSpellCaster()->GetDamageModifier(element);
+  }
+  else {
+    GEngine->AddOnScreenDebugMessage(-1, 2.f, FColor::Red, TEXT("Caster is null - ") + GetNameSafe(this));
+    return 0.f;
+  }
 }
 
 FVector ASpellSystem::GetSpellSpawnLocation()
@@ -175,22 +365,43 @@ FVector ASpellSystem::GetSpellSpawnLocation()
   return GetSpellCaster()->GetActorLocation();
 }
 
-void ASpellSystem::SpawnSpell(TSubclassOf<ASpellSystem> tempSpell)
+bool ASpellSystem::SpawnSpell(TSubclassOf<ASpellSystem> tempSpell)
 {
   // Check to see if our spell object is valid and not deleted by GC
   if (this->IsValidLowLevel()) {
 
     if (HasAuthority()) {
 
-      UWorld* const World = GetWorld();
-      float currentTime = World ? World->GetTimeSeconds() : 0.1f;
-      if (CDHelper < currentTime) {
+      const float currentTime = GetServerTime();
+      if (BBotCombat::IsCooldownReady(CDHelper, currentTime)) {
         // Check if the cool down timer is up before casting
         SpawnSpell_Internal(tempSpell);
-        CDHelper = currentTime + spellDataInfo.coolDown;
+        BBotCombat::TriggerCooldown(CDHelper, currentTime, spellDataInfo.coolDown);
+
+        // The cool down and damage changed, send them to the owner of the dormant manager
+        FlushNetDormancy();
+        return true;
       }
     }
   }
+  return false;
+}
+
+BBotCombat::FPredictedCooldown ASpellSystem::PredictCooldown()
+{
+  return BBotCombat::PredictCooldown(CDHelper, GetServerTime(), spellDataInfo.coolDown);
+}
+
+float ASpellSystem::GetServerTime() const
+{
+  UWorld* const World = GetWorld();
+  if (!World)
+  {
+    return 0.f;
+  }
+
+  AGameState* const GS = World->GameState;
+  return GS ? GS->GetServerWorldTimeSeconds() : World->GetTimeSeconds();
 }
 
 void ASpellSystem::SpawnSpell_Internal(TSubclassOf<ASpellSystem> tempSpell)
@@ -198,19 +409,51 @@ void ASpellSystem::SpawnSpell_Internal(TSubclassOf<ASpellSystem> tempSpell)
   if (HasAuthority())
   {
     if (GetSpellCaster()) {
-      FActorSpawnParameters spawnInfo;
-      spawnInfo.Owner = GetOwner();
-      spawnInfo.Instigator = Instigator;
-      spawnInfo.bNoCollisionFail = true;
-
-      // Spawn the spell into the world
-      spellSpawner = GetWorld()->SpawnActor<ASpellSystem>(tempSpell,
-                                                          GetSpellSpawnLocation(),
-                                                          GetSpellCaster()->GetActorRotation(),
-                                                          spawnInfo);
-
-      // Process spell destruction timers
-      ProcessSpellTimers();
+      ABattleBotsGameMode* GM = GetWorld()->GetAuthGameMode<ABattleBotsGameMode>();
+      ASpellProjectileManager* projectileManager = GM ? GM->GetProjectileManager() : nullptr;
+
+      if (projectileManager && IsBatchedProjectile())
+      {
+        // Simulate the cast as a plain projectile, this spell bar spell deals its hits
+        spellSpawner = nullptr;
+        projectileManager->LaunchProjectile(this, GetSpellSpawnLocation(), GetSpellCaster()->GetActorRotation(), castPredictionKey);
+        return;
+      }
+
+      ASpellPool* pool = GM ? GM->GetSpellPool() : nullptr;
+
+      if (pool)
+      {
+        // Activate a pooled spell instead of spawning a new actor
+        spellSpawner = pool->AcquireSpell(tempSpell,
+                                          GetSpellSpawnLocation(),
+                                          GetSpellCaster()->GetActorRotation(),
+                                          GetOwner(),
+                                          Instigator);
+      }
+      else
+      {
+        FActorSpawnParameters spawnInfo;
+        spawnInfo.Owner = GetOwner();
+        spawnInfo.Instigator = Instigator;
+        spawnInfo.bNoCollisionFail = true;
+
+        // Spawn the spell into the world
+        spellSpawner = GetWorld()->SpawnActor<ASpellSystem>(tempSpell,
+                                                            GetSpellSpawnLocation(),
+                                                            GetSpellCaster()->GetActorRotation(),
+                                                            spawnInfo);
+        if (spellSpawner)
+        {
+          spellSpawner->ActivateSpell(spellSpawner->GetActorLocation(), spellSpawner->GetActorRotation());
+        }
+      }
+
+      if (spellSpawner)
+      {
+        // Process spell destruction timers
+        ProcessSpellTimers();
+      }
     }
   }
 }
@@ -222,6 +465,7 @@ void ASpellSystem::ProcessSpellTimers()
   * A new handle must be created every time to prevent
   * endless timer reset with new spell spawns */
   FTimerHandle SpellDestructionHandle;
+  FTimerHandle SpellReleaseHandle;
 
   // Prevents double calls of Simulate explosion from the initial timer
   if (spellDataInfo.bIsPiercing)
@@ -229,8 +473,9 @@ void ASpellSystem::ProcessSpellTimers()
     // If piercing then simulate explosion after its duration is up.
     GetWorldTimerManager().SetTimer(SpellDestructionHandle, spellSpawner, &ASpellSystem::SimulateExplosion, spellDataInfo.spellDuration, false);
   }
-  // Destroy the spell after its duration is up
-  spellSpawner->SetLifeSpan(GetFunctionalityDuration() + spellDataInfo.spellDuration);
+  /* Return the spell to the pool after its duration is up. The timer is bound to the
+  spawned spell, so it gets cleared if the spell is released early. */
+  GetWorldTimerManager().SetTimer(SpellReleaseHandle, spellSpawner, &ASpellSystem::ReturnToPool, GetFunctionalityDuration() + spellDataInfo.spellDuration, false);
 }
 
 FDamageEvent& ASpellSystem::GetDamageEvent()
@@ -243,6 +488,12 @@ float ASpellSystem::GetFunctionalityDuration()
   return 0.1;
 }
 
+AStatusEffectManager* ASpellSystem::GetStatusEffectManager() const
+{
+  ABattleBotsGameMode* GM = GetWorld()->GetAuthGameMode<ABattleBotsGameMode>();
+  return GM ? GM->GetStatusEffectManager() : nullptr;
+}
+
 void ASpellSystem::DestroySpell()
 {
   if (HasAuthority())
@@ -267,6 +518,14 @@ void ASpellSystem::SimulateExplosion_Implementation()
   if (spellFX) {
     UGameplayStatics::SpawnEmitterAtLocation(this, spellFX, GetActorLocation(), GetActorRotation());
   }
+
+  if (HasAuthority())
+  {
+    /* The spell is hidden, return it to the pool once the explosion has played out.
+    A new handle is used to keep the destruction timer intact. */
+    FTimerHandle SpellReleaseHandle;
+    GetWorldTimerManager().SetTimer(SpellReleaseHandle, this, &ASpellSystem::ReturnToPool, FMath::Max(GetFunctionalityDuration(), 0.1f), false);
+  }
 }
 
 float ASpellSystem::GetPreProcessedDotDamage()
@@ -274,6 +533,11 @@ float ASpellSystem::GetPreProcessedDotDamage()
   return spellDataInfo.spellDamage;
 }
 
+float ASpellSystem::GetDotDamage(float damageScale)
+{
+  return BBotCombat::ScaleDotDamage(ProcessElementalDmg(GetPreProcessedDotDamage()), damageScale);
+}
+
 float ASpellSystem::GetDamageToDeal()
 {
   return damageToDeal;
@@ -295,29 +559,32 @@ void ASpellSystem::GetLifetimeReplicatedProps(TArray<FLifetimeProperty>& OutLife
   DOREPLIFETIME_CONDITION(ASpellSystem, CDHelper, COND_OwnerOnly);
 }
 
-void ASpellSystem::AOETick()
+void ASpellSystem::RegisterAOEVolume(float tickInterval)
 {
   if (HasAuthority())
   {
-    // No point in getting all overlapping actors if our initial collision has not picked up anything
-    if (OverlappedActors.Num() == 0)
-      return;
+    ABattleBotsGameMode* GM = GetWorld()->GetAuthGameMode<ABattleBotsGameMode>();
+    ASpellAOEScheduler* scheduler = GM ? GM->GetAOEScheduler() : nullptr;
 
-    // Deal damage to the overlapped actors
-    for (int i = 0; i < OverlappedActors.Num(); i++)
+    if (scheduler && tickInterval > 0.f)
     {
-      //The enemy will never be the spellcaster, because we already did that check on collision overlap.
-      ABBotCharacter* enemy = Cast<ABBotCharacter>(OverlappedActors[i]);
+      // The scheduler runs at its own fixed rate, so hand it the per second damage
+      scheduler->RegisterVolume(this, GetActorLocation(), collisionComp->GetScaledSphereRadius(), GetDamageToDeal() / tickInterval, spellDataInfo.spellDuration);
+      bAOEVolumeRegistered = true;
+    }
+  }
+}
 
-      // Only apply damage if the actors capsule component is overlapping
-      if (enemy && collisionComp->IsOverlappingComponent(enemy->GetCapsuleComponent()))
-      {
-        /* Because we are checking collision and dealing damage in tick, we
-        have to call DealDamage to ensure the enemy players get ignited. */
-        DealDamage(enemy);
+void ASpellSystem::UnregisterAOEVolume()
+{
+  if (bAOEVolumeRegistered)
+  {
+    bAOEVolumeRegistered = false;
 
-        //@TODO: ApplyRadialDamage is an alternative method, but would have to rewire dealdamage
-      }
+    ABattleBotsGameMode* GM = GetWorld()->GetAuthGameMode<ABattleBotsGameMode>();
+    if (GM && GM->GetAOEScheduler())
+    {
+      GM->GetAOEScheduler()->UnregisterVolume(this);
     }
   }
 }
@@ -333,18 +600,5 @@ void ASpellSystem::Reset()
 void ASpellSystem::Reset_Implementation()
 {
   Reset();
-  Destroy();
-}
-
-void ASpellSystem::ClearUniqueTimers()
-{
-  // Must be overriden
+  ReturnToPool();
 }
-
-
-
-
-
-
-
-
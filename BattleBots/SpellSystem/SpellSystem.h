@@ -8,6 +8,7 @@
 #include "SpellSystem.generated.h"
 
 //class ABBotCharacter;
+class ASpellPool;
 
 USTRUCT()
 struct FSpellData{
@@ -49,6 +50,12 @@ UCLASS()
 class BATTLEBOTS_API ASpellSystem : public AActor, public IBBotsResetInterface
 {
 	GENERATED_BODY()
+
+  // The AOE scheduler deals the volume damage and unique functionality on behalf of AOE spells
+  friend class ASpellAOEScheduler;
+
+  // The projectile manager moves batched projectiles and deals their hits on behalf of the spell bar spells
+  friend class ASpellProjectileManager;
 	
 public:	
 	// Sets default values for this actor's properties
@@ -60,9 +67,16 @@ public:
 	// Called when the game starts or when spawned
 	virtual void BeginPlay() override;
 
+  // Unregisters from the round reset
+  virtual void EndPlay(const EEndPlayReason::Type EndPlayReason) override;
+
   /** Hides actor and disable collision */
   virtual void Reset() override;
 
+  /* Live spells are always relevant to their caster, to allies within allyNetCullDistanceSquared
+  and to enemies within NetCullDistanceSquared. Idle spells fall back to the default rules. */
+  virtual bool IsNetRelevantFor(const AActor* RealViewer, const AActor* ViewTarget, const FVector& SrcLocation) const override;
+
   // Interface call on match reset.
   virtual void Reset_Implementation() override;
 
@@ -116,16 +130,49 @@ public:
   UFUNCTION(BlueprintCallable, Category = "SpellSystem")
   float GetCastTime() const;
 
-  // Clears the current unique timers such as ignite, slow, etc.
-  virtual void ClearUniqueTimers();
-
   // Can the player cast the spell while moving?
   FORCEINLINE bool CastableWhileMoving() const { return spellDataInfo.bCastableWhileMoving; }
-  FORCEINLINE bool SpellOnCD() const { return !(CDHelper < GetWorld()->GetTimeSeconds()); }
+  FORCEINLINE bool SpellOnCD() const { return !BBotCombat::IsCooldownReady(CDHelper, GetServerTime()); }
+
+  // Returns the server world time, the replicated cool down is set in it on the server and checked in it on the owner
+  float GetServerTime() const;
+
+  /** Activates a pooled spell at location. Called by the spell pool when the spell is cast. */
+  virtual void ActivateSpell(const FVector& location, const FRotator& rotation);
+
+  /** Hides the spell, stops its movement and clears its timers. Called by the spell pool on release. */
+  virtual void DeactivateSpell();
+
+  // Returns the spell to its pool, or destroys it if the spell was not spawned by a pool
+  UFUNCTION()
+  void ReturnToPool();
 
-  /** Spawns a spell into the world. Manages internal spell cool down.*/
+  // Sets the pool that owns this spell
+  FORCEINLINE void SetSpellPool(ASpellPool* newPool) { spellPool = newPool; }
+
+  /* Turns the spell into a hidden spell bar manager. Managers only replicate to their owner,
+  and stay dormant between casts. Called by the character when the spell is added to its spell bar. */
+  void InitSpellBarManager();
+
+  // Is the spell currently cast and active in the world?
+  FORCEINLINE bool IsPooledSpellActive() const { return bPooledSpellActive; }
+
+  /** Spawns a spell into the world. Manages internal spell cool down, returns false if the spell did not go out.*/
   UFUNCTION(BlueprintCallable, Category = "SpellSystem")
-  void SpawnSpell(TSubclassOf<ASpellSystem> tempSpell);
+  bool SpawnSpell(TSubclassOf<ASpellSystem> tempSpell);
+
+  /* Returns true if casts of this spell are simulated by the projectile manager
+  instead of spawning a spell actor. Only straight, non-piercing projectiles qualify. */
+  virtual bool IsBatchedProjectile() const;
+
+  // Sets the prediction key of the next cast, so the caster can match its predicted projectile
+  FORCEINLINE void SetCastPredictionKey(int32 newKey) { castPredictionKey = newKey; }
+
+  // Starts the cool down on the owning client ahead of the server. Returns what a rollback needs.
+  BBotCombat::FPredictedCooldown PredictCooldown();
+
+  // Restores the cool down of a predicted cast the server rejected, unless the server replicated a newer one
+  FORCEINLINE void RollbackCooldown(const BBotCombat::FPredictedCooldown& prediction) { BBotCombat::RollbackCooldown(CDHelper, prediction); }
 
   
   virtual FVector GetSpellSpawnLocation();
@@ -167,28 +214,47 @@ protected:
   // Returns the spawned spell with the appropriate location. AOE spells must override this method and use HITLOC instead of GetSpellCaster()->GetActorLocation()
   /* virtual ASpellSystem* GetSpawnedSpell(TSubclassOf<ASpellSystem> tempSpell, FActorSpawnParameters spawnParams, const FVector& HitLocation);*/
 
+  /* Initializes the caster dependent spell damage. Pooled spells change casters,
+  so this runs every time the spell is activated instead of on spawn. */
+  virtual void InitSpellDamage();
+
   // Processes final elemental damage post item dmg modifiers
   virtual float ProcessElementalDmg(float initialDamage);
 
-  // Short-circuits if the overlapped pawn is an enemy, to prevent unnecessary computations
-  bool IsEnemy(ABBotCharacter* possibleEnemy);
+  // The caster's bonus damage for the element of this spell, 0 for damage types without an element
+  float GetCasterDamageModifier();
+
+  /* Returns true if the overlapped pawn is an enemy of the caster. Server only, client
+  proxies never generate overlaps. Uses the caster team cached when the spell was cast. */
+  bool IsEnemy(ABBotCharacter* possibleEnemy) const;
 
   // Deals damage to the actor and manages spell death. Override spell functionality, ex: Ignite, slow, etc.
   virtual void DealDamage(ABBotCharacter* enemyPlayer);
 
+  /* Deals the hit damage, knockback and unique spell functionality to the enemy.
+  Shared by spell actors and the batched projectiles of the projectile manager. */
+  virtual void ApplySpellHit(ABBotCharacter* enemyPlayer, const FVector& hitLocation);
+
   // Process unique spell functionality such as Ignite, Slow, Heal, Knockback, etc.
   virtual void DealUniqueSpellFunctionality(ABBotCharacter* enemyPlayer);
 
-  /* Returns the duration the unique functionality duration, ex: Ignite Duration
-  This prevents the spell object from getting deleted before the ignite duration is over */
+  /* Returns how long the spell lingers after it explodes. Ignite, poison and slow
+  are run by the status effect manager, so the spell does not need to outlive them */
   virtual float GetFunctionalityDuration();
 
+  // Returns the world status effect manager, only valid on the server
+  class AStatusEffectManager* GetStatusEffectManager() const;
+
   /* Returns the damage pre elemental dmg processing. Used to set 
   dot dmg under aoe classes (Ignite, psn-dot, etc), such as ignite effects 
   can do more or less dmg than staying in the aoe volume.*/
   UFUNCTION()
   virtual float GetPreProcessedDotDamage();
 
+  /* Returns the dmg of one dot or aoe tick: GetPreProcessedDotDamage through
+  ProcessElementalDmg, scaled by damageScale. Every dot and aoe spell goes through it. */
+  float GetDotDamage(float damageScale = 1.f);
+
   // Returns the final dmg to deal post dmg modifiers
   UFUNCTION()
   virtual float GetDamageToDeal();
@@ -204,26 +270,61 @@ protected:
   void SimulateExplosion();
   virtual void SimulateExplosion_Implementation();
 
-  /* UE4 does not support multiple inheritance, 
-  thus we are creating the AOETick under the spellSystem
-  to be called under AOEFire/AOEIce-Tick, etc. Using an interface
-  would not have solved the problem of having to implement
-  the same AOETick function for every damage type.*/
-  virtual void AOETick();
+  /* UE4 does not support multiple inheritance, thus the AOE volume
+  registration lives under the spellSystem to be shared by AOEFire/AOEIce, etc.
+  Registers the spell's collision sphere with the AOE scheduler, which deals
+  GetDamageToDeal() every tickInterval to the enemies standing in it. */
+  void RegisterAOEVolume(float tickInterval);
 
-  // The spellDps, to be applied by deltaSeconds(Used with AOETick)
+  // Removes the spell's volume from the AOE scheduler
+  void UnregisterAOEVolume();
+
+  // The spellDps, to be applied by deltaSeconds(Used with AOE volumes)
   float damagePerSecond;
 
+  // Live spells cast by a teammate of the viewer replicate within this squared distance
+  UPROPERTY(EditDefaultsOnly, Category = "Replication")
+  float allyNetCullDistanceSquared;
+
 private:
+  // The pool that owns this spell, null for spells spawned outside of a pool (spell bar managers)
+  UPROPERTY()
+  ASpellPool* spellPool;
+
+  // True while the spell is cast and active in the world
+  bool bPooledSpellActive;
+
+  // True for the hidden spell bar managers that cast the spells
+  bool bSpellBarManager;
+
+  // True while the spell has a volume registered with the AOE scheduler
+  bool bAOEVolumeRegistered;
+
+  // The projectile velocity in local space, restored every time the spell is activated
+  FVector initialLocalVelocity;
+
+  // Restarts the projectile movement and particles on clients when a pooled spell is re-used
+  UFUNCTION(Reliable, NetMulticast)
+  void SimulateActivation();
+  void SimulateActivation_Implementation();
+
+  // Stops the projectile movement and particles on clients when a pooled spell is released
+  UFUNCTION(Reliable, NetMulticast)
+  void SimulateDeactivation();
+  void SimulateDeactivation_Implementation();
+
+  // Restarts the projectile movement along the current rotation
+  void RestartProjectileMovement();
+
   // Spell cooldown helper
   UPROPERTY(Replicated)
   float CDHelper;
+
+  // The prediction key of the cast in progress, INDEX_NONE if the cast was not predicted
+  int32 castPredictionKey;
+
+  // The team of the caster, cached on the server every time the spell is activated
+  uint8 casterTeamNum;
   
   void ProcessSpellTimers();
-
-  // IsEnemy only runs on server authority
-  UFUNCTION(Reliable, Server, WithValidation)
-  void ServerIsEnemy(ABBotCharacter* possibleEnemy);
-  virtual void ServerIsEnemy_Implementation(ABBotCharacter* possibleEnemy);
-  virtual bool ServerIsEnemy_Validate(ABBotCharacter* possibleEnemy);
 };
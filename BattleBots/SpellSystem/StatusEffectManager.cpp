@@ -0,0 +1,222 @@
+// Copyright 2015 VMR Games, Inc. All Rights Reserved.
+
+#include "BattleBots.h"
+#include "Character/BBotCharacter.h"
+#include "BattleBotsGameMode.h"
+#include "Combat/BBotsCombatLog.h"
+#include "StatusEffectManager.h"
+
+
+AStatusEffectManager::AStatusEffectManager()
+{
+  PrimaryActorTick.bCanEverTick = true;
+
+  // The manager lives on the server only
+  bReplicates = false;
+}
+
+void AStatusEffectManager::Tick(float DeltaSeconds)
+{
+  BBOTS_SCOPE_CYCLE_COUNTER(StatusEffectTick);
+  Super::Tick(DeltaSeconds);
+
+  if (!HasAuthority())
+  {
+    return;
+  }
+
+  if (activeEffects.Num() == 0)
+  {
+    BBOTS_SET_COUNTER(ActiveDots, 0);
+    return;
+  }
+
+  const float currentTime = GetWorld()->GetTimeSeconds();
+  ABattleBotsGameMode* GM = GetWorld()->GetAuthGameMode<ABattleBotsGameMode>();
+  ABBotsCombatLog* combatLog = GM ? GM->GetCombatLog() : nullptr;
+  int32 numDots = 0;
+
+  /* Damage is applied after the update. ApplyDamage can kill the target or reset the round,
+  / both remove effects, so applying it inside the loop would move effects under the iteration. */
+  dueTicks.Reset();
+
+  // Iterate backwards, expired effects are removed with RemoveAtSwap
+  for (int32 i = activeEffects.Num() - 1; i >= 0; i--)
+  {
+    FStatusEffect& effect = activeEffects[i];
+    ABBotCharacter* target = effect.target.Get();
+
+    if (!target || !target->IsAlive() || effect.timer.IsExpired(currentTime))
+    {
+      RemoveEffectAt(i);
+      continue;
+    }
+
+    if (effect.effectType == EStatusEffectType::ESlow)
+    {
+      continue;
+    }
+
+    numDots++;
+    if (effect.timer.ConsumeTick(currentTime))
+    {
+      FDueDotTick tick;
+      tick.target = target;
+      tick.instigator = effect.instigator;
+      tick.damageCauser = effect.damageCauser;
+      tick.damageType = effect.damageType;
+      tick.effectType = effect.effectType;
+      tick.damage = effect.magnitude;
+      dueTicks.Add(tick);
+    }
+  }
+
+  // Indexed, a reset during ApplyDamage drops the remaining ticks
+  for (int32 i = 0; i < dueTicks.Num(); i++)
+  {
+    const FDueDotTick tick = dueTicks[i];
+
+    // An earlier tick of this frame can have killed the target
+    ABBotCharacter* target = tick.target.Get();
+    if (!target || !target->IsAlive())
+    {
+      continue;
+    }
+
+    AController* instigator = tick.instigator.Get();
+    if (combatLog)
+    {
+      combatLog->LogDotTick(instigator, target, UBBotDmgType::GetDamageElement(tick.damageType), tick.damage, (uint8)tick.effectType);
+    }
+    UGameplayStatics::ApplyDamage(target, tick.damage, instigator, tick.damageCauser.Get(), tick.damageType);
+  }
+
+  BBOTS_SET_COUNTER(ActiveDots, numDots);
+}
+
+void AStatusEffectManager::BeginPlay()
+{
+  Super::BeginPlay();
+
+  RegisterForReset(this, EResetPriority::EManagers);
+}
+
+void AStatusEffectManager::EndPlay(const EEndPlayReason::Type EndPlayReason)
+{
+  UnregisterForReset(this);
+
+  Super::EndPlay(EndPlayReason);
+}
+
+void AStatusEffectManager::Reset_Implementation()
+{
+  dueTicks.Reset();
+  for (int32 i = activeEffects.Num() - 1; i >= 0; i--)
+  {
+    RemoveEffectAt(i);
+  }
+}
+
+void AStatusEffectManager::ApplyDot(ABBotCharacter* target, EStatusEffectType effectType, float damagePerTick, float tickInterval, float firstTickDelay, float duration, AController* instigator, AActor* damageCauser, TSubclassOf<UDamageType> damageType)
+{
+  if (!target || !HasAuthority() || tickInterval <= 0.f)
+  {
+    return;
+  }
+
+  const float currentTime = GetWorld()->GetTimeSeconds();
+  const FStatusEffectKey key(target, effectType, instigator);
+  FStatusEffect* effect = FindEffect(key);
+
+  if (effect)
+  {
+    // Same instigator, refresh the duration and keep the current tick phase
+    effect->magnitude = damagePerTick;
+    effect->damageCauser = damageCauser;
+    effect->timer.Refresh(currentTime, tickInterval, duration);
+    return;
+  }
+
+  FStatusEffect& newEffect = AddEffect(key);
+  newEffect.instigator = instigator;
+  newEffect.damageCauser = damageCauser;
+  newEffect.damageType = damageType;
+  newEffect.magnitude = damagePerTick;
+  newEffect.timer.Start(currentTime, tickInterval, firstTickDelay, duration);
+}
+
+void AStatusEffectManager::ApplySlow(ABBotCharacter* target, float slowMod, float duration)
+{
+  if (!target || !HasAuthority())
+  {
+    return;
+  }
+
+  const float currentTime = GetWorld()->GetTimeSeconds();
+  const FStatusEffectKey key(target, EStatusEffectType::ESlow, nullptr);
+  FStatusEffect* effect = FindEffect(key);
+
+  if (effect)
+  {
+    /* Only 1 slow is active at a time. A weaker slow must not override
+    or extend the stronger slow in effect. */
+    if (slowMod > effect->magnitude)
+    {
+      return;
+    }
+  }
+  else
+  {
+    effect = &AddEffect(key);
+  }
+
+  effect->magnitude = slowMod;
+  effect->timer.endTime = currentTime + duration;
+  target->SlowPlayer(slowMod);
+}
+
+void AStatusEffectManager::ClearEffects(ABBotCharacter* target)
+{
+  for (int32 i = activeEffects.Num() - 1; i >= 0; i--)
+  {
+    if (activeEffects[i].target.Get() == target)
+    {
+      RemoveEffectAt(i);
+    }
+  }
+}
+
+FStatusEffect* AStatusEffectManager::FindEffect(const FStatusEffectKey& key)
+{
+  const int32* index = effectIndices.Find(key);
+  return index ? &activeEffects[*index] : nullptr;
+}
+
+FStatusEffect& AStatusEffectManager::AddEffect(const FStatusEffectKey& key)
+{
+  const int32 index = activeEffects.Emplace(key);
+  effectIndices.Add(key, index);
+  return activeEffects[index];
+}
+
+void AStatusEffectManager::RemoveEffectAt(int32 index)
+{
+  const FStatusEffect& effect = activeEffects[index];
+  effectIndices.Remove(effect.key);
+
+  // Reverse the slow effect once the duration is up
+  ABBotCharacter* target = effect.target.Get();
+  if (effect.effectType == EStatusEffectType::ESlow && target)
+  {
+    target->ClearSlow();
+  }
+
+  const int32 lastIndex = activeEffects.Num() - 1;
+  activeEffects.RemoveAtSwap(index, 1, false);
+
+  // The last effect moved into the removed slot, update its index
+  if (index != lastIndex)
+  {
+    effectIndices.Add(activeEffects[index].key, index);
+  }
+}
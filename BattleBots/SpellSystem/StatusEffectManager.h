@@ -0,0 +1,129 @@
+// Copyright 2015 VMR Games, Inc. All Rights Reserved.
+
+#pragma once
+
+#include "GameFramework/Info.h"
+#include "Interfaces/BBotsResetInterface.h"
+#include "Combat/BBotCombatMath.h"
+#include "StatusEffectManager.generated.h"
+
+class ABBotCharacter;
+
+UENUM(BlueprintType)
+enum class EStatusEffectType :uint8{
+  EIgnite       UMETA(DisplayName = "Ignite"),
+  EPoison       UMETA(DisplayName = "Poison"),
+  ESlow         UMETA(DisplayName = "Slow"),
+};
+
+// Status effects are keyed by target and type. DoTs are also keyed by instigator so DoTs from different casters stack.
+struct FStatusEffectKey
+{
+  const ABBotCharacter* target;
+  const AController* instigator;
+  EStatusEffectType effectType;
+
+  FStatusEffectKey(const ABBotCharacter* inTarget, EStatusEffectType inType, const AController* inInstigator)
+    : target(inTarget), instigator(inInstigator), effectType(inType)
+  {}
+
+  friend bool operator==(const FStatusEffectKey& A, const FStatusEffectKey& B)
+  {
+    return A.target == B.target && A.instigator == B.instigator && A.effectType == B.effectType;
+  }
+
+  friend uint32 GetTypeHash(const FStatusEffectKey& Key)
+  {
+    return HashCombine(HashCombine(PointerHash(Key.target), PointerHash(Key.instigator)), (uint32)Key.effectType);
+  }
+};
+
+// A single status effect on a target. DoTs use magnitude as damage per tick, slows as the movement speed mod.
+struct FStatusEffect
+{
+  // Identifies the effect, kept as is so a destroyed target can still be unindexed
+  FStatusEffectKey key;
+  TWeakObjectPtr<ABBotCharacter> target;
+  TWeakObjectPtr<AController> instigator;
+  TWeakObjectPtr<AActor> damageCauser;
+  TSubclassOf<UDamageType> damageType;
+  EStatusEffectType effectType;
+  float magnitude;
+  // Tick phase and expiration, slows only use the end time
+  BBotCombat::FDotTimer timer;
+
+  FStatusEffect(const FStatusEffectKey& inKey)
+    : key(inKey), target(const_cast<ABBotCharacter*>(inKey.target)), damageType(nullptr), effectType(inKey.effectType),
+    magnitude(0.f)
+  {}
+};
+
+// A DoT tick that came due this frame, applied once the update is done
+struct FDueDotTick
+{
+  TWeakObjectPtr<ABBotCharacter> target;
+  TWeakObjectPtr<AController> instigator;
+  TWeakObjectPtr<AActor> damageCauser;
+  TSubclassOf<UDamageType> damageType;
+  EStatusEffectType effectType;
+  float damage;
+};
+
+/**
+ * AStatusEffectManager owns every ignite, poison and slow in the world and
+ * advances them in one batched update, so spells no longer keep a timer per
+ * enemy hit and can be released as soon as they explode.
+ * Stacking rules: re-applying a DoT from the same instigator refreshes it,
+ * DoTs from different instigators stack, and only the strongest slow is active.
+ * The manager is owned by the game mode and only exists on the server.
+ */
+UCLASS()
+class BATTLEBOTS_API AStatusEffectManager : public AInfo, public IBBotsResetInterface
+{
+  GENERATED_BODY()
+
+public:
+  AStatusEffectManager();
+
+  // Advances all status effects
+  virtual void Tick(float DeltaSeconds) override;
+
+  // Registers with the round reset
+  virtual void BeginPlay() override;
+
+  virtual void EndPlay(const EEndPlayReason::Type EndPlayReason) override;
+
+  // Interface call on match reset, clears all status effects
+  virtual void Reset_Implementation() override;
+
+  // Adds or refreshes a damage over time effect (Ignite, poison), damageCauser is the spell that applied it
+  void ApplyDot(ABBotCharacter* target, EStatusEffectType effectType, float damagePerTick, float tickInterval, float firstTickDelay, float duration, AController* instigator, AActor* damageCauser, TSubclassOf<UDamageType> damageType);
+
+  // Slows the target by slowMod for duration. A weaker slow does not override a stronger active slow.
+  void ApplySlow(ABBotCharacter* target, float slowMod, float duration);
+
+  // Removes all status effects on the target, called when it dies
+  void ClearEffects(ABBotCharacter* target);
+
+  // Returns the number of active status effects
+  FORCEINLINE int32 GetNumEffects() const { return activeEffects.Num(); }
+
+private:
+  // All active effects, packed so the update touches contiguous memory
+  TArray<FStatusEffect> activeEffects;
+
+  // Maps a target/type/instigator key to its index in activeEffects
+  TMap<FStatusEffectKey, int32> effectIndices;
+
+  // The ticks of the current update, kept between frames so it does not reallocate
+  TArray<FDueDotTick> dueTicks;
+
+  // Returns the active effect for key, or null
+  FStatusEffect* FindEffect(const FStatusEffectKey& key);
+
+  // Adds a new effect and indexes it
+  FStatusEffect& AddEffect(const FStatusEffectKey& key);
+
+  // Removes the effect at index, ending its effect on the target
+  void RemoveEffectAt(int32 index);
+};
@@ -3,6 +3,8 @@
 #include "BattleBots.h"
 #include "Online/BBotsPlayerState.h"
 #include "Runtime/UMG/Public/Blueprint/WidgetTree.h"
+#include "ChatSystemLibrary/BBotsChatCommand.h"
+#include "ChatSystemLibrary/BBotsChatFormatter.h"
 #include "ChatBlockWidget.h"
 
 
@@ -12,9 +14,32 @@
 UChatBlockWidget::UChatBlockWidget(const FObjectInitializer& ObjectInitializer)
   : Super(ObjectInitializer)
 {
-  // Initialization list is not available for UE4, this is a workaround
-  FString Types[] = { "/a", "/t", "/w", "/all", "/whisper", "/team" };
-  MessageTypes.Append(Types, ARRAY_COUNT(Types));
+  ChatLinesHead = 0;
+  NumChatLines = 0;
+}
+
+// Copies a parsed range, the only strings a chat message needs
+static FORCEINLINE FText ChatViewToText(const BBotsChat::TStringView<TCHAR>& View)
+{
+  return View.IsEmpty() ? FText::GetEmpty() : FText::FromString(FString(View.length, View.data));
+}
+
+static EMessageType CommandToMessageType(BBotsChat::ECommand::Type Command)
+{
+  switch (Command)
+  {
+  case BBotsChat::ECommand::ENone:
+  case BBotsChat::ECommand::EAll:
+    return EMessageType::EAll;
+  case BBotsChat::ECommand::ETeam:
+    return EMessageType::ETeam;
+  case BBotsChat::ECommand::EWhisper:
+  case BBotsChat::ECommand::EReply:
+    return EMessageType::EWhisper;
+  default:
+    break;
+  }
+  return EMessageType::EUnkown;
 }
 
 void UChatBlockWidget::PostInitProperties()
@@ -43,10 +68,7 @@ void UChatBlockWidget::LogMessage(FChatMessageStruct Message)
   if (PName.EqualToCaseIgnored(Message.Sender))
   {
     // Log this character's messages only
-    ChatLog.PreviousMessages.Add(Message);
-    // Update the chat log index
-    ChatLogIndex = ChatLog.PreviousMessages.Num()-1;
-    CurrentChatLogIndex = ChatLogIndex;
+    ChatLog.Add(Message);
   }
   else if (PName.EqualToCaseIgnored(Message.Reciever))
   {
@@ -68,171 +90,197 @@ FText UChatBlockWidget::ReplyToLastSender()
 
 FText UChatBlockWidget::GetLastMessageSent()
 {
-  FChatMessageStruct TempMsg;
+  const FChatLogEntry* Entry = ChatLog.Navigate(bUpKeyPressed);
+  if (!Entry)
+  {
+    return FText::GetEmpty();
+  }
 
-  if (ChatLog.PreviousMessages.IsValidIndex(CurrentChatLogIndex))
+  if (Entry->MessageType == EMessageType::EWhisper)
   {
-    if (bUpKeyPressed)
-    {
-      TempMsg = ChatLog.PreviousMessages[CurrentChatLogIndex--];
-      CurrentChatLogIndex = FMath::Clamp(CurrentChatLogIndex, 0, ChatLogIndex);
-    }
-    else
-    {
-      TempMsg = ChatLog.PreviousMessages[CurrentChatLogIndex++];
-      CurrentChatLogIndex = FMath::Clamp(CurrentChatLogIndex, 0, ChatLogIndex);
-    }
+    return FText::Format(LOCTEXT("MessageToDisplay", "{0} {1} {2} "), MessageTypeToText(Entry->MessageType),
+      FText::FromName(Entry->Reciever), FText::FromString(Entry->Message));
   }
-  
-  FText FormatedReplyMessage = FText::Format(LOCTEXT("MessageToDisplay", "{0} {1} "), MessageTypeToText(TempMsg.MessageType), TempMsg.Message);
-  
-  return FormatedReplyMessage;
+
+  return FText::Format(LOCTEXT("MessageToDisplay", "{0} {1} "), MessageTypeToText(Entry->MessageType), FText::FromString(Entry->Message));
 }
 
-FChatMessageStruct UChatBlockWidget::RecieveMessage_Implementation(FChatMessageStruct MessageRecieved)
+TArray<FChatMessageStruct> UChatBlockWidget::GetPreviousMessages() const
 {
-  //@todo fix copy operator,bug?
-  //MessageRecieved.TimeStamp = TimeStamp.GetTimeStampText();
-  FText FormatArgs;
-  bool bIsSender = false;
+  TArray<FChatMessageStruct> PreviousMessages;
+  PreviousMessages.Reserve(ChatLog.Num());
 
-  switch (MessageRecieved.MessageType)
+  for (int32 i = 0; i < ChatLog.Num(); i++)
   {
-  case EMessageType::EWhisper:
-    // Change to whisper color
-    MessageRecieved.MessageColor = WhisperChatMessageColor;
-
-    if (MessageRecieved.Sender.EqualToCaseIgnored(PName))
-    {
-      bIsSender = true;
-      FormatArgs = LOCTEXT("MessageToDisplay", "{0} [Whisper to {1}]: {2}");
-    }
-    else
-    {
-      FormatArgs = LOCTEXT("MessageToDisplay", "{0} [Whisper from {1}]: {2}");
-    }
-    break;
+    const FChatLogEntry& Entry = ChatLog.GetEntry(i);
+
+    FChatMessageStruct Message;
+    Message.Sender = FText::FromName(Entry.Sender);
+    Message.Reciever = FText::FromName(Entry.Reciever);
+    Message.Message = FText::FromString(Entry.Message);
+    Message.SentTime = FDateTime(Entry.TimeStampTicks);
+    Message.MessageType = Entry.MessageType;
+    PreviousMessages.Add(Message);
+  }
 
-  case EMessageType::ETeam:
-    // Change to team color
-    MessageRecieved.MessageColor = TeamChatMessageColor;
-    FormatArgs = LOCTEXT("MessageToDisplay", "{0} [Team] {1}: {2}");
-    break;
+  return PreviousMessages;
+}
 
-  case EMessageType::EAll:
-  default:
-    // All other cases get sent to all chat
-    MessageRecieved.MessageColor = AllChatMessageColor;
-    FormatArgs = LOCTEXT("MessageToDisplay", "{0} [All] {1}: {2}");
-    break;
+FChatMessageStruct UChatBlockWidget::RecieveMessage_Implementation(FChatMessageStruct MessageRecieved)
+{
+  // Messages from the server carry their receive time
+  if (MessageRecieved.SentTime.GetTicks() == 0)
+  {
+    MessageRecieved.SentTime = FBBotsChatFormatter::GetFrameTime();
   }
 
-  FText MessageToDisplay = FText::Format(FormatArgs,
-    TimeStamp.GetTimeStampText(),
-    bIsSender ? MessageRecieved.Reciever
-    : MessageRecieved.Sender,
-    MessageRecieved.Message);
+  MessageRecieved.MessageColor = GetMessageColor(MessageRecieved.MessageType);
+  AddChatLine(MessageRecieved);
 
-  MessageRecieved.MessageToDisplay = MessageToDisplay;
+  // A hidden chat box formats its lines once they are shown, see GetChatLineText
+  if (GetVisibility() != ESlateVisibility::Collapsed && GetVisibility() != ESlateVisibility::Hidden)
+  {
+    MessageRecieved.MessageToDisplay = GetChatLineText(NumChatLines - 1);
+  }
 
   return MessageRecieved;
 }
 
+int32 UChatBlockWidget::GetNumChatLines() const
+{
+  return NumChatLines;
+}
 
-bool UChatBlockWidget::CanRecieveMessage_Implementation(const FChatMessageStruct& MessageRecieved)
+FText UChatBlockWidget::GetChatLineText(int32 LineIndex)
+{
+  if (LineIndex < 0 || LineIndex >= NumChatLines)
+  {
+    return FText::GetEmpty();
+  }
+
+  FChatLine& Line = GetChatLine(LineIndex);
+  if (!Line.bFormatted)
+  {
+    Line.DisplayText = FBBotsChatFormatter::Get().FormatLine(Line.Format, FDateTime(Line.Entry.TimeStampTicks),
+      Line.Format == EChatFormat::EWhisperTo ? Line.Entry.Reciever : Line.Entry.Sender, Line.Entry.Message);
+    Line.bFormatted = true;
+  }
+  return Line.DisplayText;
+}
+
+FSlateColor UChatBlockWidget::GetChatLineColor(int32 LineIndex)
 {
-  switch (MessageRecieved.MessageType)
+  if (LineIndex < 0 || LineIndex >= NumChatLines)
   {
-  case EMessageType::EAll:
-    return true;
+    return AllChatMessageColor;
+  }
+  return GetMessageColor(GetChatLine(LineIndex).Entry.MessageType);
+}
+
+const FSlateColor& UChatBlockWidget::GetMessageColor(EMessageType MessageType) const
+{
+  switch (MessageType)
+  {
+  case EMessageType::EWhisper:
+    return WhisperChatMessageColor;
+  case EMessageType::ETeam:
+    return TeamChatMessageColor;
+  default:
+    // All other cases get sent to all chat
+    return AllChatMessageColor;
+  }
+}
+
+void UChatBlockWidget::AddChatLine(const FChatMessageStruct& Message)
+{
+  FChatLine& Line = ChatLines[ChatLinesHead];
+  Line.Entry.Sender = FName(*Message.Sender.ToString());
+  Line.Entry.Reciever = FName(*Message.Reciever.ToString());
+  Line.Entry.Message = Message.Message.ToString();
+  Line.Entry.TimeStampTicks = Message.SentTime.GetTicks();
+  Line.Entry.MessageType = Message.MessageType;
+  Line.bFormatted = false;
+
+  switch (Message.MessageType)
+  {
+  case EMessageType::EWhisper:
+    Line.Format = Message.Sender.EqualToCaseIgnored(PName) ? EChatFormat::EWhisperTo : EChatFormat::EWhisperFrom;
     break;
   case EMessageType::ETeam:
-    return MessageRecieved.TeamNumber == CState->GetTeamNum();
+    Line.Format = EChatFormat::ETeam;
     break;
-  case EMessageType::EWhisper:
-    return !MessageRecieved.Reciever.EqualToCaseIgnored(MessageRecieved.Sender);
+  case EMessageType::ESystem:
+    Line.Format = EChatFormat::ESystem;
     break;
   default:
+    Line.Format = EChatFormat::EAll;
     break;
   }
-  return false;
+
+  ChatLinesHead = (ChatLinesHead + 1) % MaxChatLines;
+  NumChatLines = FMath::Min(NumChatLines + 1, (int32)MaxChatLines);
+}
+
+UChatBlockWidget::FChatLine& UChatBlockWidget::GetChatLine(int32 LineIndex)
+{
+  // Index 0 is the oldest line
+  return ChatLines[(ChatLinesHead - NumChatLines + LineIndex + MaxChatLines) % MaxChatLines];
+}
+
+
+bool UChatBlockWidget::CanRecieveMessage_Implementation(const FChatMessageStruct& MessageRecieved)
+{
+  // The server's chat router only sends messages to their recipients
+  return MessageRecieved.MessageType != EMessageType::EUnkown;
 }
 
 
 FChatMessageStruct UChatBlockWidget::ParseMessageData(const FString& UnParsedMessage)
 {
   // We reset the struct data every message. See ChatMessage for more details.
-  FChatMessageStruct TempChatMessage;
-  ChatMessage = TempChatMessage;
+  ChatMessage = FChatMessageStruct();
 
   // Set the sender to this character's name and TeamNumber
   ChatMessage.Sender = PName;
   ChatMessage.TeamNumber = CState->GetTeamNum();
 
-  FString ParsedMessage;
-  FString ChatCommand;
-  FString Reciever;
-  int32 IndexZero;
+  // Views into UnParsedMessage, nothing is copied until the message fields are set
+  const BBotsChat::TParsedChat<TCHAR> Parsed = BBotsChat::Parse(*UnParsedMessage, UnParsedMessage.Len());
 
-  // Did the user type in a command?
-  if (UnParsedMessage.FindChar(TEXT('/'), IndexZero) && IndexZero == 0)
+  if (Parsed.command == BBotsChat::ECommand::EInvalid)
   {
-    UnParsedMessage.Split(TEXT(" "), &ChatCommand, &ParsedMessage);
-
-    if (!MessageTypes.Contains(ChatCommand.ToLower()))
-    {
-      //Returns an error msg for invalid command
-      FString InvalidMessage = FString::Printf(TEXT("%s is an invalid command"), *ChatCommand);
-      ChatMessage.Message = FText::FromString(InvalidMessage);
+    //Returns an error msg for invalid command
+    FString InvalidMessage = FString::Printf(TEXT("%s is an invalid command"), *FString(Parsed.commandToken.length, Parsed.commandToken.data));
+    ChatMessage.Message = FText::FromString(InvalidMessage);
 
-      return ChatMessage;
-    }
-
-    // Get message type
-    ChatMessage.MessageType = StringToMessageType(ChatCommand);
-
-    if (ChatCommand.ToLower() == "/w" || ChatCommand.ToLower() == "/whisper")
-    {
-      // Split the whisper command to get the target player and msg
-      ParsedMessage.Split(TEXT(" "), &Reciever, &ParsedMessage);
-      ChatMessage.Reciever = FText::FromString(Reciever);
-      ChatMessage.Message = FText::FromString(ParsedMessage);
+    return ChatMessage;
+  }
 
-      return ChatMessage;
-    }
-    else
-    {
-      // If the player is not sending a whisper then the remaining text is a msg
-      ChatMessage.Message = FText::FromString(ParsedMessage);
+  ChatMessage.MessageType = CommandToMessageType(Parsed.command);
 
-      return ChatMessage;
-    }
+  if (Parsed.command == BBotsChat::ECommand::EReply)
+  {
+    // Whisper back to whoever whispered us last
+    ChatMessage.Reciever = ChatLog.LastSender;
+  }
+  else if (Parsed.command == BBotsChat::ECommand::EWhisper)
+  {
+    ChatMessage.Reciever = ChatViewToText(Parsed.reciever);
   }
 
-  // Returns the string if the user did not use any commands
-  ChatMessage.MessageType = EMessageType::EAll;
-  ChatMessage.Message = FText::FromString(UnParsedMessage);
+  ChatMessage.Message = ChatViewToText(Parsed.message);
   return ChatMessage;
 }
 
 EMessageType UChatBlockWidget::StringToMessageType(const FString& MessageCommand)
 {
-  FString Command = MessageCommand.ToLower();
-
-  if (Command == "/a" || Command == "/all")
-  {
-    return EMessageType::EAll;
-  }
-  else if (Command == "/t" || Command == "/team")
+  if (!MessageCommand.StartsWith(TEXT("/")))
   {
-    return EMessageType::ETeam;
-  }
-  else if (Command == "/w" || Command == "/whisper")
-  {
-    return EMessageType::EWhisper;
+    return EMessageType::EUnkown;
   }
 
-  return EMessageType::EUnkown;
+  const BBotsChat::ECommand::Type Command = BBotsChat::FCommandTable::Get().Find(*MessageCommand + 1, MessageCommand.Len() - 1);
+  return Command == BBotsChat::ECommand::EInvalid ? EMessageType::EUnkown : CommandToMessageType(Command);
 }
 
 FText UChatBlockWidget::MessageTypeToText(const EMessageType& MessageType)
@@ -46,7 +46,7 @@ protected:
   UPROPERTY()
   FChatMessageStruct ChatMessage;
 
-  // Logs all text messages relevant to the player
+  // Logs the last FChatLog::Capacity messages sent by the player
   UPROPERTY(BlueprintReadOnly, Category = "ChatLog")
   FChatLog ChatLog;
 
@@ -58,9 +58,6 @@ protected:
   UPROPERTY(BlueprintReadWrite, Category = "TimeStamp")
   FTimeStamp TimeStamp;
 
-  // Holds all the different message commands
-  TArray<FString> MessageTypes;
-
   // Logs incoming messages for quick reply
   UFUNCTION(BlueprintCallable, Category = "ChatLog")
   void LogMessage(FChatMessageStruct Message);
@@ -73,6 +70,10 @@ protected:
   UFUNCTION(BlueprintCallable, Category = "ChatLog")
   FText GetLastMessageSent();
 
+  // Returns the logged messages of the player, oldest first. Replaces ChatLog.PreviousMessages.
+  UFUNCTION(BlueprintCallable, Category = "ChatLog")
+  TArray<FChatMessageStruct> GetPreviousMessages() const;
+
   UFUNCTION(BlueprintCallable, Category = "Chat")
   FChatMessageStruct ParseMessageData(const FString& UnParsedMessage);
 
@@ -90,12 +91,39 @@ protected:
   bool CanRecieveMessage(const FChatMessageStruct& MessageRecieved);
   bool CanRecieveMessage_Implementation(const FChatMessageStruct& MessageRecieved);
 
+  // Returns the number of received lines kept for display
+  UFUNCTION(BlueprintCallable, Category = "Chat")
+  int32 GetNumChatLines() const;
+
+  /* Returns the display text of a received line, 0 is the oldest. Lines are
+  / formatted on their first call, so only call it for lines that are shown. */
+  UFUNCTION(BlueprintCallable, Category = "Chat")
+  FText GetChatLineText(int32 LineIndex);
+
+  UFUNCTION(BlueprintCallable, Category = "Chat")
+  FSlateColor GetChatLineColor(int32 LineIndex);
+
 private:
-  // Accesses chat log to return the next message
-  UPROPERTY()
-  int32 ChatLogIndex;
+  // Received lines kept for display, the oldest gets overwritten
+  static const int32 MaxChatLines = 100;
 
-  UPROPERTY()
-  int32 CurrentChatLogIndex;
+  struct FChatLine
+  {
+    FChatLogEntry Entry;
+    EChatFormat::Type Format;
+    bool bFormatted;
+    FText DisplayText;
+  };
+
+  FChatLine ChatLines[MaxChatLines];
+  // Slot the next line is written to
+  int32 ChatLinesHead;
+  int32 NumChatLines;
+
+  const FSlateColor& GetMessageColor(EMessageType MessageType) const;
+
+  void AddChatLine(const FChatMessageStruct& Message);
+
+  FChatLine& GetChatLine(int32 LineIndex);
 };
 
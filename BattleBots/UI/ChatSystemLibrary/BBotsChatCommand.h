@@ -0,0 +1,195 @@
+// Copyright 2015 VMR Games, Inc. All Rights Reserved.
+
+#pragma once
+
+#include <cstdint>
+
+/**
+ * BBotsChat parses typed chat lines ("/w Name hello", "/team push mid", "gg")
+ * in a single pass, without copying: the result only points into the typed
+ * text. Commands are looked up in a small trie, so adding a command is one
+ * line in FCommandTable. Plain C++, no engine headers, so the parser can be
+ * measured outside of the engine (see Tools/ChatBench).
+ */
+namespace BBotsChat
+{
+  namespace ECommand
+  {
+    enum Type
+    {
+      // Plain text without a command, sent to all chat
+      ENone,
+      EAll,
+      ETeam,
+      EWhisper,
+      // Whisper to the last player that whispered us
+      EReply,
+      // Starts with '/' but is not a known command
+      EInvalid,
+      EMax,
+    };
+  }
+
+  // A range of characters inside the typed text, never owns them
+  template <typename CharType>
+  struct TStringView
+  {
+    const CharType* data;
+    int32_t length;
+
+    TStringView() : data(nullptr), length(0) {}
+    TStringView(const CharType* inData, int32_t inLength) : data(inData), length(inLength) {}
+
+    bool IsEmpty() const { return length == 0; }
+  };
+
+  template <typename CharType>
+  struct TParsedChat
+  {
+    ECommand::Type command;
+    // The command as typed, including the '/'
+    TStringView<CharType> commandToken;
+    // Whisper target, empty for the other commands
+    TStringView<CharType> reciever;
+    TStringView<CharType> message;
+
+    TParsedChat() : command(ECommand::ENone) {}
+  };
+
+  /* Case insensitive trie of the command names, without their '/'.
+  / Only letters are allowed in names, a name must match fully ("/wh" is invalid). */
+  class FCommandTable
+  {
+  public:
+    FCommandTable()
+      : numNodes(1)
+    {
+      ClearNode(0);
+      Add("a", ECommand::EAll);
+      Add("all", ECommand::EAll);
+      Add("t", ECommand::ETeam);
+      Add("team", ECommand::ETeam);
+      Add("w", ECommand::EWhisper);
+      Add("whisper", ECommand::EWhisper);
+      Add("r", ECommand::EReply);
+      Add("reply", ECommand::EReply);
+    }
+
+    static const FCommandTable& Get()
+    {
+      static const FCommandTable table;
+      return table;
+    }
+
+    // Looks up the command name that follows the '/'
+    template <typename CharType>
+    ECommand::Type Find(const CharType* name, int32_t length) const
+    {
+      int32_t node = 0;
+      for (int32_t i = 0; i < length; i++)
+      {
+        const int32_t letter = ToLetterIndex(name[i]);
+        if (letter < 0 || nodes[node].children[letter] == 0)
+        {
+          return ECommand::EInvalid;
+        }
+        node = nodes[node].children[letter];
+      }
+      return node != 0 && nodes[node].command != ECommand::ENone ? (ECommand::Type)nodes[node].command : ECommand::EInvalid;
+    }
+
+  private:
+    static const int32_t MaxNodes = 64;
+    static const int32_t NumLetters = 26;
+
+    struct FNode
+    {
+      // 0 is the root, which is never a child
+      uint8_t children[NumLetters];
+      uint8_t command;
+    };
+
+    FNode nodes[MaxNodes];
+    int32_t numNodes;
+
+    template <typename CharType>
+    static int32_t ToLetterIndex(CharType c)
+    {
+      if (c >= 'a' && c <= 'z')
+      {
+        return (int32_t)(c - 'a');
+      }
+      if (c >= 'A' && c <= 'Z')
+      {
+        return (int32_t)(c - 'A');
+      }
+      return -1;
+    }
+
+    void ClearNode(int32_t node)
+    {
+      for (int32_t i = 0; i < NumLetters; i++)
+      {
+        nodes[node].children[i] = 0;
+      }
+      nodes[node].command = ECommand::ENone;
+    }
+
+    // Names are compile time constants, running out of nodes means MaxNodes is too small
+    void Add(const char* name, ECommand::Type command)
+    {
+      int32_t node = 0;
+      for (; *name; name++)
+      {
+        const int32_t letter = ToLetterIndex(*name);
+        if (nodes[node].children[letter] == 0 && numNodes < MaxNodes)
+        {
+          ClearNode(numNodes);
+          nodes[node].children[letter] = (uint8_t)numNodes++;
+        }
+        node = nodes[node].children[letter];
+      }
+      nodes[node].command = (uint8_t)command;
+    }
+  };
+
+  template <typename CharType>
+  inline int32_t FindSpace(const CharType* text, int32_t begin, int32_t length)
+  {
+    while (begin < length && text[begin] != ' ')
+    {
+      begin++;
+    }
+    return begin;
+  }
+
+  /* Splits a typed chat line into its command, whisper target and message.
+  / The command ends at the first space, the whisper target at the next one. */
+  template <typename CharType>
+  inline TParsedChat<CharType> Parse(const CharType* text, int32_t length, const FCommandTable& table = FCommandTable::Get())
+  {
+    TParsedChat<CharType> result;
+
+    if (length == 0 || text[0] != '/')
+    {
+      result.message = TStringView<CharType>(text, length);
+      return result;
+    }
+
+    const int32_t commandEnd = FindSpace(text, 1, length);
+    result.commandToken = TStringView<CharType>(text, commandEnd);
+    result.command = table.Find(text + 1, commandEnd - 1);
+
+    int32_t messageBegin = commandEnd < length ? commandEnd + 1 : length;
+
+    if (result.command == ECommand::EWhisper)
+    {
+      const int32_t recieverEnd = FindSpace(text, messageBegin, length);
+      result.reciever = TStringView<CharType>(text + messageBegin, recieverEnd - messageBegin);
+      messageBegin = recieverEnd < length ? recieverEnd + 1 : length;
+    }
+
+    result.message = TStringView<CharType>(text + messageBegin, length - messageBegin);
+    return result;
+  }
+}
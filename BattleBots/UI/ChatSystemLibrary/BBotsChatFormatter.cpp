@@ -0,0 +1,156 @@
+// Copyright 2015 VMR Games, Inc. All Rights Reserved.
+
+#include "BattleBots.h"
+#include "BBotsChatFormatter.h"
+
+
+FBBotsChatFormatter& FBBotsChatFormatter::Get()
+{
+  static FBBotsChatFormatter formatter;
+
+  // A pointer compare per line, the patterns are only compiled again after a culture change
+  const FCultureRef currentCulture = FInternationalization::Get().GetCurrentCulture();
+  if (formatter.compiledCulture.Get() != &currentCulture.Get())
+  {
+    formatter.CompilePatterns();
+    formatter.compiledCulture = currentCulture;
+  }
+
+  return formatter;
+}
+
+FBBotsChatFormatter::FBBotsChatFormatter()
+{
+}
+
+void FBBotsChatFormatter::CompilePatterns()
+{
+  // Same localization keys as the FText::Format calls these replace
+  Compile(EChatFormat::ETimeStamp, NSLOCTEXT("DisplayableTimeStamp", "TimeStamp", "[{0}:{1}:{2}]"));
+  Compile(EChatFormat::EWhisperTo, NSLOCTEXT("MessageToDisplay", "MessageToDisplay", "{0} [Whisper to {1}]: {2}"));
+  Compile(EChatFormat::EWhisperFrom, NSLOCTEXT("MessageToDisplay", "MessageToDisplay", "{0} [Whisper from {1}]: {2}"));
+  Compile(EChatFormat::ETeam, NSLOCTEXT("MessageToDisplay", "MessageToDisplay", "{0} [Team] {1}: {2}"));
+  Compile(EChatFormat::EAll, NSLOCTEXT("MessageToDisplay", "MessageToDisplay", "{0} [All] {1}: {2}"));
+  Compile(EChatFormat::ESystem, NSLOCTEXT("MessageToDisplay", "SystemMessage", "{0} {2}"));
+}
+
+template<typename AppendArgType>
+void FBBotsChatFormatter::AppendPattern(FString& out, EChatFormat::Type format, AppendArgType appendArg) const
+{
+  const FCompiledPattern& compiled = patterns[format];
+
+  for (const FPatternSegment& segment : compiled.segments)
+  {
+    if (segment.argIndex == INDEX_NONE)
+    {
+      out.AppendChars(*compiled.source + segment.literalStart, segment.literalLength);
+    }
+    else
+    {
+      appendArg(out, segment.argIndex);
+    }
+  }
+}
+
+FDateTime FBBotsChatFormatter::GetFrameTime()
+{
+  static uint64 sampledFrame = 0;
+  static FDateTime frameTime;
+
+  if (sampledFrame != GFrameCounter || frameTime.GetTicks() == 0)
+  {
+    sampledFrame = GFrameCounter;
+    frameTime = FDateTime::Now();
+  }
+  return frameTime;
+}
+
+FText FBBotsChatFormatter::FormatLine(EChatFormat::Type format, const FDateTime& sentTime, const FName& otherPlayer, const FString& message)
+{
+  buffer.Reset();
+  AppendPattern(buffer, format, [&](FString& out, int32 argIndex)
+  {
+    switch (argIndex)
+    {
+    case 0:
+      AppendTimeStamp(out, sentTime);
+      break;
+    case 1:
+      otherPlayer.AppendString(out);
+      break;
+    case 2:
+      out += message;
+      break;
+    default:
+      break;
+    }
+  });
+
+  return FText::FromString(buffer);
+}
+
+FText FBBotsChatFormatter::FormatTimeStamp(const FDateTime& time)
+{
+  buffer.Reset();
+  AppendTimeStamp(buffer, time);
+
+  return FText::FromString(buffer);
+}
+
+void FBBotsChatFormatter::Compile(EChatFormat::Type format, const FText& pattern)
+{
+  FCompiledPattern& compiled = patterns[format];
+  compiled.source = pattern.ToString();
+  compiled.segments.Reset();
+
+  const FString& source = compiled.source;
+  int32 literalStart = 0;
+
+  for (int32 i = 0; i < source.Len(); i++)
+  {
+    // Only single digit arguments are used, anything else stays literal text
+    if (source[i] != TEXT('{') || i + 2 >= source.Len() || !FChar::IsDigit(source[i + 1]) || source[i + 2] != TEXT('}'))
+    {
+      continue;
+    }
+
+    if (i > literalStart)
+    {
+      FPatternSegment literal = { INDEX_NONE, literalStart, i - literalStart };
+      compiled.segments.Add(literal);
+    }
+
+    FPatternSegment argument = { source[i + 1] - TEXT('0'), 0, 0 };
+    compiled.segments.Add(argument);
+
+    i += 2;
+    literalStart = i + 1;
+  }
+
+  if (literalStart < source.Len())
+  {
+    FPatternSegment literal = { INDEX_NONE, literalStart, source.Len() - literalStart };
+    compiled.segments.Add(literal);
+  }
+}
+
+void FBBotsChatFormatter::AppendTimeStamp(FString& out, const FDateTime& time) const
+{
+  AppendPattern(out, EChatFormat::ETimeStamp, [&](FString& timeOut, int32 argIndex)
+  {
+    switch (argIndex)
+    {
+    case 0:
+      timeOut.AppendInt(time.GetHour12());
+      break;
+    case 1:
+      timeOut.AppendInt(time.GetMinute());
+      break;
+    case 2:
+      timeOut.AppendInt(time.GetSecond());
+      break;
+    default:
+      break;
+    }
+  });
+}
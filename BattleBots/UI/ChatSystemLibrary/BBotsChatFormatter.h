@@ -0,0 +1,81 @@
+// Copyright 2015 VMR Games, Inc. All Rights Reserved.
+
+#pragma once
+
+// The display formats of a chat line
+namespace EChatFormat
+{
+  enum Type
+  {
+    // {0} hour, {1} minutes, {2} seconds
+    ETimeStamp,
+    // {0} timestamp, {1} the other player, {2} message
+    EWhisperTo,
+    EWhisperFrom,
+    // {0} timestamp, {1} sender, {2} message
+    ETeam,
+    EAll,
+    // {0} timestamp, {2} message
+    ESystem,
+    EMax,
+  };
+}
+
+/**
+ * FBBotsChatFormatter builds chat display strings without FText::Format.
+ * The localized patterns are split into literal and argument segments once,
+ * and lines are appended into a reused buffer, so formatting a line costs
+ * one copy of the finished string. The patterns are compiled again when
+ * the current culture changes. Game thread only.
+ */
+class BATTLEBOTS_API FBBotsChatFormatter
+{
+public:
+  // Returns the formatter, with its patterns compiled for the current culture
+  static FBBotsChatFormatter& Get();
+
+  // The wall clock time of the current frame, sampled once per frame
+  static FDateTime GetFrameTime();
+
+  // Returns the display text of a chat line
+  FText FormatLine(EChatFormat::Type format, const FDateTime& sentTime, const FName& otherPlayer, const FString& message);
+
+  // Returns the displayable time stamp, ex: [3:7:42]
+  FText FormatTimeStamp(const FDateTime& time);
+
+private:
+  FBBotsChatFormatter();
+
+  struct FPatternSegment
+  {
+    // INDEX_NONE for literal text
+    int32 argIndex;
+    int32 literalStart;
+    int32 literalLength;
+  };
+
+  struct FCompiledPattern
+  {
+    FString source;
+    TArray<FPatternSegment> segments;
+  };
+
+  FCompiledPattern patterns[EChatFormat::EMax];
+
+  // The culture the patterns were compiled for, held so its address cannot be reused by a new culture
+  FCulturePtr compiledCulture;
+
+  // Reused by every line, only grows
+  FString buffer;
+
+  // Compiles every pattern from the localized text of the current culture
+  void CompilePatterns();
+
+  void Compile(EChatFormat::Type format, const FText& pattern);
+
+  void AppendTimeStamp(FString& out, const FDateTime& time) const;
+
+  // Appends the pattern to out, appendArg(out, argIndex) appends the arguments
+  template<typename AppendArgType>
+  void AppendPattern(FString& out, EChatFormat::Type format, AppendArgType appendArg) const;
+};
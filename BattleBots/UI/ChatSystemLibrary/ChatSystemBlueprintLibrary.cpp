@@ -28,4 +28,59 @@ FString UChatSystemBlueprintLibrary::RealWorldTime__GetCurrentOSTime(
   Year = Now.GetYear();
 
   return Now.ToString();
-}
\ No newline at end of file
+}
+
+bool FChatWireMessage::NetSerialize(FArchive& Ar, class UPackageMap* Map, bool& bOutSuccess)
+{
+  uint32 Type = (uint32)MessageType;
+  Ar.SerializeBits(&Type, 3);
+
+  // System notices come from the server, not from a player
+  uint32 PackedSenderId = 0;
+  if ((EMessageType)Type != EMessageType::ESystem)
+  {
+    PackedSenderId = (uint32)SenderId;
+    Ar.SerializeIntPacked(PackedSenderId);
+  }
+
+  // Only whispers have a target, 0 means none
+  uint32 PackedRecieverId = 0;
+  if ((EMessageType)Type == EMessageType::EWhisper)
+  {
+    PackedRecieverId = RecieverId == INDEX_NONE ? 0 : (uint32)RecieverId + 1;
+    Ar.SerializeIntPacked(PackedRecieverId);
+  }
+
+  if (Ar.IsSaving())
+  {
+    FTCHARToUTF8 Utf8Message(*Message.Left(MaxChatMessageLength));
+    uint32 Utf8Length = (uint32)Utf8Message.Length();
+    Ar.SerializeIntPacked(Utf8Length);
+    Ar.Serialize((void*)Utf8Message.Get(), Utf8Length);
+  }
+  else
+  {
+    uint32 Utf8Length = 0;
+    Ar.SerializeIntPacked(Utf8Length);
+
+    // A UTF-8 character is at most 4 bytes
+    if (Utf8Length > (uint32)MaxChatMessageLength * 4)
+    {
+      bOutSuccess = false;
+      return true;
+    }
+
+    TArray<ANSICHAR> Utf8Message;
+    Utf8Message.AddUninitialized(Utf8Length + 1);
+    Ar.Serialize(Utf8Message.GetData(), Utf8Length);
+    Utf8Message[Utf8Length] = '\0';
+    Message = UTF8_TO_TCHAR(Utf8Message.GetData());
+
+    MessageType = (EMessageType)Type;
+    SenderId = (EMessageType)Type == EMessageType::ESystem ? INDEX_NONE : (int32)PackedSenderId;
+    RecieverId = PackedRecieverId == 0 ? INDEX_NONE : (int32)PackedRecieverId - 1;
+  }
+
+  bOutSuccess = !Ar.IsError();
+  return true;
+}
@@ -3,6 +3,7 @@
 #pragma once
 
 #include "Kismet/BlueprintFunctionLibrary.h"
+#include "BBotsChatFormatter.h"
 #include "ChatSystemBlueprintLibrary.generated.h"
 
 #define LOCTEXT_NAMESPACE "DisplayableTimeStamp"
@@ -13,6 +14,8 @@ enum class EMessageType :uint8{
   ETeam       UMETA(DisplayName = "Team"),
   EWhisper    UMETA(DisplayName = "Whisper"),
   EUnkown     UMETA(DisplayName = "Unkown"),
+  // Server notices to a single player, they have no sender
+  ESystem     UMETA(DisplayName = "System"),
 };
 
 USTRUCT(BlueprintType)
@@ -30,16 +33,17 @@ struct FTimeStamp{
 
   // Returns the displayable time stamp of the message
   FText GetTimeStampText(){
-    CurrentDateStamp = FDateTime::Now();
+    return GetTimeStampText(FBBotsChatFormatter::GetFrameTime());
+  }
+
+  // Returns the displayable time stamp of a message sent at Time
+  FText GetTimeStampText(const FDateTime& Time){
+    CurrentDateStamp = Time;
     Hour = CurrentDateStamp.GetHour12();
     Minutes = CurrentDateStamp.GetMinute();
     Seconds = CurrentDateStamp.GetSecond();
 
-    FText DisplayStamp = FText::Format(LOCTEXT("TimeStamp", "[{0}:{1}:{2}]"),
-      FText::AsNumber(Hour),
-      FText::AsNumber(Minutes),
-      FText::AsNumber(Seconds));
-    return DisplayStamp;
+    return FBBotsChatFormatter::Get().FormatTimeStamp(Time);
   }
 };
 
@@ -60,21 +64,121 @@ struct FChatMessageStruct{
     FSlateColor MessageColor;
   UPROPERTY(BlueprintReadWrite, Category = "ChatMessage")
     FText TimeStamp;
+  // When the message was received, in local time. TimeStamp is built from it when displayed.
+  UPROPERTY(BlueprintReadWrite, Category = "ChatMessage")
+    FDateTime SentTime;
   UPROPERTY(BlueprintReadWrite, Category = "ChatMessage")
     int32 TeamNumber;
   UPROPERTY(BlueprintReadWrite, Category = "ChatMessage")
     EMessageType MessageType;
 };
 
+// Players never send more than this many characters per message
+static const int32 MaxChatMessageLength = 512;
+
+/* A chat message as the server sends it. Players are sent as their PlayerId
+/ and the display text, timestamp text and color are built by the receiver. */
+USTRUCT()
+struct FChatWireMessage{
+  GENERATED_USTRUCT_BODY()
+
+  UPROPERTY()
+  EMessageType MessageType;
+  // INDEX_NONE for system notices
+  UPROPERTY()
+  int32 SenderId;
+  // Whisper target, INDEX_NONE for every other type
+  UPROPERTY()
+  int32 RecieverId;
+  UPROPERTY()
+  FString Message;
+
+  FChatWireMessage()
+    : MessageType(EMessageType::EAll), SenderId(0), RecieverId(INDEX_NONE)
+  {}
+
+  // Type in 3 bits, ids packed, the message as length prefixed UTF-8
+  bool NetSerialize(FArchive& Ar, class UPackageMap* Map, bool& bOutSuccess);
+};
+
+template<>
+struct TStructOpsTypeTraits<FChatWireMessage> : public TStructOpsTypeTraitsBase
+{
+  enum
+  {
+    WithNetSerializer = true,
+  };
+};
+
+// One line of the chat history, kept small since every widget holds a full ring of them
+struct FChatLogEntry{
+  // Names are interned, so repeated senders cost nothing
+  FName Sender;
+  FName Reciever;
+  FString Message;
+  // FDateTime ticks of when the message was logged
+  int64 TimeStampTicks;
+  EMessageType MessageType;
+
+  FChatLogEntry()
+    : TimeStampTicks(0), MessageType(EMessageType::EAll)
+  {}
+};
+
 // Logs all chat messages relevant to the player
 USTRUCT(BlueprintType)
 struct FChatLog{
   GENERATED_USTRUCT_BODY()
 
+  // Sent messages kept for up/down recall, the oldest gets overwritten
+  static const int32 Capacity = 64;
+
   UPROPERTY(BlueprintReadWrite, Category = "ChatMessage")
   FText LastSender;
-  UPROPERTY(BlueprintReadWrite, Category = "ChatMessage")
-  TArray<FChatMessageStruct> PreviousMessages;
+
+  FChatLog()
+    : Head(0), Count(0), Cursor(0)
+  {}
+
+  // Stores a sent message over the oldest one when full and moves the cursor back to it
+  void Add(const FChatMessageStruct& Message){
+    FChatLogEntry& Entry = Entries[Head];
+    Entry.Sender = FName(*Message.Sender.ToString());
+    Entry.Reciever = FName(*Message.Reciever.ToString());
+    Entry.Message = Message.Message.ToString();
+    Entry.TimeStampTicks = FBBotsChatFormatter::GetFrameTime().GetTicks();
+    Entry.MessageType = Message.MessageType;
+
+    Head = (Head + 1) % Capacity;
+    Count = FMath::Min(Count + 1, (int32)Capacity);
+    Cursor = 0;
+  }
+
+  /* Returns the message under the cursor, then steps the cursor towards older (up)
+  / or newer (down) messages. The cursor stops at both ends. Null when empty. */
+  const FChatLogEntry* Navigate(bool bOlder){
+    if (Count == 0)
+    {
+      return nullptr;
+    }
+
+    const FChatLogEntry* Entry = &Entries[(Head - 1 - Cursor + Capacity) % Capacity];
+    Cursor = bOlder ? FMath::Min(Cursor + 1, Count - 1) : FMath::Max(Cursor - 1, 0);
+    return Entry;
+  }
+
+  FORCEINLINE int32 Num() const { return Count; }
+
+  // Returns the logged message at index, 0 is the oldest
+  FORCEINLINE const FChatLogEntry& GetEntry(int32 Index) const { return Entries[(Head - Count + Index + Capacity) % Capacity]; }
+
+private:
+  FChatLogEntry Entries[Capacity];
+  // Slot the next message is written to
+  int32 Head;
+  int32 Count;
+  // Distance from the newest message, 0 is the newest
+  int32 Cursor;
 };
 
 /**
@@ -0,0 +1,67 @@
+// Copyright 2015 VMR Games, Inc. All Rights Reserved.
+
+#include "BattleBots.h"
+#include "BBotsResetRegistry.h"
+
+
+ABBotsResetRegistry::ABBotsResetRegistry()
+{
+  PrimaryActorTick.bCanEverTick = false;
+
+  // The registry lives on the server only
+  bReplicates = false;
+}
+
+void ABBotsResetRegistry::RegisterActor(AActor* actor, EResetPriority::Type priority)
+{
+  if (!actor || bucketIndices.Contains(actor))
+  {
+    return;
+  }
+
+  FBucketIndex bucketIndex;
+  bucketIndex.priority = (uint8)priority;
+  bucketIndex.index = buckets[priority].Add(actor);
+  bucketIndices.Add(actor, bucketIndex);
+}
+
+void ABBotsResetRegistry::UnregisterActor(AActor* actor)
+{
+  FBucketIndex bucketIndex;
+  if (!bucketIndices.RemoveAndCopyValue(actor, bucketIndex))
+  {
+    return;
+  }
+
+  TArray<TWeakObjectPtr<AActor>>& bucket = buckets[bucketIndex.priority];
+  bucket.RemoveAtSwap(bucketIndex.index, 1, false);
+
+  // Point the actor moved into the freed slot at its new index
+  if (bucketIndex.index < bucket.Num())
+  {
+    AActor* movedActor = bucket[bucketIndex.index].Get();
+    FBucketIndex* movedIndex = movedActor ? bucketIndices.Find(movedActor) : nullptr;
+    if (movedIndex)
+    {
+      movedIndex->index = bucketIndex.index;
+    }
+  }
+}
+
+void ABBotsResetRegistry::ResetActors()
+{
+  for (int32 priority = 0; priority < EResetPriority::EMax; priority++)
+  {
+    resetScratch = buckets[priority];
+
+    for (const TWeakObjectPtr<AActor>& actor : resetScratch)
+    {
+      if (actor.IsValid() && !actor->IsPendingKill())
+      {
+        IBBotsResetInterface::Execute_Reset(actor.Get());
+      }
+    }
+  }
+
+  resetScratch.Reset();
+}
@@ -0,0 +1,49 @@
+// Copyright 2015 VMR Games, Inc. All Rights Reserved.
+
+#pragma once
+
+#include "GameFramework/Info.h"
+#include "Interfaces/BBotsResetInterface.h"
+#include "BBotsResetRegistry.generated.h"
+
+/**
+ * ABBotsResetRegistry holds every actor that implements IBBotsResetInterface,
+ * bucketed by EResetPriority. Implementers register on BeginPlay and
+ * unregister on EndPlay, so a round reset only touches these actors instead
+ * of sweeping every actor of the map.
+ * The registry is owned by the game mode and only exists on the server.
+ */
+UCLASS()
+class BATTLEBOTS_API ABBotsResetRegistry : public AInfo
+{
+  GENERATED_BODY()
+
+public:
+  ABBotsResetRegistry();
+
+  void RegisterActor(AActor* actor, EResetPriority::Type priority);
+
+  void UnregisterActor(AActor* actor);
+
+  // Calls Reset on every registered actor, bucket by bucket in priority order
+  void ResetActors();
+
+  // Returns the number of registered actors
+  FORCEINLINE int32 GetNumActors() const { return bucketIndices.Num(); }
+
+private:
+  struct FBucketIndex
+  {
+    uint8 priority;
+    int32 index;
+  };
+
+  // Registered actors of each priority, removed with RemoveAtSwap
+  TArray<TWeakObjectPtr<AActor>> buckets[EResetPriority::EMax];
+
+  // Maps an actor to its slot in the buckets
+  TMap<const AActor*, FBucketIndex> bucketIndices;
+
+  // The bucket being reset, resets may register or unregister actors
+  TArray<TWeakObjectPtr<AActor>> resetScratch;
+};
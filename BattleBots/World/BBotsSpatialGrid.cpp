@@ -0,0 +1,232 @@
+// Copyright 2015 VMR Games, Inc. All Rights Reserved.
+
+#include "BattleBots.h"
+#include "Character/BBotCharacter.h"
+#include "BBotsSpatialGrid.h"
+
+
+ABBotsSpatialGrid::ABBotsSpatialGrid()
+{
+  PrimaryActorTick.bCanEverTick = true;
+  // Update after the characters moved this frame
+  PrimaryActorTick.TickGroup = TG_PostPhysics;
+
+  // The grid lives on the server only
+  bReplicates = false;
+
+  cellSize = 500.f;
+}
+
+void ABBotsSpatialGrid::Tick(float DeltaSeconds)
+{
+  BBOTS_SCOPE_CYCLE_COUNTER(SpatialGridTick);
+  Super::Tick(DeltaSeconds);
+
+  // Iterate backwards, destroyed characters are removed with RemoveAtSwap
+  for (int32 i = entries.Num() - 1; i >= 0; i--)
+  {
+    FGridEntry& entry = entries[i];
+    ABBotCharacter* character = entry.character.Get();
+
+    if (!character)
+    {
+      RemoveEntryAt(i);
+      continue;
+    }
+
+    entry.location = character->GetActorLocation();
+    entry.teamNum = GetCharacterTeam(character);
+
+    const FIntPoint newCell = GetCell(entry.location);
+    if (newCell != entry.cell)
+    {
+      // Crossed a cell border, move the entry to its new cell
+      TArray<int32>* oldCell = cells.Find(entry.cell);
+      if (oldCell)
+      {
+        oldCell->RemoveSingleSwap(i, false);
+        if (oldCell->Num() == 0)
+        {
+          cells.Remove(entry.cell);
+        }
+      }
+
+      entry.cell = newCell;
+      cells.FindOrAdd(newCell).Add(i);
+    }
+  }
+}
+
+void ABBotsSpatialGrid::RegisterCharacter(ABBotCharacter* character)
+{
+  if (!character || entryIndices.Contains(character))
+  {
+    return;
+  }
+
+  FGridEntry entry;
+  entry.character = character;
+  entry.key = character;
+  entry.location = character->GetActorLocation();
+  entry.cell = GetCell(entry.location);
+  entry.teamNum = GetCharacterTeam(character);
+
+  const int32 index = entries.Add(entry);
+  entryIndices.Add(character, index);
+  cells.FindOrAdd(entry.cell).Add(index);
+}
+
+void ABBotsSpatialGrid::UnregisterCharacter(ABBotCharacter* character)
+{
+  const int32* index = entryIndices.Find(character);
+
+  if (index)
+  {
+    RemoveEntryAt(*index);
+  }
+}
+
+int32 ABBotsSpatialGrid::QueryRadius(const FVector& center, float radius, TArray<ABBotCharacter*>& outCharacters, uint8 teamNum, EGridTeamFilter::Type teamFilter) const
+{
+  const int32 startNum = outCharacters.Num();
+
+  ForEachInRadius(center, radius, teamNum, teamFilter, [&](int32 index, float distSquared)
+  {
+    outCharacters.Add(entries[index].character.Get());
+  });
+
+  return outCharacters.Num() - startNum;
+}
+
+int32 ABBotsSpatialGrid::QueryNearest(const FVector& center, float maxRadius, int32 maxCount, TArray<ABBotCharacter*>& outCharacters, uint8 teamNum, EGridTeamFilter::Type teamFilter) const
+{
+  nearestScratch.Reset();
+
+  ForEachInRadius(center, maxRadius, teamNum, teamFilter, [&](int32 index, float distSquared)
+  {
+    nearestScratch.Add(TPair<float, int32>(distSquared, index));
+  });
+
+  nearestScratch.Sort([](const TPair<float, int32>& A, const TPair<float, int32>& B) { return A.Key < B.Key; });
+
+  const int32 numFound = FMath::Min(maxCount, nearestScratch.Num());
+  for (int32 i = 0; i < numFound; i++)
+  {
+    outCharacters.Add(entries[nearestScratch[i].Value].character.Get());
+  }
+
+  return numFound;
+}
+
+int32 ABBotsSpatialGrid::QueryCone(const FVector& origin, const FVector& direction, float halfAngle, float range, TArray<ABBotCharacter*>& outCharacters, uint8 teamNum, EGridTeamFilter::Type teamFilter) const
+{
+  const int32 startNum = outCharacters.Num();
+  const FVector coneDirection = direction.GetSafeNormal();
+  const float cosHalfAngle = FMath::Cos(FMath::DegreesToRadians(FMath::Clamp(halfAngle, 0.f, 180.f)));
+
+  ForEachInRadius(origin, range, teamNum, teamFilter, [&](int32 index, float distSquared)
+  {
+    const FVector toCharacter = entries[index].location - origin;
+
+    // A character standing on the origin is always inside the cone
+    if (distSquared < KINDA_SMALL_NUMBER || FVector::DotProduct(coneDirection, toCharacter.GetSafeNormal()) >= cosHalfAngle)
+    {
+      outCharacters.Add(entries[index].character.Get());
+    }
+  });
+
+  return outCharacters.Num() - startNum;
+}
+
+template<typename VisitorType>
+void ABBotsSpatialGrid::ForEachInRadius(const FVector& center, float radius, uint8 teamNum, EGridTeamFilter::Type teamFilter, VisitorType visitor) const
+{
+  const float radiusSquared = radius * radius;
+  const FIntPoint minCell = GetCell(center - FVector(radius, radius, 0.f));
+  const FIntPoint maxCell = GetCell(center + FVector(radius, radius, 0.f));
+
+  for (int32 x = minCell.X; x <= maxCell.X; x++)
+  {
+    for (int32 y = minCell.Y; y <= maxCell.Y; y++)
+    {
+      const TArray<int32>* cellEntries = cells.Find(FIntPoint(x, y));
+      if (!cellEntries)
+      {
+        continue;
+      }
+
+      for (int32 index : *cellEntries)
+      {
+        const FGridEntry& entry = entries[index];
+        const float distSquared = FVector::DistSquared(center, entry.location);
+
+        if (distSquared <= radiusSquared && entry.character.IsValid() && PassesTeamFilter(entry.teamNum, teamNum, teamFilter))
+        {
+          visitor(index, distSquared);
+        }
+      }
+    }
+  }
+}
+
+FIntPoint ABBotsSpatialGrid::GetCell(const FVector& location) const
+{
+  return FIntPoint(FMath::FloorToInt(location.X / cellSize), FMath::FloorToInt(location.Y / cellSize));
+}
+
+uint8 ABBotsSpatialGrid::GetCharacterTeam(const ABBotCharacter* character)
+{
+  return character->GetTeamNum();
+}
+
+bool ABBotsSpatialGrid::PassesTeamFilter(uint8 entryTeam, uint8 teamNum, EGridTeamFilter::Type teamFilter)
+{
+  switch (teamFilter)
+  {
+    case EGridTeamFilter::EAllies:
+      return entryTeam == teamNum;
+    case EGridTeamFilter::EEnemies:
+      return entryTeam != teamNum;
+    default:
+      return true;
+  }
+}
+
+void ABBotsSpatialGrid::RemoveEntryAt(int32 index)
+{
+  const FGridEntry& entry = entries[index];
+
+  TArray<int32>* cellEntries = cells.Find(entry.cell);
+  if (cellEntries)
+  {
+    cellEntries->RemoveSingleSwap(index, false);
+    if (cellEntries->Num() == 0)
+    {
+      cells.Remove(entry.cell);
+    }
+  }
+  entryIndices.Remove(entry.key);
+
+  const int32 lastIndex = entries.Num() - 1;
+  entries.RemoveAtSwap(index, 1, false);
+
+  // The last entry moved into the removed slot, update its index
+  if (index != lastIndex)
+  {
+    entryIndices.Add(entries[index].key, index);
+    ReindexCell(entries[index].cell, lastIndex, index);
+  }
+}
+
+void ABBotsSpatialGrid::ReindexCell(const FIntPoint& cell, int32 oldIndex, int32 newIndex)
+{
+  TArray<int32>* cellEntries = cells.Find(cell);
+  if (cellEntries)
+  {
+    const int32 position = cellEntries->Find(oldIndex);
+    if (position != INDEX_NONE)
+    {
+      (*cellEntries)[position] = newIndex;
+    }
+  }
+}
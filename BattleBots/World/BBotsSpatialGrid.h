@@ -0,0 +1,106 @@
+// Copyright 2015 VMR Games, Inc. All Rights Reserved.
+
+#pragma once
+
+#include "GameFramework/Info.h"
+#include "BBotsSpatialGrid.generated.h"
+
+class ABBotCharacter;
+
+// Team filter applied to spatial grid queries
+namespace EGridTeamFilter
+{
+  enum Type
+  {
+    // Every character
+    EAny,
+    // Only characters on the given team
+    EAllies,
+    // Only characters not on the given team
+    EEnemies,
+  };
+}
+
+/**
+ * ABBotsSpatialGrid is a uniform grid over the XY plane holding every living
+ * character. Characters are re-bucketed once per frame, and only when they
+ * cross a cell border. Spells use it for radius, k-nearest and cone queries
+ * instead of physics overlaps or scans over every pawn.
+ * The grid is owned by the game mode and only exists on the server.
+ */
+UCLASS()
+class BATTLEBOTS_API ABBotsSpatialGrid : public AInfo
+{
+  GENERATED_BODY()
+
+public:
+  ABBotsSpatialGrid();
+
+  // Moves characters that crossed a cell border to their new cell
+  virtual void Tick(float DeltaSeconds) override;
+
+  // Adds the character to the grid, called when the character spawns
+  void RegisterCharacter(ABBotCharacter* character);
+
+  // Removes the character from the grid, called when the character dies or is destroyed
+  void UnregisterCharacter(ABBotCharacter* character);
+
+  // Adds every character within radius of center to outCharacters, returns the number found
+  int32 QueryRadius(const FVector& center, float radius, TArray<ABBotCharacter*>& outCharacters, uint8 teamNum = 255, EGridTeamFilter::Type teamFilter = EGridTeamFilter::EAny) const;
+
+  // Adds up to maxCount characters within maxRadius of center to outCharacters, closest first
+  int32 QueryNearest(const FVector& center, float maxRadius, int32 maxCount, TArray<ABBotCharacter*>& outCharacters, uint8 teamNum = 255, EGridTeamFilter::Type teamFilter = EGridTeamFilter::EAny) const;
+
+  // Adds every character within range of origin and halfAngle degrees of direction to outCharacters
+  int32 QueryCone(const FVector& origin, const FVector& direction, float halfAngle, float range, TArray<ABBotCharacter*>& outCharacters, uint8 teamNum = 255, EGridTeamFilter::Type teamFilter = EGridTeamFilter::EAny) const;
+
+  // Returns the number of registered characters
+  FORCEINLINE int32 GetNumCharacters() const { return entries.Num(); }
+
+protected:
+  // The width of a grid cell, should be around the radius of a typical AOE
+  UPROPERTY(EditDefaultsOnly, Category = "Grid Config")
+  float cellSize;
+
+private:
+  struct FGridEntry
+  {
+    TWeakObjectPtr<ABBotCharacter> character;
+    // Kept as is so a destroyed character can still be unindexed
+    const ABBotCharacter* key;
+    FVector location;
+    FIntPoint cell;
+    uint8 teamNum;
+  };
+
+  // Packed grid entries, removed with RemoveAtSwap
+  TArray<FGridEntry> entries;
+
+  // Maps a character to its index in entries
+  TMap<const ABBotCharacter*, int32> entryIndices;
+
+  // Maps a cell to the indices of the entries inside it
+  TMap<FIntPoint, TArray<int32>> cells;
+
+  // Scratch space for the k-nearest query, reused to avoid allocations
+  mutable TArray<TPair<float, int32>> nearestScratch;
+
+  // Returns the cell that contains location
+  FIntPoint GetCell(const FVector& location) const;
+
+  // Returns the team of the character, 255 if it has none
+  static uint8 GetCharacterTeam(const ABBotCharacter* character);
+
+  // Returns true if the team passes the filter
+  static bool PassesTeamFilter(uint8 entryTeam, uint8 teamNum, EGridTeamFilter::Type teamFilter);
+
+  // Calls visitor with the index of every entry within radius of center that passes the team filter
+  template<typename VisitorType>
+  void ForEachInRadius(const FVector& center, float radius, uint8 teamNum, EGridTeamFilter::Type teamFilter, VisitorType visitor) const;
+
+  // Removes the entry at index from its cell and from the entries
+  void RemoveEntryAt(int32 index);
+
+  // Replaces oldIndex with newIndex in the cell's index list
+  void ReindexCell(const FIntPoint& cell, int32 oldIndex, int32 newIndex);
+};
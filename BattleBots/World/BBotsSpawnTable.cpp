@@ -0,0 +1,187 @@
+// Copyright 2015 VMR Games, Inc. All Rights Reserved.
+
+#include "BattleBots.h"
+#include "World/BBotsPlayerStart.h"
+#include "Character/BBotCharacter.h"
+#include "World/BBotsSpatialGrid.h"
+#include "SpellSystem/SpellAOEScheduler.h"
+#include "BattleBotsGameMode.h"
+#include "BBotsSpawnTable.h"
+
+
+ABBotsSpawnTable::ABBotsSpawnTable()
+{
+  PrimaryActorTick.bCanEverTick = true;
+
+  // The table lives on the server only
+  bReplicates = false;
+
+  enemyThreatRadius = 3000.f;
+  deathHeatRadius = 1500.f;
+  deathHeatHalfLife = 10.f;
+  aoeQueryPadding = 200.f;
+  claimCooldown = 2.f;
+  startsRefreshedPerTick = 4;
+  deathHeatWeight = 0.5f;
+  aoeDpsWeight = 0.02f;
+  claimWeight = 2.f;
+
+  refreshCursor = 0;
+  bBuilt = false;
+}
+
+void ABBotsSpawnTable::BeginPlay()
+{
+  Super::BeginPlay();
+
+  BuildTable();
+}
+
+void ABBotsSpawnTable::Tick(float DeltaSeconds)
+{
+  Super::Tick(DeltaSeconds);
+
+  const int32 numToRefresh = FMath::Min(startsRefreshedPerTick, spawnPoints.Num());
+  for (int32 i = 0; i < numToRefresh; i++)
+  {
+    refreshCursor = (refreshCursor + 1) % spawnPoints.Num();
+    RefreshThreat(spawnPoints[refreshCursor]);
+  }
+}
+
+void ABBotsSpawnTable::BuildTable()
+{
+  if (bBuilt)
+  {
+    return;
+  }
+  bBuilt = true;
+
+  for (TActorIterator<ABBotsPlayerStart> It(GetWorld()); It; ++It)
+  {
+    FSpawnPoint point;
+    point.start = *It;
+    point.location = It->GetActorLocation();
+    point.teamNum = It->GetTeamNum();
+    point.threatScore = 1.f;
+    point.deathHeat = 0.f;
+    point.lastHeatTime = 0.f;
+    point.claimTime = -claimCooldown;
+
+    teamStarts.FindOrAdd(point.teamNum).Add(spawnPoints.Add(point));
+  }
+
+  for (FSpawnPoint& point : spawnPoints)
+  {
+    RefreshThreat(point);
+  }
+
+  // Nothing to refresh on maps without team starts
+  SetActorTickEnabled(spawnPoints.Num() > 0);
+}
+
+ABBotsPlayerStart* ABBotsSpawnTable::ChoosePlayerStart(uint8 teamNum)
+{
+  // Players can log in before BeginPlay
+  BuildTable();
+
+  const TArray<int32>* starts = teamStarts.Find(teamNum);
+  if (!starts)
+  {
+    return nullptr;
+  }
+
+  const float currentTime = GetWorld()->GetTimeSeconds();
+  FSpawnPoint* bestPoint = nullptr;
+  float bestScore = -BIG_NUMBER;
+
+  for (int32 index : *starts)
+  {
+    FSpawnPoint& point = spawnPoints[index];
+    if (!point.start.IsValid())
+    {
+      continue;
+    }
+
+    const float score = GetScore(point, currentTime);
+    if (score > bestScore)
+    {
+      bestScore = score;
+      bestPoint = &point;
+    }
+  }
+
+  if (!bestPoint)
+  {
+    return nullptr;
+  }
+
+  bestPoint->claimTime = currentTime;
+  return bestPoint->start.Get();
+}
+
+void ABBotsSpawnTable::RecordDeath(const FVector& location)
+{
+  if (deathHeatRadius <= 0.f)
+  {
+    return;
+  }
+
+  const float currentTime = GetWorld()->GetTimeSeconds();
+
+  // Deaths are rare next to the refreshes, a pass over every start is cheaper than indexing them
+  for (FSpawnPoint& point : spawnPoints)
+  {
+    const float dist = FVector::Dist(point.location, location);
+    if (dist < deathHeatRadius)
+    {
+      point.deathHeat = GetDecayedHeat(point, currentTime) + 1.f - dist / deathHeatRadius;
+      point.lastHeatTime = currentTime;
+    }
+  }
+}
+
+void ABBotsSpawnTable::RefreshThreat(FSpawnPoint& point)
+{
+  ABattleBotsGameMode* GM = GetWorld()->GetAuthGameMode<ABattleBotsGameMode>();
+  ABBotsSpatialGrid* spatialGrid = GM ? GM->GetSpatialGrid() : nullptr;
+  ASpellAOEScheduler* aoeScheduler = GM ? GM->GetAOEScheduler() : nullptr;
+
+  // 1 with no enemy in range, down to 0 with an enemy standing on the start
+  float enemyScore = 1.f;
+  if (spatialGrid && enemyThreatRadius > 0.f)
+  {
+    enemyScratch.Reset();
+    if (spatialGrid->QueryNearest(point.location, enemyThreatRadius, 1, enemyScratch, point.teamNum, EGridTeamFilter::EEnemies) > 0 && enemyScratch[0])
+    {
+      enemyScore = FVector::Dist(point.location, enemyScratch[0]->GetActorLocation()) / enemyThreatRadius;
+    }
+  }
+
+  const float aoeDps = aoeScheduler ? aoeScheduler->GetEnemyDpsAt(point.location, aoeQueryPadding, point.teamNum) : 0.f;
+
+  point.threatScore = FMath::Min(enemyScore, 1.f) - aoeDps * aoeDpsWeight;
+}
+
+float ABBotsSpawnTable::GetDecayedHeat(const FSpawnPoint& point, float currentTime) const
+{
+  if (point.deathHeat <= 0.f || deathHeatHalfLife <= 0.f)
+  {
+    return 0.f;
+  }
+  return point.deathHeat * FMath::Pow(0.5f, (currentTime - point.lastHeatTime) / deathHeatHalfLife);
+}
+
+float ABBotsSpawnTable::GetScore(const FSpawnPoint& point, float currentTime) const
+{
+  float score = point.threatScore - GetDecayedHeat(point, currentTime) * deathHeatWeight;
+
+  // Fades out over the cooldown, so a fully claimed team still spreads over its starts
+  const float claimAge = currentTime - point.claimTime;
+  if (claimCooldown > 0.f && claimAge < claimCooldown)
+  {
+    score -= claimWeight * (1.f - claimAge / claimCooldown);
+  }
+
+  return score;
+}
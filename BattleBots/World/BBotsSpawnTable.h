@@ -0,0 +1,117 @@
+// Copyright 2015 VMR Games, Inc. All Rights Reserved.
+
+#pragma once
+
+#include "GameFramework/Info.h"
+#include "BBotsSpawnTable.generated.h"
+
+class ABBotsPlayerStart;
+class ABBotCharacter;
+
+/**
+ * ABBotsSpawnTable indexes the player starts of the map by team, once per
+ * map, and keeps a safety score for each of them: the distance to the
+ * closest living enemy, enemy AOE volumes covering the start and a heat
+ * that builds up where players recently died and decays over time.
+ * Scores are refreshed a few starts per tick from the spatial grid, so
+ * choosing a start only compares the cached scores of the player's team.
+ * The table is owned by the game mode and only exists on the server.
+ */
+UCLASS()
+class BATTLEBOTS_API ABBotsSpawnTable : public AInfo
+{
+  GENERATED_BODY()
+
+public:
+  ABBotsSpawnTable();
+
+  // Builds the table from the player starts of the map
+  virtual void BeginPlay() override;
+
+  // Refreshes the scores of the next few starts
+  virtual void Tick(float DeltaSeconds) override;
+
+  // Returns the best scored start of teamNum and claims it, null if the team has no start
+  ABBotsPlayerStart* ChoosePlayerStart(uint8 teamNum);
+
+  // Heats up the starts near a death location
+  void RecordDeath(const FVector& location);
+
+  // Returns the number of indexed starts
+  FORCEINLINE int32 GetNumStarts() const { return spawnPoints.Num(); }
+
+protected:
+  // Enemies further away than this do not lower the score of a start
+  UPROPERTY(EditDefaultsOnly, Category = "Spawn Config")
+  float enemyThreatRadius;
+
+  // Deaths within this radius heat up a start, scaled down with distance
+  UPROPERTY(EditDefaultsOnly, Category = "Spawn Config")
+  float deathHeatRadius;
+
+  // Seconds for the death heat of a start to halve
+  UPROPERTY(EditDefaultsOnly, Category = "Spawn Config")
+  float deathHeatHalfLife;
+
+  // Added to the AOE volume radius, should cover the widest character capsule
+  UPROPERTY(EditDefaultsOnly, Category = "Spawn Config")
+  float aoeQueryPadding;
+
+  // Seconds a chosen start is avoided, spreads the players of a mass respawn over the team starts
+  UPROPERTY(EditDefaultsOnly, Category = "Spawn Config")
+  float claimCooldown;
+
+  // Number of starts rescored each tick
+  UPROPERTY(EditDefaultsOnly, Category = "Spawn Config")
+  int32 startsRefreshedPerTick;
+
+  // Score weights, a start scores 1 with no enemy in range and loses the weighted threats
+  UPROPERTY(EditDefaultsOnly, Category = "Spawn Config")
+  float deathHeatWeight;
+
+  UPROPERTY(EditDefaultsOnly, Category = "Spawn Config")
+  float aoeDpsWeight;
+
+  UPROPERTY(EditDefaultsOnly, Category = "Spawn Config")
+  float claimWeight;
+
+private:
+  struct FSpawnPoint
+  {
+    TWeakObjectPtr<ABBotsPlayerStart> start;
+    FVector location;
+    uint8 teamNum;
+    // Enemy distance and AOE part of the score, refreshed from the grid
+    float threatScore;
+    // Death heat at lastHeatTime, decayed lazily
+    float deathHeat;
+    float lastHeatTime;
+    float claimTime;
+  };
+
+  // Every indexed start, never reordered after the build
+  TArray<FSpawnPoint> spawnPoints;
+
+  // The indices of the starts of each team
+  TMap<uint8, TArray<int32>> teamStarts;
+
+  // The next start to rescore
+  int32 refreshCursor;
+
+  bool bBuilt;
+
+  // Enemies near the start being rescored, reused to avoid allocations
+  TArray<ABBotCharacter*> enemyScratch;
+
+  // Indexes every ABBotsPlayerStart of the world
+  void BuildTable();
+
+  // Refreshes the enemy distance and AOE threat of a start
+  void RefreshThreat(FSpawnPoint& point);
+
+  // Returns the death heat of a start at currentTime
+  float GetDecayedHeat(const FSpawnPoint& point, float currentTime) const;
+
+  // Returns the current score of a start, higher is safer
+  float GetScore(const FSpawnPoint& point, float currentTime) const;
+};
@@ -0,0 +1,144 @@
+// Copyright 2015 VMR Games, Inc. All Rights Reserved.
+
+#include "UI/ChatSystemLibrary/BBotsChatCommand.h"
+
+#include <algorithm>
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <cwctype>
+#include <new>
+#include <string>
+#include <vector>
+
+/**
+ * Reports ns/message, MB/s and heap allocations per message for the chat
+ * command parser, next to a baseline that splits and copies strings the way
+ * UChatBlockWidget::ParseMessageData used to. Usage: ChatBench [iterations]
+ */
+
+namespace
+{
+  uint64_t numAllocations = 0;
+
+  volatile int64_t sink;
+
+  // A lobby worth of typed lines, mixed like real chat
+  const wchar_t* const sampleLines[] =
+  {
+    L"gg",
+    L"anyone up for a rematch after this one?",
+    L"/t push mid, their sorcerer is on cooldown",
+    L"/team fall back to the tower",
+    L"/w Lancer42 nice block",
+    L"/whisper SorcererMain where did you learn that combo",
+    L"/all good luck have fun",
+    L"/a ty",
+    L"/r haha thanks",
+    L"/wh typo in the command",
+    L"/T caps still works",
+    L"lol",
+  };
+  const int32_t numSampleLines = sizeof(sampleLines) / sizeof(sampleLines[0]);
+
+  // The previous parser: FString::Split copies, ToLower copies and a linear command scan
+  int64_t ParseBaseline(const std::wstring& line)
+  {
+    static const std::vector<std::wstring> messageTypes = { L"/a", L"/t", L"/w", L"/all", L"/whisper", L"/team" };
+
+    if (line.empty() || line[0] != L'/')
+    {
+      return (int64_t)std::wstring(line).size();
+    }
+
+    const size_t space = line.find(L' ');
+    std::wstring command = space == std::wstring::npos ? std::wstring() : line.substr(0, space);
+    std::wstring message = space == std::wstring::npos ? std::wstring() : line.substr(space + 1);
+
+    std::wstring lowerCommand = command;
+    std::transform(lowerCommand.begin(), lowerCommand.end(), lowerCommand.begin(), [](wchar_t c) { return (wchar_t)std::towlower(c); });
+    if (std::find(messageTypes.begin(), messageTypes.end(), lowerCommand) == messageTypes.end())
+    {
+      return (int64_t)(command + L" is an invalid command").size();
+    }
+
+    if (lowerCommand == L"/w" || lowerCommand == L"/whisper")
+    {
+      const size_t recieverEnd = message.find(L' ');
+      std::wstring reciever = message.substr(0, recieverEnd);
+      std::wstring text = recieverEnd == std::wstring::npos ? std::wstring() : message.substr(recieverEnd + 1);
+      return (int64_t)(reciever.size() + text.size());
+    }
+    return (int64_t)std::wstring(message).size();
+  }
+
+  int64_t ParseTrie(const std::wstring& line)
+  {
+    const BBotsChat::TParsedChat<wchar_t> parsed = BBotsChat::Parse(line.data(), (int32_t)line.size());
+    return (int64_t)parsed.command + parsed.reciever.length + parsed.message.length;
+  }
+
+  template <typename Func>
+  void Run(const char* name, const std::vector<std::wstring>& lines, int64_t iterations, Func func)
+  {
+    size_t totalChars = 0;
+    for (const std::wstring& line : lines)
+    {
+      totalChars += line.size();
+    }
+
+    // Warm up caches and branch predictors
+    for (const std::wstring& line : lines)
+    {
+      sink = func(line);
+    }
+
+    const uint64_t allocationsBefore = numAllocations;
+    const auto start = std::chrono::steady_clock::now();
+
+    int64_t checksum = 0;
+    for (int64_t i = 0; i < iterations; i++)
+    {
+      checksum += func(lines[i % lines.size()]);
+    }
+    sink = checksum;
+
+    const double elapsedNs = (double)std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now() - start).count();
+    const double bytesParsed = (double)totalChars * sizeof(wchar_t) * ((double)iterations / lines.size());
+
+    std::printf("%-10s %10.2f ns/msg %10.1f MB/s %8.2f allocs/msg\n", name, elapsedNs / iterations,
+      bytesParsed / elapsedNs * 1000.0, (double)(numAllocations - allocationsBefore) / iterations);
+  }
+}
+
+// Counts every heap allocation of the process
+void* operator new(size_t size)
+{
+  numAllocations++;
+  if (void* memory = std::malloc(size ? size : 1))
+  {
+    return memory;
+  }
+  throw std::bad_alloc();
+}
+
+void operator delete(void* memory) noexcept
+{
+  std::free(memory);
+}
+
+int main(int argc, char** argv)
+{
+  const int64_t iterations = argc > 1 ? std::atoll(argv[1]) : 10000000;
+  if (iterations <= 0)
+  {
+    std::fprintf(stderr, "Usage: %s [iterations]\n", argv[0]);
+    return 1;
+  }
+
+  const std::vector<std::wstring> lines(sampleLines, sampleLines + numSampleLines);
+
+  Run("Baseline", lines, iterations, ParseBaseline);
+  Run("Trie", lines, iterations, ParseTrie);
+  return 0;
+}
@@ -0,0 +1,189 @@
+// Copyright 2015 VMR Games, Inc. All Rights Reserved.
+
+#include "Combat/BBotCombatMath.h"
+
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <vector>
+
+/**
+ * Reports ns/op for the hot combat paths: damage resolution, attribute
+ * folds and DoT ticking. Inputs are generated up front from a fixed seed
+ * so runs are comparable, and every result feeds a sink the optimizer
+ * cannot drop. Usage: CombatBench [iterations]
+ */
+
+namespace
+{
+  const int32_t InputCount = 4096;
+  // Stance, spell, item
+  const int32_t LayerCount = 3;
+
+  volatile float sink;
+
+  // Small LCG, the inputs only need to be varied and reproducible
+  struct FRandom
+  {
+    uint32_t state;
+
+    explicit FRandom(uint32_t seed) : state(seed) {}
+
+    float Range(float minValue, float maxValue)
+    {
+      state = state * 1664525u + 1013904223u;
+      return minValue + (maxValue - minValue) * ((state >> 8) / 16777216.f);
+    }
+  };
+
+  struct FHit
+  {
+    float damage;
+    float bonusDamage;
+    float resist;
+  };
+
+  struct FBenchResult
+  {
+    const char* name;
+    double nsPerOp;
+  };
+
+  template <typename Func>
+  FBenchResult Run(const char* name, int64_t iterations, Func func)
+  {
+    // Warm up caches and branch predictors
+    func(iterations / 10 + 1);
+
+    const auto start = std::chrono::steady_clock::now();
+    func(iterations);
+    const auto end = std::chrono::steady_clock::now();
+
+    const double elapsedNs = (double)std::chrono::duration_cast<std::chrono::nanoseconds>(end - start).count();
+    FBenchResult result = { name, elapsedNs / (double)iterations };
+    return result;
+  }
+}
+
+int main(int argc, char** argv)
+{
+  const int64_t iterations = argc > 1 ? std::atoll(argv[1]) : 20000000;
+  if (iterations <= 0)
+  {
+    std::fprintf(stderr, "Usage: %s [iterations]\n", argv[0]);
+    return 1;
+  }
+
+  FRandom random(0xB807);
+
+  std::vector<FHit> hits(InputCount);
+  for (FHit& hit : hits)
+  {
+    hit.damage = random.Range(10.f, 500.f);
+    hit.bonusDamage = random.Range(-1.f, 1.f);
+    hit.resist = random.Range(-1.5f, 1.5f);
+  }
+
+  std::vector<BBotCombat::FAttributeLayer> layers(InputCount * LayerCount);
+  for (BBotCombat::FAttributeLayer& layer : layers)
+  {
+    layer.movSpeedMod = random.Range(-0.6f, 0.6f);
+    layer.blockRate = random.Range(-0.2f, 0.6f);
+    layer.globalCooldown = random.Range(-0.2f, 0.2f);
+    for (int32_t element = 0; element < BBotCombat::ElementCount; element++)
+    {
+      layer.resists[element] = random.Range(-0.4f, 0.6f);
+      layer.bonusDamage[element] = random.Range(-0.4f, 0.6f);
+    }
+  }
+
+  std::vector<BBotCombat::FDotTimer> dots(InputCount);
+  for (BBotCombat::FDotTimer& dot : dots)
+  {
+    const float tickInterval = random.Range(0.25f, 1.f);
+    dot.Start(0.f, tickInterval, BBotCombat::GetDotFirstTickDelay(tickInterval), 1e9f);
+  }
+
+  const int32_t mask = InputCount - 1;
+  FBenchResult results[5];
+  int32_t resultCount = 0;
+
+  results[resultCount++] = Run("ResolveDamage", iterations, [&](int64_t count) {
+    float total = 0.f;
+    for (int64_t i = 0; i < count; i++)
+    {
+      const FHit& hit = hits[i & mask];
+      total += BBotCombat::ResolveDamage(hit.damage, hit.bonusDamage, hit.resist);
+    }
+    sink = total;
+  });
+
+  results[resultCount++] = Run("FoldResist", iterations, [&](int64_t count) {
+    float total = 0.f;
+    for (int64_t i = 0; i < count; i++)
+    {
+      const int32_t index = (int32_t)(i & mask);
+      total += BBotCombat::FoldResist(hits[index].resist, &layers[index * LayerCount], LayerCount, index % BBotCombat::ElementCount);
+    }
+    sink = total;
+  });
+
+  // Every field of a fully dirty attribute stack, one op is one character
+  results[resultCount++] = Run("FoldAllFields", iterations / 8, [&](int64_t count) {
+    float total = 0.f;
+    for (int64_t i = 0; i < count; i++)
+    {
+      const int32_t index = (int32_t)(i & mask);
+      const BBotCombat::FAttributeLayer* characterLayers = &layers[index * LayerCount];
+      total += BBotCombat::FoldMovementSpeed(600.f, characterLayers, LayerCount);
+      total += BBotCombat::FoldBlockRate(0.1f, characterLayers, LayerCount);
+      total += BBotCombat::FoldGlobalCooldown(1.f, characterLayers, LayerCount);
+      for (int32_t element = 0; element < BBotCombat::ElementCount; element++)
+      {
+        total += BBotCombat::FoldResist(0.f, characterLayers, LayerCount, element);
+        total += BBotCombat::FoldBonusDamage(0.f, characterLayers, LayerCount, element);
+      }
+    }
+    sink = total;
+  });
+
+  // One op is one DoT checked on a 60 Hz server frame
+  results[resultCount++] = Run("DotTick", iterations, [&](int64_t count) {
+    float total = 0.f;
+    float currentTime = 0.f;
+    for (int64_t i = 0; i < count; i++)
+    {
+      const int32_t index = (int32_t)(i & mask);
+      if (index == 0)
+      {
+        currentTime += 1.f / 60.f;
+      }
+
+      BBotCombat::FDotTimer& dot = dots[index];
+      if (!dot.IsExpired(currentTime) && dot.ConsumeTick(currentTime))
+      {
+        total += hits[index].damage;
+      }
+    }
+    sink = total;
+  });
+
+  results[resultCount++] = Run("DotDamagePerTick", iterations, [&](int64_t count) {
+    float total = 0.f;
+    for (int64_t i = 0; i < count; i++)
+    {
+      const FHit& hit = hits[i & mask];
+      total += BBotCombat::GetDotDamagePerTick(hit.damage, 4.f, 0.5f, hit.bonusDamage);
+    }
+    sink = total;
+  });
+
+  std::printf("%-20s %12s\n", "benchmark", "ns/op");
+  for (int32_t i = 0; i < resultCount; i++)
+  {
+    std::printf("%-20s %12.3f\n", results[i].name, results[i].nsPerOp);
+  }
+
+  return 0;
+}
@@ -0,0 +1,249 @@
+// Copyright 2015 VMR Games, Inc. All Rights Reserved.
+
+#include "Combat/BBotCombatLogFormat.h"
+
+#include <chrono>
+#include <cinttypes>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <map>
+
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+/**
+ * Maps a server combat log (Saved/CombatLogs/CombatLog-<date>.bbcl) and scans it in place.
+ * Usage: CombatLogReader <log> [--type name] [--source id] [--target id] [--dump]
+ * Prints the event counts and per actor damage, kills and deaths of the
+ * matching events, --dump also prints every matching event. Actors are
+ * printed and filtered as p<player id> or o<object id>, a bare number is a player id.
+ */
+
+namespace
+{
+  using namespace BBotCombatLog;
+
+  const char* const eventTypeNames[(int)EEventType::EMax] =
+  {
+    "cast_start", "cast_finish", "projectile_spawn", "hit", "damage", "dot_tick", "death", "stance_switch",
+  };
+
+  // Same order as EDamageElement
+  const char* const elementNames[NoElement + 1] = { "physical", "fire", "ice", "lightning", "holy", "poison", "none" };
+
+  struct FFilter
+  {
+    int type;
+    int64_t sourceId;
+    int64_t targetId;
+    bool bDump;
+
+    FFilter() : type(-1), sourceId(-1), targetId(-1), bDump(false) {}
+
+    bool Matches(const FCombatLogEvent& event) const
+    {
+      return (type < 0 || (int)event.type == type)
+        && (sourceId < 0 || event.sourceId == (uint32_t)sourceId)
+        && (targetId < 0 || event.targetId == (uint32_t)targetId);
+    }
+  };
+
+  struct FPlayerStats
+  {
+    double damageDealt;
+    double damageTaken;
+    uint64_t kills;
+    uint64_t deaths;
+  };
+
+  // Formats an actor id as p<player id>, o<object id> or - for none
+  const char* FormatActorId(uint32_t id, char (&buffer)[16])
+  {
+    if (id == NoActor)
+    {
+      return "-";
+    }
+    std::snprintf(buffer, sizeof(buffer), "%c%u", (id & ObjectIdFlag) ? 'o' : 'p', id & ~ObjectIdFlag);
+    return buffer;
+  }
+
+  // Parses the FormatActorId form back into an id
+  int64_t ParseActorId(const char* text)
+  {
+    if (text[0] == 'o')
+    {
+      return (int64_t)(std::strtoul(text + 1, nullptr, 10) | ObjectIdFlag);
+    }
+    return std::strtoll(text[0] == 'p' ? text + 1 : text, nullptr, 10);
+  }
+
+  const char* GetElementName(uint8_t element)
+  {
+    return element <= NoElement ? elementNames[element] : "?";
+  }
+
+  void DumpEvent(const FCombatLogEvent& event)
+  {
+    char sourceBuffer[16], targetBuffer[16];
+    std::printf("%10.3f %-16s src %11s tgt %11s spell %08x %-9s value %9.2f resist %5.2f extra %u\n",
+      event.timeMs / 1000.0, (int)event.type < (int)EEventType::EMax ? eventTypeNames[(int)event.type] : "?",
+      FormatActorId(event.sourceId, sourceBuffer), FormatActorId(event.targetId, targetBuffer), event.spellId, GetElementName(event.element), event.value, event.resist, event.extra);
+  }
+
+  void PrintUsage(const char* program)
+  {
+    std::fprintf(stderr, "Usage: %s <log> [--type name] [--source id] [--target id] [--dump]\n", program);
+  }
+}
+
+int main(int argc, char** argv)
+{
+  if (argc < 2)
+  {
+    PrintUsage(argv[0]);
+    return 1;
+  }
+
+  FFilter filter;
+  for (int i = 2; i < argc; i++)
+  {
+    const bool bHasValue = i + 1 < argc;
+    if (std::strcmp(argv[i], "--dump") == 0)
+    {
+      filter.bDump = true;
+    }
+    else if (bHasValue && std::strcmp(argv[i], "--type") == 0)
+    {
+      const char* typeName = argv[++i];
+      for (int type = 0; type < (int)EEventType::EMax; type++)
+      {
+        if (std::strcmp(typeName, eventTypeNames[type]) == 0)
+        {
+          filter.type = type;
+        }
+      }
+      if (filter.type < 0)
+      {
+        std::fprintf(stderr, "Unknown event type '%s'\n", typeName);
+        return 1;
+      }
+    }
+    else if (bHasValue && std::strcmp(argv[i], "--source") == 0) filter.sourceId = ParseActorId(argv[++i]);
+    else if (bHasValue && std::strcmp(argv[i], "--target") == 0) filter.targetId = ParseActorId(argv[++i]);
+    else
+    {
+      PrintUsage(argv[0]);
+      return 1;
+    }
+  }
+
+  const int fd = open(argv[1], O_RDONLY);
+  struct stat fileStat;
+  if (fd < 0 || fstat(fd, &fileStat) != 0)
+  {
+    std::fprintf(stderr, "Cannot open %s\n", argv[1]);
+    return 1;
+  }
+
+  const size_t fileSize = (size_t)fileStat.st_size;
+  if (fileSize < sizeof(FCombatLogFileHeader))
+  {
+    std::fprintf(stderr, "%s is not a combat log\n", argv[1]);
+    return 1;
+  }
+
+  void* mapping = mmap(nullptr, fileSize, PROT_READ, MAP_PRIVATE, fd, 0);
+  close(fd);
+  if (mapping == MAP_FAILED)
+  {
+    std::fprintf(stderr, "Cannot map %s\n", argv[1]);
+    return 1;
+  }
+  madvise(mapping, fileSize, MADV_SEQUENTIAL);
+
+  const FCombatLogFileHeader* header = (const FCombatLogFileHeader*)mapping;
+  if (header->magic != FileMagic || header->version != FileVersion || header->eventSize != sizeof(FCombatLogEvent))
+  {
+    std::fprintf(stderr, "%s is not a version %u combat log\n", argv[1], FileVersion);
+    munmap(mapping, fileSize);
+    return 1;
+  }
+
+  // A log of a crashed server may end with a partial event
+  const size_t eventCount = (fileSize - sizeof(FCombatLogFileHeader)) / sizeof(FCombatLogEvent);
+  const FCombatLogEvent* events = (const FCombatLogEvent*)((const uint8_t*)mapping + sizeof(FCombatLogFileHeader));
+
+  uint64_t typeCounts[(int)EEventType::EMax] = {};
+  double elementDamage[NoElement + 1] = {};
+  uint64_t matchedEvents = 0;
+  uint32_t lastTimeMs = 0;
+  std::map<uint32_t, FPlayerStats> players;
+
+  const auto start = std::chrono::steady_clock::now();
+
+  for (size_t i = 0; i < eventCount; i++)
+  {
+    const FCombatLogEvent& event = events[i];
+    if (!filter.Matches(event) || (int)event.type >= (int)EEventType::EMax)
+    {
+      continue;
+    }
+
+    matchedEvents++;
+    typeCounts[(int)event.type]++;
+    lastTimeMs = event.timeMs;
+
+    if (event.type == EEventType::EDamage)
+    {
+      players[event.sourceId].damageDealt += event.value;
+      players[event.targetId].damageTaken += event.value;
+      elementDamage[event.element <= NoElement ? event.element : NoElement] += event.value;
+    }
+    else if (event.type == EEventType::EDeath)
+    {
+      players[event.sourceId].kills++;
+      players[event.targetId].deaths++;
+    }
+
+    if (filter.bDump)
+    {
+      DumpEvent(event);
+    }
+  }
+
+  const double elapsedSeconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+
+  std::printf("%s: match started at unix time %" PRId64 ", %zu events, %" PRIu64 " matching, last at %.3fs\n",
+    argv[1], header->startTime, eventCount, matchedEvents, lastTimeMs / 1000.0);
+  std::printf("Scanned in %.3fs (%.1fM events/s)\n", elapsedSeconds, elapsedSeconds > 0.0 ? eventCount / elapsedSeconds / 1e6 : 0.0);
+
+  std::printf("\nEvents\n");
+  for (int type = 0; type < (int)EEventType::EMax; type++)
+  {
+    std::printf("  %-18s %12" PRIu64 "\n", eventTypeNames[type], typeCounts[type]);
+  }
+
+  std::printf("\nDamage by element\n");
+  for (int element = 0; element <= NoElement; element++)
+  {
+    if (elementDamage[element] > 0.0)
+    {
+      std::printf("  %-18s %12.1f\n", elementNames[element], elementDamage[element]);
+    }
+  }
+
+  std::printf("\nActors (- is the world)\n");
+  std::printf("  %11s %14s %14s %8s %8s\n", "id", "damage dealt", "damage taken", "kills", "deaths");
+  for (const auto& player : players)
+  {
+    char idBuffer[16];
+    std::printf("  %11s %14.1f %14.1f %8" PRIu64 " %8" PRIu64 "\n", FormatActorId(player.first, idBuffer),
+      player.second.damageDealt, player.second.damageTaken, player.second.kills, player.second.deaths);
+  }
+
+  munmap(mapping, fileSize);
+  return 0;
+}
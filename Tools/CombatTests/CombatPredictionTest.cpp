@@ -0,0 +1,289 @@
+// Copyright 2015 VMR Games, Inc. All Rights Reserved.
+
+#include "Combat/BBotCombatMath.h"
+
+#include <cmath>
+#include <cstdio>
+#include <deque>
+#include <vector>
+
+/**
+ * Replays the owner side cast prediction of ABBotCharacter against a server
+ * over a lagged connection, with the cooldown functions the game uses
+ * (IsCooldownReady, PredictCooldown, RollbackCooldown). The owner's world
+ * clock starts at a different time than the server's. Its estimate of the
+ * server time is corrected from replicated server time samples, like
+ * AGameState::GetServerWorldTimeSeconds. The server rejects some casts for
+ * reasons other than cooldowns, so rollbacks race the replicated cooldowns.
+ */
+
+namespace
+{
+  int32_t numFailures = 0;
+
+  struct FConfig
+  {
+    // Client world time minus server world time
+    float skew;
+    // One way latency in seconds
+    float latency;
+    // The server rejects every n-th cast, 0 for never
+    int32_t rejectEvery;
+  };
+
+  void Check(bool bCondition, const char* what, const FConfig& config, float time)
+  {
+    if (!bCondition)
+    {
+      std::fprintf(stderr, "FAILED: %s (skew %.2f s, latency %.2f s, reject every %d, server time %.2f s)\n",
+        what, config.skew, config.latency, config.rejectEvery, time);
+      numFailures++;
+    }
+  }
+
+  // Not multiples of the step, so no sample lands on the exact ready time the float rounding could flip
+  const float GlobalCooldown = 1.02f;
+  const float SpellCooldowns[] = { 3.02f, 0.52f };
+  const int32_t NumSpells = 2;
+  const float TimeSyncInterval = 1.f;
+  const int32_t StepsPerSecond = 100;
+  const float CastingSeconds = 15.f;
+  const float TotalSeconds = 20.f;
+
+  struct FCooldowns
+  {
+    float gcd;
+    float spellCDs[NumSpells];
+  };
+
+  namespace EMessage
+  {
+    enum Type
+    {
+      // Owner to server
+      ECast,
+      // Server to owner
+      EReplicatedCooldowns,
+      EConfirm,
+      EReject,
+      ETimeSync,
+    };
+  }
+
+  struct FMessage
+  {
+    float deliveryTime;
+    EMessage::Type type;
+    int32_t key;
+    int32_t spellIndex;
+    float serverTime;
+    FCooldowns cooldowns;
+  };
+
+  struct FPendingCast
+  {
+    int32_t key;
+    int32_t spellIndex;
+    BBotCombat::FPredictedCooldown predictedGCD;
+    BBotCombat::FPredictedCooldown predictedSpellCD;
+  };
+
+  // The owner's estimate of the server time, a local clock plus a corrected offset
+  struct FClientClock
+  {
+    float offset;
+    bool bSynced;
+
+    float GetServerTime(float localTime) const { return localTime + offset; }
+    void Sync(float replicatedServerTime, float localTime) { offset = replicatedServerTime - localTime; bSynced = true; }
+  };
+
+  void RunMatch(const FConfig& config)
+  {
+    // Messages in flight, each direction is ordered like a reliable channel
+    std::deque<FMessage> toServer;
+    std::deque<FMessage> toClient;
+
+    FCooldowns server = {};
+    FCooldowns replicated = {};
+    int32_t numCastsReceived = 0;
+    int32_t numAccepted = 0;
+    float nextTimeSync = 0.f;
+
+    FCooldowns client = {};
+    // The last cooldowns the server replicated to the owner
+    FCooldowns lastReplicated = {};
+    FClientClock clock = { 0.f, false };
+    std::vector<FPendingCast> pendingCasts;
+    int32_t nextKey = 1;
+    int32_t nextSpell = 0;
+
+    for (int32_t step = 0; step <= (int32_t)(TotalSeconds * StepsPerSecond); step++)
+    {
+      const float serverTime = (float)step / StepsPerSecond;
+      const float localTime = serverTime + config.skew;
+
+      // Server: the casts that arrived, then the replicated time
+      while (!toServer.empty() && toServer.front().deliveryTime <= serverTime)
+      {
+        const FMessage cast = toServer.front();
+        toServer.pop_front();
+        numCastsReceived++;
+
+        FMessage reply = {};
+        reply.deliveryTime = serverTime + config.latency;
+        reply.key = cast.key;
+
+        const bool bCooldownsReady = BBotCombat::IsCooldownReady(server.gcd, serverTime) && BBotCombat::IsCooldownReady(server.spellCDs[cast.spellIndex], serverTime);
+        const bool bForcedReject = config.rejectEvery > 0 && numCastsReceived % config.rejectEvery == 0;
+
+        if (bCooldownsReady && !bForcedReject)
+        {
+          BBotCombat::TriggerCooldown(server.gcd, serverTime, GlobalCooldown);
+          BBotCombat::TriggerCooldown(server.spellCDs[cast.spellIndex], serverTime, SpellCooldowns[cast.spellIndex]);
+          numAccepted++;
+
+          // The owner only cool downs replicate ahead of the confirmation
+          FMessage replication = reply;
+          replication.type = EMessage::EReplicatedCooldowns;
+          replication.cooldowns = server;
+          toClient.push_back(replication);
+
+          reply.type = EMessage::EConfirm;
+        }
+        else
+        {
+          reply.type = EMessage::EReject;
+        }
+        toClient.push_back(reply);
+      }
+
+      if (serverTime >= nextTimeSync)
+      {
+        nextTimeSync += TimeSyncInterval;
+        FMessage timeSync = {};
+        timeSync.deliveryTime = serverTime + config.latency;
+        timeSync.type = EMessage::ETimeSync;
+        timeSync.serverTime = serverTime;
+        toClient.push_back(timeSync);
+      }
+
+      // Owner: the replies that arrived
+      while (!toClient.empty() && toClient.front().deliveryTime <= serverTime)
+      {
+        const FMessage message = toClient.front();
+        toClient.pop_front();
+
+        if (message.type == EMessage::ETimeSync)
+        {
+          clock.Sync(message.serverTime, localTime);
+          continue;
+        }
+
+        if (message.type == EMessage::EReplicatedCooldowns)
+        {
+          // Properties only replicate when they changed
+          if (message.cooldowns.gcd != replicated.gcd)
+          {
+            client.gcd = lastReplicated.gcd = message.cooldowns.gcd;
+          }
+          for (int32_t i = 0; i < NumSpells; i++)
+          {
+            if (message.cooldowns.spellCDs[i] != replicated.spellCDs[i])
+            {
+              client.spellCDs[i] = lastReplicated.spellCDs[i] = message.cooldowns.spellCDs[i];
+            }
+          }
+          replicated = message.cooldowns;
+          continue;
+        }
+
+        for (size_t i = 0; i < pendingCasts.size(); i++)
+        {
+          if (pendingCasts[i].key != message.key)
+          {
+            continue;
+          }
+
+          if (message.type == EMessage::EReject)
+          {
+            const FPendingCast& cast = pendingCasts[i];
+            BBotCombat::RollbackCooldown(client.gcd, cast.predictedGCD);
+            BBotCombat::RollbackCooldown(client.spellCDs[cast.spellIndex], cast.predictedSpellCD);
+
+            // The server does not replicate again after a reject, the owner must not fall behind what it was sent
+            Check(client.gcd >= lastReplicated.gcd, "a rollback keeps the replicated GCD", config, serverTime);
+            Check(client.spellCDs[cast.spellIndex] >= lastReplicated.spellCDs[cast.spellIndex], "a rollback keeps the replicated spell cool down", config, serverTime);
+          }
+          pendingCasts.erase(pendingCasts.begin() + i);
+          break;
+        }
+      }
+
+      // Owner: cast the next spell as soon as the predicted cool downs allow it
+      const float estimatedServerTime = clock.GetServerTime(localTime);
+      if (clock.bSynced)
+      {
+        // Like the engine, the sample is not corrected for its trip, the estimate trails by the latency
+        Check(std::fabs(estimatedServerTime - (serverTime - config.latency)) < 0.01f, "the synced clock trails the server by the latency only", config, serverTime);
+      }
+      const int32_t spellIndex = nextSpell;
+      if (serverTime < CastingSeconds
+        && BBotCombat::IsCooldownReady(client.gcd, estimatedServerTime)
+        && BBotCombat::IsCooldownReady(client.spellCDs[spellIndex], estimatedServerTime))
+      {
+        FPendingCast cast;
+        cast.key = nextKey++;
+        cast.spellIndex = spellIndex;
+        cast.predictedGCD = BBotCombat::PredictCooldown(client.gcd, estimatedServerTime, GlobalCooldown);
+        cast.predictedSpellCD = BBotCombat::PredictCooldown(client.spellCDs[spellIndex], estimatedServerTime, SpellCooldowns[spellIndex]);
+        pendingCasts.push_back(cast);
+        nextSpell = (nextSpell + 1) % NumSpells;
+
+        FMessage message = {};
+        message.deliveryTime = serverTime + config.latency;
+        message.type = EMessage::ECast;
+        message.key = cast.key;
+        message.spellIndex = spellIndex;
+        toServer.push_back(message);
+      }
+    }
+
+    Check(numAccepted >= 5, "the owner gets casts through", config, TotalSeconds);
+    Check(pendingCasts.empty(), "every prediction is answered", config, TotalSeconds);
+    Check(client.gcd == server.gcd, "the owner ends with the server GCD", config, TotalSeconds);
+    for (int32_t i = 0; i < NumSpells; i++)
+    {
+      Check(client.spellCDs[i] == server.spellCDs[i], "the owner ends with the server spell cool downs", config, TotalSeconds);
+    }
+  }
+}
+
+int main()
+{
+  const float skews[] = { 0.f, 0.5f, 42.f, -42.f, 3600.f };
+  // A round trip over the GCD makes the owner predict the next cast before the last one replicates
+  const float latencies[] = { 0.03f, 0.6f };
+  const int32_t rejectEvery[] = { 0, 3 };
+
+  for (float skew : skews)
+  {
+    for (float latency : latencies)
+    {
+      for (int32_t reject : rejectEvery)
+      {
+        const FConfig config = { skew, latency, reject };
+        RunMatch(config);
+      }
+    }
+  }
+
+  if (numFailures > 0)
+  {
+    std::fprintf(stderr, "%d checks failed\n", numFailures);
+    return 1;
+  }
+
+  std::printf("CombatPredictionTest passed\n");
+  return 0;
+}
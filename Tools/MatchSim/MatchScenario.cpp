@@ -0,0 +1,411 @@
+// Copyright 2015 VMR Games, Inc. All Rights Reserved.
+
+#include "MatchSim.h"
+
+#include <cstdlib>
+#include <fstream>
+#include <sstream>
+
+/**
+ * Scenario files are line based, '#' starts a comment. Every line is a kind
+ * followed by key=value pairs, lists are comma separated:
+ *   match     timestep=0.0333 timeLimit=180 stunDuration=1
+ *   spell     Fireball element=fire damage=120 cost=20 cooldown=0 castTime=1
+ *             canStun=1 stunChance=0.1 knockBack=0 knockBackChance=0
+ *             direct=1 dotDuration=4 dotTick=1 dotScale=0.3
+ *   archetype Sorcerer health=1000 oil=250 oilRegen=5 gcd=1
+ *             resist.fire=0.1 bonus.fire=0 stanceElements=fire,ice,lightning
+ *   unit      team=0 archetype=Sorcerer stance=damage policy=greedy
+ *             bar=Fireball,Frostbolt script=Fireball,Fireball,Frostbolt
+ * Spells and archetypes must be declared before the units using them.
+ */
+
+namespace BBotMatchSim
+{
+  FSimSpell::FSimSpell()
+    : element(0), spellDamage(0.f), spellCost(0.f), coolDown(0.f), castTime(0.f), bCanStun(false), stunChance(0.f),
+    bKnockBack(false), knockBackChance(0.f), bDirectDamage(true), dotDuration(0.f), dotTick(0.f), dotScale(1.f)
+  {}
+
+  FSimArchetype::FSimArchetype()
+    : maxHealth(1000.f), maxOil(100.f), oilRegen(0.f), globalCooldown(1.f)
+  {
+    for (int32_t element = 0; element < BBotCombat::ElementCount; element++)
+    {
+      resists[element] = 0.f;
+      bonusDamage[element] = 0.f;
+      stanceElements[element] = true;
+    }
+  }
+
+  FSimUnitSetup::FSimUnitSetup()
+    : team(0), archetype(-1), bHasStance(false), stance(BBotCombat::EStanceRole::EDamage), policy(EPolicy::EGreedy)
+  {}
+
+  FSimScenario::FSimScenario()
+    : timestep(1.f / 30.f), timeLimit(180.f), stunDuration(1.f), teamCount(0)
+  {}
+
+  namespace
+  {
+    // Same order as EDamageElement
+    const char* const elementNames[BBotCombat::ElementCount] = { "physical", "fire", "ice", "lightning", "holy", "poison" };
+
+    int32_t FindElement(const std::string& name)
+    {
+      for (int32_t element = 0; element < BBotCombat::ElementCount; element++)
+      {
+        if (name == elementNames[element])
+        {
+          return element;
+        }
+      }
+      return -1;
+    }
+
+    template <typename T>
+    int32_t FindByName(const std::vector<T>& items, const std::string& name)
+    {
+      for (size_t i = 0; i < items.size(); i++)
+      {
+        if (items[i].name == name)
+        {
+          return (int32_t)i;
+        }
+      }
+      return -1;
+    }
+
+    std::vector<std::string> SplitList(const std::string& value)
+    {
+      std::vector<std::string> items;
+      std::stringstream stream(value);
+      std::string item;
+      while (std::getline(stream, item, ','))
+      {
+        if (!item.empty())
+        {
+          items.push_back(item);
+        }
+      }
+      return items;
+    }
+
+    bool ParseFloat(const std::string& value, float& outValue)
+    {
+      char* end = nullptr;
+      outValue = std::strtof(value.c_str(), &end);
+      return end && *end == '\0' && end != value.c_str();
+    }
+
+    bool ParseSpellList(const FSimScenario& scenario, const std::string& value, std::vector<int32_t>& outSpells, std::string& outError)
+    {
+      for (const std::string& spellName : SplitList(value))
+      {
+        const int32_t spell = FindByName(scenario.spells, spellName);
+        if (spell < 0)
+        {
+          outError = "unknown spell '" + spellName + "'";
+          return false;
+        }
+        outSpells.push_back(spell);
+      }
+      return true;
+    }
+
+    bool ParseSpellField(FSimSpell& spell, const std::string& key, const std::string& value, std::string& outError)
+    {
+      if (key == "element")
+      {
+        spell.element = FindElement(value);
+        if (spell.element < 0)
+        {
+          outError = "unknown element '" + value + "'";
+          return false;
+        }
+        return true;
+      }
+
+      float number = 0.f;
+      if (!ParseFloat(value, number))
+      {
+        outError = "expected a number for '" + key + "'";
+        return false;
+      }
+
+      if (key == "damage") spell.spellDamage = number;
+      else if (key == "cost") spell.spellCost = number;
+      else if (key == "cooldown") spell.coolDown = number;
+      else if (key == "castTime") spell.castTime = number;
+      else if (key == "canStun") spell.bCanStun = number != 0.f;
+      else if (key == "stunChance") spell.stunChance = number;
+      else if (key == "knockBack") spell.bKnockBack = number != 0.f;
+      else if (key == "knockBackChance") spell.knockBackChance = number;
+      else if (key == "direct") spell.bDirectDamage = number != 0.f;
+      else if (key == "dotDuration") spell.dotDuration = number;
+      else if (key == "dotTick") spell.dotTick = number;
+      else if (key == "dotScale") spell.dotScale = number;
+      else
+      {
+        outError = "unknown spell field '" + key + "'";
+        return false;
+      }
+      return true;
+    }
+
+    bool ParseArchetypeField(FSimArchetype& archetype, const std::string& key, const std::string& value, std::string& outError)
+    {
+      if (key == "stanceElements")
+      {
+        for (int32_t element = 0; element < BBotCombat::ElementCount; element++)
+        {
+          archetype.stanceElements[element] = false;
+        }
+        for (const std::string& elementName : SplitList(value))
+        {
+          const int32_t element = FindElement(elementName);
+          if (element < 0)
+          {
+            outError = "unknown element '" + elementName + "'";
+            return false;
+          }
+          archetype.stanceElements[element] = true;
+        }
+        return true;
+      }
+
+      float number = 0.f;
+      if (!ParseFloat(value, number))
+      {
+        outError = "expected a number for '" + key + "'";
+        return false;
+      }
+
+      const size_t dot = key.find('.');
+      if (dot != std::string::npos)
+      {
+        const std::string field = key.substr(0, dot);
+        const int32_t element = FindElement(key.substr(dot + 1));
+        if (element < 0 || (field != "resist" && field != "bonus"))
+        {
+          outError = "unknown archetype field '" + key + "'";
+          return false;
+        }
+        (field == "resist" ? archetype.resists : archetype.bonusDamage)[element] = number;
+        return true;
+      }
+
+      if (key == "health") archetype.maxHealth = number;
+      else if (key == "oil") archetype.maxOil = number;
+      else if (key == "oilRegen") archetype.oilRegen = number;
+      else if (key == "gcd") archetype.globalCooldown = number;
+      else
+      {
+        outError = "unknown archetype field '" + key + "'";
+        return false;
+      }
+      return true;
+    }
+
+    bool ParseUnitField(const FSimScenario& scenario, FSimUnitSetup& unit, const std::string& key, const std::string& value, std::string& outError)
+    {
+      if (key == "team")
+      {
+        unit.team = std::atoi(value.c_str());
+        if (unit.team < 0)
+        {
+          outError = "teams start at 0";
+          return false;
+        }
+      }
+      else if (key == "archetype")
+      {
+        unit.archetype = FindByName(scenario.archetypes, value);
+        if (unit.archetype < 0)
+        {
+          outError = "unknown archetype '" + value + "'";
+          return false;
+        }
+      }
+      else if (key == "stance")
+      {
+        unit.bHasStance = true;
+        if (value == "damage") unit.stance = BBotCombat::EStanceRole::EDamage;
+        else if (value == "defense") unit.stance = BBotCombat::EStanceRole::EDefense;
+        else if (value == "mobility") unit.stance = BBotCombat::EStanceRole::EMobility;
+        else if (value == "none") unit.bHasStance = false;
+        else
+        {
+          outError = "unknown stance '" + value + "'";
+          return false;
+        }
+      }
+      else if (key == "policy")
+      {
+        if (value == "greedy") unit.policy = EPolicy::EGreedy;
+        else if (value == "priority") unit.policy = EPolicy::EPriority;
+        else if (value == "script") unit.policy = EPolicy::EScript;
+        else
+        {
+          outError = "unknown policy '" + value + "'";
+          return false;
+        }
+      }
+      else if (key == "bar")
+      {
+        return ParseSpellList(scenario, value, unit.spellBar, outError);
+      }
+      else if (key == "script")
+      {
+        return ParseSpellList(scenario, value, unit.script, outError);
+      }
+      else
+      {
+        outError = "unknown unit field '" + key + "'";
+        return false;
+      }
+      return true;
+    }
+
+    bool ParseMatchField(FSimScenario& scenario, const std::string& key, const std::string& value, std::string& outError)
+    {
+      float number = 0.f;
+      if (!ParseFloat(value, number))
+      {
+        outError = "expected a number for '" + key + "'";
+        return false;
+      }
+
+      if (key == "timestep") scenario.timestep = number;
+      else if (key == "timeLimit") scenario.timeLimit = number;
+      else if (key == "stunDuration") scenario.stunDuration = number;
+      else
+      {
+        outError = "unknown match field '" + key + "'";
+        return false;
+      }
+      return true;
+    }
+
+    bool ValidateScenario(FSimScenario& scenario, std::string& outError)
+    {
+      if (scenario.timestep <= 0.f || scenario.timeLimit <= 0.f)
+      {
+        outError = "timestep and timeLimit must be positive";
+        return false;
+      }
+
+      scenario.teamCount = 0;
+      for (const FSimUnitSetup& unit : scenario.units)
+      {
+        if (unit.archetype < 0)
+        {
+          outError = "every unit needs an archetype";
+          return false;
+        }
+        if (unit.policy == EPolicy::EScript ? unit.script.empty() : unit.spellBar.empty())
+        {
+          outError = "every unit needs a spell bar, or a script for the script policy";
+          return false;
+        }
+        scenario.teamCount = unit.team + 1 > scenario.teamCount ? unit.team + 1 : scenario.teamCount;
+      }
+
+      if (scenario.teamCount < 2)
+      {
+        outError = "a scenario needs units on at least 2 teams";
+        return false;
+      }
+      return true;
+    }
+  }
+
+  bool LoadScenario(const std::string& path, FSimScenario& outScenario, std::string& outError)
+  {
+    std::ifstream file(path.c_str());
+    if (!file)
+    {
+      outError = "cannot open " + path;
+      return false;
+    }
+
+    outScenario = FSimScenario();
+
+    std::string line;
+    int32_t lineNumber = 0;
+    while (std::getline(file, line))
+    {
+      lineNumber++;
+
+      const size_t comment = line.find('#');
+      if (comment != std::string::npos)
+      {
+        line.erase(comment);
+      }
+
+      std::stringstream tokens(line);
+      std::string kind;
+      if (!(tokens >> kind))
+      {
+        continue;
+      }
+
+      FSimSpell spell;
+      FSimArchetype archetype;
+      FSimUnitSetup unit;
+
+      if (kind == "spell" || kind == "archetype")
+      {
+        std::string name;
+        if (!(tokens >> name))
+        {
+          outError = "missing name";
+        }
+        spell.name = name;
+        archetype.name = name;
+      }
+      else if (kind != "unit" && kind != "match")
+      {
+        outError = "unknown line kind '" + kind + "'";
+      }
+
+      std::string pair;
+      while (outError.empty() && tokens >> pair)
+      {
+        const size_t equals = pair.find('=');
+        if (equals == std::string::npos)
+        {
+          outError = "expected key=value, got '" + pair + "'";
+          break;
+        }
+
+        const std::string key = pair.substr(0, equals);
+        const std::string value = pair.substr(equals + 1);
+
+        if (kind == "spell") ParseSpellField(spell, key, value, outError);
+        else if (kind == "archetype") ParseArchetypeField(archetype, key, value, outError);
+        else if (kind == "unit") ParseUnitField(outScenario, unit, key, value, outError);
+        else ParseMatchField(outScenario, key, value, outError);
+      }
+
+      if (!outError.empty())
+      {
+        std::stringstream message;
+        message << path << ":" << lineNumber << ": " << outError;
+        outError = message.str();
+        return false;
+      }
+
+      if (kind == "spell") outScenario.spells.push_back(spell);
+      else if (kind == "archetype") outScenario.archetypes.push_back(archetype);
+      else if (kind == "unit") outScenario.units.push_back(unit);
+    }
+
+    if (!ValidateScenario(outScenario, outError))
+    {
+      outError = path + ": " + outError;
+      return false;
+    }
+    return true;
+  }
+}
@@ -0,0 +1,419 @@
+// Copyright 2015 VMR Games, Inc. All Rights Reserved.
+
+#include "MatchSim.h"
+
+/**
+ * Mirrors the server rules of a cast: oil and the global cooldown are spent
+ * when the cast starts, the spell cooldown starts when the spell spawns,
+ * hits are resolved with the attacker bonus then the target resist, and
+ * DoTs from the same caster and spell refresh instead of stacking.
+ * Spells are assumed to hit. Movement is not simulated, so a knockback
+ * only interrupts the cast of its target, like a stun without the stun.
+ */
+
+namespace BBotMatchSim
+{
+  namespace
+  {
+    // Stance and spell, the simulator has no items
+    const int32_t LayerCount = 2;
+
+    // ABBotCharacter uses 0.01s for instant casts to keep the cast timer valid
+    const float MinCastTime = 0.01f;
+
+    struct FSimUnit
+    {
+      const FSimUnitSetup* setup;
+      float health;
+      float oil;
+      float oilRegen;
+      float globalCooldown;
+      float resists[BBotCombat::ElementCount];
+      float bonusDamage[BBotCombat::ElementCount];
+      float gcdReadyTime;
+      std::vector<float> spellReadyTimes;
+      int32_t castingSpell;
+      int32_t castTarget;
+      float castEndTime;
+      float stunnedUntil;
+      size_t scriptIndex;
+    };
+
+    struct FSimDot
+    {
+      BBotCombat::FDotTimer timer;
+      int32_t source;
+      int32_t target;
+      int32_t spell;
+      float damagePerTick;
+    };
+
+    class FMatch
+    {
+    public:
+      FMatch(const FSimScenario& inScenario, uint64_t seed, FMatchResult& inResult)
+        : scenario(inScenario), random(seed), result(inResult), currentTime(0.f)
+      {}
+
+      void Run()
+      {
+        InitUnits();
+
+        std::vector<int32_t> updateOrder(units.size());
+        for (size_t i = 0; i < updateOrder.size(); i++)
+        {
+          updateOrder[i] = (int32_t)i;
+        }
+
+        result.winningTeam = -1;
+
+        while (currentTime < scenario.timeLimit)
+        {
+          currentTime += scenario.timestep;
+
+          TickDots();
+
+          // A fixed order would favour the first units on simultaneous kills
+          for (size_t i = updateOrder.size() - 1; i > 0; i--)
+          {
+            const size_t swapIndex = (size_t)(random.Next() % (i + 1));
+            const int32_t swapped = updateOrder[i];
+            updateOrder[i] = updateOrder[swapIndex];
+            updateOrder[swapIndex] = swapped;
+          }
+
+          for (int32_t unitIndex : updateOrder)
+          {
+            TickUnit(unitIndex);
+          }
+
+          int32_t aliveTeam = -1;
+          if (CountAliveTeams(aliveTeam) <= 1)
+          {
+            result.winningTeam = aliveTeam;
+            break;
+          }
+        }
+
+        result.duration = currentTime < scenario.timeLimit ? currentTime : scenario.timeLimit;
+        for (FUnitResult& unitResult : result.units)
+        {
+          unitResult.aliveTime = unitResult.deathTime >= 0.f ? unitResult.deathTime : result.duration;
+        }
+      }
+
+    private:
+      const FSimScenario& scenario;
+      FSimRandom random;
+      FMatchResult& result;
+      float currentTime;
+      std::vector<FSimUnit> units;
+      std::vector<FSimDot> dots;
+
+      void InitUnits()
+      {
+        units.resize(scenario.units.size());
+        result.units.assign(scenario.units.size(), FUnitResult());
+
+        for (size_t i = 0; i < units.size(); i++)
+        {
+          const FSimUnitSetup& setup = scenario.units[i];
+          const FSimArchetype& archetype = scenario.archetypes[setup.archetype];
+          FSimUnit& unit = units[i];
+
+          // The stance layer, as ABBotCharacter::ApplyStanceModifiers sets it
+          BBotCombat::FAttributeLayer layers[LayerCount];
+          if (setup.bHasStance)
+          {
+            const BBotCombat::FStanceModifiers& stance = BBotCombat::GetStanceModifiers(setup.stance);
+            layers[0].movSpeedMod = stance.mobility;
+            for (int32_t element = 0; element < BBotCombat::ElementCount; element++)
+            {
+              layers[0].resists[element] = stance.defense;
+              layers[0].bonusDamage[element] = archetype.stanceElements[element] ? stance.damage : 0.f;
+            }
+          }
+
+          unit.setup = &setup;
+          unit.health = archetype.maxHealth;
+          unit.oil = archetype.maxOil;
+          unit.oilRegen = archetype.oilRegen;
+          unit.globalCooldown = BBotCombat::FoldGlobalCooldown(archetype.globalCooldown, layers, LayerCount);
+          for (int32_t element = 0; element < BBotCombat::ElementCount; element++)
+          {
+            unit.resists[element] = BBotCombat::FoldResist(archetype.resists[element], layers, LayerCount, element);
+            unit.bonusDamage[element] = BBotCombat::FoldBonusDamage(archetype.bonusDamage[element], layers, LayerCount, element);
+          }
+          unit.gcdReadyTime = 0.f;
+          unit.spellReadyTimes.assign(scenario.spells.size(), 0.f);
+          unit.castingSpell = -1;
+          unit.castTarget = -1;
+          unit.castEndTime = 0.f;
+          unit.stunnedUntil = 0.f;
+          unit.scriptIndex = 0;
+
+          result.units[i].damageDealt = 0.f;
+          result.units[i].deathTime = -1.f;
+        }
+      }
+
+      bool IsAlive(int32_t unitIndex) const { return units[unitIndex].health > 0.f; }
+
+      int32_t CountAliveTeams(int32_t& outLastAliveTeam) const
+      {
+        std::vector<bool> aliveTeams(scenario.teamCount, false);
+        int32_t aliveTeamCount = 0;
+        for (size_t i = 0; i < units.size(); i++)
+        {
+          const int32_t team = units[i].setup->team;
+          if (IsAlive((int32_t)i) && !aliveTeams[team])
+          {
+            aliveTeams[team] = true;
+            aliveTeamCount++;
+            outLastAliveTeam = team;
+          }
+        }
+        return aliveTeamCount;
+      }
+
+      void ApplyDamage(int32_t source, int32_t target, float damage)
+      {
+        FSimUnit& targetUnit = units[target];
+        const float appliedDamage = damage < targetUnit.health ? damage : targetUnit.health;
+
+        targetUnit.health -= appliedDamage;
+        result.units[source].damageDealt += appliedDamage;
+
+        if (targetUnit.health <= 0.f)
+        {
+          targetUnit.health = 0.f;
+          targetUnit.castingSpell = -1;
+          result.units[target].deathTime = currentTime;
+        }
+      }
+
+      void TickDots()
+      {
+        // Iterate backwards, expired dots are removed with a swap
+        for (size_t i = dots.size(); i-- > 0;)
+        {
+          FSimDot& dot = dots[i];
+          if (!IsAlive(dot.target) || dot.timer.IsExpired(currentTime))
+          {
+            dots[i] = dots.back();
+            dots.pop_back();
+            continue;
+          }
+
+          if (dot.timer.ConsumeTick(currentTime))
+          {
+            const int32_t element = scenario.spells[dot.spell].element;
+            ApplyDamage(dot.source, dot.target, BBotCombat::ResolveResist(dot.damagePerTick, units[dot.target].resists[element]));
+          }
+        }
+      }
+
+      void TickUnit(int32_t unitIndex)
+      {
+        FSimUnit& unit = units[unitIndex];
+        if (!IsAlive(unitIndex))
+        {
+          return;
+        }
+
+        const float maxOil = scenario.archetypes[unit.setup->archetype].maxOil;
+        unit.oil = BBotCombat::Clamp(unit.oil + unit.oilRegen * scenario.timestep, 0.f, maxOil);
+
+        if (unit.stunnedUntil > currentTime)
+        {
+          return;
+        }
+
+        if (unit.castingSpell >= 0)
+        {
+          if (currentTime < unit.castEndTime)
+          {
+            return;
+          }
+          FinishCast(unitIndex);
+        }
+
+        const int32_t target = SelectTarget(unitIndex);
+        if (target < 0 || !BBotCombat::IsCooldownReady(unit.gcdReadyTime, currentTime))
+        {
+          return;
+        }
+
+        const int32_t spell = SelectSpell(unitIndex, target);
+        if (spell >= 0)
+        {
+          StartCast(unitIndex, spell, target);
+        }
+      }
+
+      // Focus the enemy with the least health, ties go to the first unit
+      int32_t SelectTarget(int32_t unitIndex) const
+      {
+        int32_t target = -1;
+        for (size_t i = 0; i < units.size(); i++)
+        {
+          if (units[i].setup->team != units[unitIndex].setup->team && IsAlive((int32_t)i)
+            && (target < 0 || units[i].health < units[target].health))
+          {
+            target = (int32_t)i;
+          }
+        }
+        return target;
+      }
+
+      bool CanCast(const FSimUnit& unit, int32_t spell) const
+      {
+        return unit.oil >= scenario.spells[spell].spellCost && BBotCombat::IsCooldownReady(unit.spellReadyTimes[spell], currentTime);
+      }
+
+      // Direct and DoT damage against the target, per second the caster is busy
+      float GetExpectedDps(const FSimUnit& unit, int32_t spell, int32_t target) const
+      {
+        const FSimSpell& spellData = scenario.spells[spell];
+        const float bonusDamage = unit.bonusDamage[spellData.element];
+        const float resist = units[target].resists[spellData.element];
+
+        float damage = spellData.bDirectDamage ? BBotCombat::ResolveDamage(spellData.spellDamage, bonusDamage, resist) : 0.f;
+        if (spellData.dotDuration > 0.f && spellData.dotTick > 0.f)
+        {
+          const float damagePerTick = BBotCombat::GetDotDamagePerTick(spellData.spellDamage, spellData.dotDuration, spellData.dotScale, bonusDamage);
+          damage += BBotCombat::ResolveResist(damagePerTick, resist) * (spellData.dotDuration / spellData.dotTick);
+        }
+
+        const float busyTime = BBotCombat::Max(BBotCombat::Max(spellData.castTime, MinCastTime), unit.globalCooldown);
+        return damage / busyTime;
+      }
+
+      int32_t SelectSpell(int32_t unitIndex, int32_t target)
+      {
+        FSimUnit& unit = units[unitIndex];
+
+        if (unit.setup->policy == EPolicy::EScript)
+        {
+          const int32_t spell = unit.setup->script[unit.scriptIndex % unit.setup->script.size()];
+          if (!CanCast(unit, spell))
+          {
+            return -1;
+          }
+          unit.scriptIndex++;
+          return spell;
+        }
+
+        int32_t bestSpell = -1;
+        float bestDps = -1.f;
+        for (int32_t spell : unit.setup->spellBar)
+        {
+          if (!CanCast(unit, spell))
+          {
+            continue;
+          }
+          if (unit.setup->policy == EPolicy::EPriority)
+          {
+            return spell;
+          }
+
+          const float dps = GetExpectedDps(unit, spell, target);
+          if (dps > bestDps)
+          {
+            bestDps = dps;
+            bestSpell = spell;
+          }
+        }
+        return bestSpell;
+      }
+
+      void StartCast(int32_t unitIndex, int32_t spell, int32_t target)
+      {
+        FSimUnit& unit = units[unitIndex];
+        const FSimSpell& spellData = scenario.spells[spell];
+
+        unit.oil -= spellData.spellCost;
+        BBotCombat::TriggerCooldown(unit.gcdReadyTime, currentTime, unit.globalCooldown);
+        unit.castingSpell = spell;
+        unit.castTarget = target;
+        unit.castEndTime = currentTime + BBotCombat::Max(spellData.castTime, MinCastTime);
+      }
+
+      void FinishCast(int32_t unitIndex)
+      {
+        FSimUnit& unit = units[unitIndex];
+        const int32_t spell = unit.castingSpell;
+        const int32_t target = unit.castTarget;
+        const FSimSpell& spellData = scenario.spells[spell];
+
+        unit.castingSpell = -1;
+        BBotCombat::TriggerCooldown(unit.spellReadyTimes[spell], currentTime, spellData.coolDown);
+
+        // The target died during the cast, the spell is wasted
+        if (!IsAlive(target))
+        {
+          return;
+        }
+
+        FSimUnit& targetUnit = units[target];
+        const float bonusDamage = unit.bonusDamage[spellData.element];
+
+        if (spellData.bCanStun && random.Roll(spellData.stunChance))
+        {
+          targetUnit.stunnedUntil = currentTime + scenario.stunDuration;
+          targetUnit.castingSpell = -1;
+        }
+        if (spellData.bKnockBack && random.Roll(spellData.knockBackChance))
+        {
+          targetUnit.castingSpell = -1;
+        }
+
+        if (spellData.bDirectDamage)
+        {
+          ApplyDamage(unitIndex, target, BBotCombat::ResolveDamage(spellData.spellDamage, bonusDamage, targetUnit.resists[spellData.element]));
+        }
+
+        if (IsAlive(target) && spellData.dotDuration > 0.f && spellData.dotTick > 0.f)
+        {
+          ApplyDot(unitIndex, target, spell, BBotCombat::GetDotDamagePerTick(spellData.spellDamage, spellData.dotDuration, spellData.dotScale, bonusDamage));
+        }
+      }
+
+      // Same rules as AStatusEffectManager::ApplyDot
+      void ApplyDot(int32_t source, int32_t target, int32_t spell, float damagePerTick)
+      {
+        const FSimSpell& spellData = scenario.spells[spell];
+
+        for (FSimDot& dot : dots)
+        {
+          if (dot.source == source && dot.target == target && dot.spell == spell)
+          {
+            dot.damagePerTick = damagePerTick;
+            dot.timer.Refresh(currentTime, spellData.dotTick, spellData.dotDuration);
+            return;
+          }
+        }
+
+        FSimDot dot;
+        dot.source = source;
+        dot.target = target;
+        dot.spell = spell;
+        dot.damagePerTick = damagePerTick;
+        dot.timer.Start(currentTime, spellData.dotTick, BBotCombat::GetDotFirstTickDelay(spellData.dotTick), spellData.dotDuration);
+        dots.push_back(dot);
+      }
+    };
+  }
+
+  uint64_t GetMatchSeed(uint64_t runSeed, uint64_t matchIndex)
+  {
+    FSimRandom random(runSeed ^ (matchIndex * 0xD1B54A32D192ED03ull));
+    return random.Next();
+  }
+
+  void SimulateMatch(const FSimScenario& scenario, uint64_t seed, FMatchResult& outResult)
+  {
+    FMatch match(scenario, seed, outResult);
+    match.Run();
+  }
+}
@@ -0,0 +1,139 @@
+// Copyright 2015 VMR Games, Inc. All Rights Reserved.
+
+#pragma once
+
+#include "Combat/BBotCombatMath.h"
+
+#include <string>
+#include <vector>
+
+/**
+ * Headless fixed timestep match simulator for balance runs. Matches are
+ * resolved with the same combat core as the game (BattleBots/Combat), on
+ * a scenario describing the spells, archetypes and team compositions.
+ * A match only depends on its scenario and seed, never on the thread that
+ * runs it, so any regression reproduces from the seed.
+ */
+namespace BBotMatchSim
+{
+  // Per match random stream, splitmix64
+  struct FSimRandom
+  {
+    uint64_t state;
+
+    explicit FSimRandom(uint64_t seed) : state(seed) {}
+
+    uint64_t Next()
+    {
+      uint64_t z = (state += 0x9E3779B97F4A7C15ull);
+      z = (z ^ (z >> 30)) * 0xBF58476D1CE4E5B9ull;
+      z = (z ^ (z >> 27)) * 0x94D049BB133111EBull;
+      return z ^ (z >> 31);
+    }
+
+    // [0, 1)
+    float Unit() { return (Next() >> 40) / 16777216.f; }
+
+    bool Roll(float chance) { return chance > 0.f && Unit() < chance; }
+  };
+
+  // The balance fields of FSpellData, plus the DoT the spell class applies
+  struct FSimSpell
+  {
+    std::string name;
+    int32_t element;
+    float spellDamage;
+    float spellCost;
+    float coolDown;
+    float castTime;
+    bool bCanStun;
+    float stunChance;
+    bool bKnockBack;
+    float knockBackChance;
+    // False for spells that only deal their damage over time
+    bool bDirectDamage;
+    // A DoT is applied when dotDuration and dotTick are both positive
+    float dotDuration;
+    float dotTick;
+    float dotScale;
+
+    FSimSpell();
+  };
+
+  // The class defaults of a character
+  struct FSimArchetype
+  {
+    std::string name;
+    float maxHealth;
+    float maxOil;
+    float oilRegen;
+    float globalCooldown;
+    float resists[BBotCombat::ElementCount];
+    float bonusDamage[BBotCombat::ElementCount];
+    // The elements the stance damage modifier applies to
+    bool stanceElements[BBotCombat::ElementCount];
+
+    FSimArchetype();
+  };
+
+  enum class EPolicy
+  {
+    // Highest expected damage per second of the ready and affordable spells
+    EGreedy,
+    // First ready and affordable spell in spell bar order
+    EPriority,
+    // Casts the script in order, waits for the next scripted spell
+    EScript,
+  };
+
+  struct FSimUnitSetup
+  {
+    int32_t team;
+    int32_t archetype;
+    bool bHasStance;
+    BBotCombat::EStanceRole stance;
+    EPolicy policy;
+    // Spell indices
+    std::vector<int32_t> spellBar;
+    std::vector<int32_t> script;
+
+    FSimUnitSetup();
+  };
+
+  struct FSimScenario
+  {
+    float timestep;
+    float timeLimit;
+    float stunDuration;
+    std::vector<FSimSpell> spells;
+    std::vector<FSimArchetype> archetypes;
+    std::vector<FSimUnitSetup> units;
+    int32_t teamCount;
+
+    FSimScenario();
+  };
+
+  struct FUnitResult
+  {
+    float damageDealt;
+    // Seconds since the match start, negative if the unit survived
+    float deathTime;
+    float aliveTime;
+  };
+
+  struct FMatchResult
+  {
+    // -1 for a draw
+    int32_t winningTeam;
+    float duration;
+    std::vector<FUnitResult> units;
+  };
+
+  // Reads a scenario file, returns false and fills outError on failure
+  bool LoadScenario(const std::string& path, FSimScenario& outScenario, std::string& outError);
+
+  // The seed of a match only depends on the run seed and the match index
+  uint64_t GetMatchSeed(uint64_t runSeed, uint64_t matchIndex);
+
+  void SimulateMatch(const FSimScenario& scenario, uint64_t seed, FMatchResult& outResult);
+}
@@ -0,0 +1,189 @@
+// Copyright 2015 VMR Games, Inc. All Rights Reserved.
+
+#include "MatchSim.h"
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <thread>
+
+/**
+ * Usage: MatchSim <scenario> [--matches N] [--seed S] [--threads T]
+ * Matches are spread over all cores. Results are stored per match index and
+ * aggregated in index order, so the report only depends on the scenario,
+ * the seed and the match count.
+ */
+
+namespace
+{
+  struct FDistribution
+  {
+    float mean;
+    float p10;
+    float p50;
+    float p90;
+  };
+
+  FDistribution GetDistribution(std::vector<float>& values)
+  {
+    FDistribution distribution = { 0.f, 0.f, 0.f, 0.f };
+    if (values.empty())
+    {
+      return distribution;
+    }
+
+    std::sort(values.begin(), values.end());
+
+    double total = 0.0;
+    for (float value : values)
+    {
+      total += value;
+    }
+
+    // Nearest rank
+    const size_t last = values.size() - 1;
+    distribution.mean = (float)(total / values.size());
+    distribution.p10 = values[last * 10 / 100];
+    distribution.p50 = values[last * 50 / 100];
+    distribution.p90 = values[last * 90 / 100];
+    return distribution;
+  }
+
+  void PrintDistribution(const char* label, std::vector<float>& values)
+  {
+    const FDistribution distribution = GetDistribution(values);
+    std::printf("  %-22s mean %8.2f  p10 %8.2f  p50 %8.2f  p90 %8.2f  (n=%zu)\n",
+      label, distribution.mean, distribution.p10, distribution.p50, distribution.p90, values.size());
+  }
+
+  void PrintUsage(const char* program)
+  {
+    std::fprintf(stderr, "Usage: %s <scenario> [--matches N] [--seed S] [--threads T]\n", program);
+  }
+}
+
+int main(int argc, char** argv)
+{
+  if (argc < 2)
+  {
+    PrintUsage(argv[0]);
+    return 1;
+  }
+
+  const char* scenarioPath = argv[1];
+  uint64_t matchCount = 10000;
+  uint64_t runSeed = 1;
+  uint32_t threadCount = std::thread::hardware_concurrency();
+
+  for (int i = 2; i + 1 < argc; i += 2)
+  {
+    if (std::strcmp(argv[i], "--matches") == 0) matchCount = std::strtoull(argv[i + 1], nullptr, 10);
+    else if (std::strcmp(argv[i], "--seed") == 0) runSeed = std::strtoull(argv[i + 1], nullptr, 10);
+    else if (std::strcmp(argv[i], "--threads") == 0) threadCount = (uint32_t)std::strtoul(argv[i + 1], nullptr, 10);
+    else
+    {
+      PrintUsage(argv[0]);
+      return 1;
+    }
+  }
+
+  BBotMatchSim::FSimScenario scenario;
+  std::string error;
+  if (!BBotMatchSim::LoadScenario(scenarioPath, scenario, error))
+  {
+    std::fprintf(stderr, "%s\n", error.c_str());
+    return 1;
+  }
+
+  threadCount = std::max(1u, threadCount);
+  std::vector<BBotMatchSim::FMatchResult> results(matchCount);
+  std::atomic<uint64_t> nextMatch(0);
+
+  const auto start = std::chrono::steady_clock::now();
+
+  std::vector<std::thread> workers;
+  for (uint32_t i = 0; i < threadCount; i++)
+  {
+    workers.emplace_back([&]() {
+      for (uint64_t match = nextMatch++; match < matchCount; match = nextMatch++)
+      {
+        BBotMatchSim::SimulateMatch(scenario, BBotMatchSim::GetMatchSeed(runSeed, match), results[match]);
+      }
+    });
+  }
+  for (std::thread& worker : workers)
+  {
+    worker.join();
+  }
+
+  const double elapsedSeconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+
+  std::vector<uint64_t> teamWins(scenario.teamCount, 0);
+  uint64_t draws = 0;
+  std::vector<float> durations;
+  std::vector<std::vector<float>> unitTtk(scenario.units.size());
+  std::vector<std::vector<float>> unitDps(scenario.units.size());
+
+  for (const BBotMatchSim::FMatchResult& result : results)
+  {
+    if (result.winningTeam >= 0)
+    {
+      teamWins[result.winningTeam]++;
+    }
+    else
+    {
+      draws++;
+    }
+    durations.push_back(result.duration);
+
+    for (size_t unit = 0; unit < result.units.size(); unit++)
+    {
+      const BBotMatchSim::FUnitResult& unitResult = result.units[unit];
+      if (unitResult.deathTime >= 0.f)
+      {
+        unitTtk[unit].push_back(unitResult.deathTime);
+      }
+      if (unitResult.aliveTime > 0.f)
+      {
+        unitDps[unit].push_back(unitResult.damageDealt / unitResult.aliveTime);
+      }
+    }
+  }
+
+  std::printf("%llu matches, seed %llu, %u threads, %.3fs (%.0f matches/s)\n",
+    (unsigned long long)matchCount, (unsigned long long)runSeed, threadCount, elapsedSeconds,
+    elapsedSeconds > 0.0 ? matchCount / elapsedSeconds : 0.0);
+
+  std::printf("\nWin rates\n");
+  for (int32_t team = 0; team < scenario.teamCount; team++)
+  {
+    std::printf("  team %-17d %6.2f%%\n", team, matchCount ? 100.0 * teamWins[team] / matchCount : 0.0);
+  }
+  std::printf("  %-22s %6.2f%%\n", "draw", matchCount ? 100.0 * draws / matchCount : 0.0);
+
+  std::printf("\nMatch duration (s)\n");
+  PrintDistribution("all", durations);
+
+  std::printf("\nTime to kill (s), per unit killed\n");
+  for (size_t unit = 0; unit < scenario.units.size(); unit++)
+  {
+    char label[64];
+    std::snprintf(label, sizeof(label), "#%zu team %d %s", unit, scenario.units[unit].team,
+      scenario.archetypes[scenario.units[unit].archetype].name.c_str());
+    PrintDistribution(label, unitTtk[unit]);
+  }
+
+  std::printf("\nDPS, per unit while alive\n");
+  for (size_t unit = 0; unit < scenario.units.size(); unit++)
+  {
+    char label[64];
+    std::snprintf(label, sizeof(label), "#%zu team %d %s", unit, scenario.units[unit].team,
+      scenario.archetypes[scenario.units[unit].archetype].name.c_str());
+    PrintDistribution(label, unitDps[unit]);
+  }
+
+  return 0;
+}